@@ -187,6 +187,8 @@ struct uv__queue {
   XX(GETADDRINFO, getaddrinfo)                                                \
   XX(GETNAMEINFO, getnameinfo)                                                \
   XX(RANDOM, random)                                                          \
+  XX(WORK_BULK, work_bulk)                                                    \
+  XX(SPLICE, splice)                                                          \
 
 typedef enum {
 #define XX(code, _) UV_ ## code = UV__ ## code,
@@ -240,10 +242,12 @@ typedef struct uv_getaddrinfo_s uv_getaddrinfo_t;
 typedef struct uv_getnameinfo_s uv_getnameinfo_t;
 typedef struct uv_shutdown_s uv_shutdown_t;
 typedef struct uv_write_s uv_write_t;
+typedef struct uv_splice_s uv_splice_t;
 typedef struct uv_connect_s uv_connect_t;
 typedef struct uv_udp_send_s uv_udp_send_t;
 typedef struct uv_fs_s uv_fs_t;
 typedef struct uv_work_s uv_work_t;
+typedef struct uv_work_bulk_s uv_work_bulk_t;
 typedef struct uv_random_s uv_random_t;
 
 /* None of the above. */
@@ -257,6 +261,9 @@ typedef struct uv_utsname_s uv_utsname_t;
 typedef struct uv_statfs_s uv_statfs_t;
 
 typedef struct uv_metrics_s uv_metrics_t;
+typedef struct uv_tcp_info_s uv_tcp_info_t;
+typedef struct uv_threadpool_metrics_s uv_threadpool_metrics_t;
+typedef struct uv_work_metrics_s uv_work_metrics_t;
 
 typedef enum {
   UV_LOOP_BLOCK_SIGNAL = 0,
@@ -326,7 +333,13 @@ typedef void (*uv_alloc_cb)(uv_handle_t* handle,
 typedef void (*uv_read_cb)(uv_stream_t* stream,
                            ssize_t nread,
                            const uv_buf_t* buf);
+typedef void (*uv_read_v_cb)(uv_stream_t* stream,
+                             ssize_t nread,
+                             const uv_buf_t bufs[],
+                             unsigned int nbufs);
 typedef void (*uv_write_cb)(uv_write_t* req, int status);
+typedef void (*uv_splice_cb)(uv_splice_t* req, int status);
+typedef void (*uv_watermark_cb)(uv_stream_t* stream, int above);
 typedef void (*uv_connect_cb)(uv_connect_t* req, int status);
 typedef void (*uv_shutdown_cb)(uv_shutdown_t* req, int status);
 typedef void (*uv_connection_cb)(uv_stream_t* server, int status);
@@ -342,6 +355,8 @@ typedef void (*uv_walk_cb)(uv_handle_t* handle, void* arg);
 typedef void (*uv_fs_cb)(uv_fs_t* req);
 typedef void (*uv_work_cb)(uv_work_t* req);
 typedef void (*uv_after_work_cb)(uv_work_t* req, int status);
+typedef void (*uv_work_bulk_cb)(uv_work_bulk_t* req, size_t start, size_t end);
+typedef void (*uv_after_work_bulk_cb)(uv_work_bulk_t* req, int status);
 typedef void (*uv_getaddrinfo_cb)(uv_getaddrinfo_t* req,
                                   int status,
                                   struct addrinfo* res);
@@ -545,6 +560,9 @@ UV_EXTERN int uv_accept(uv_stream_t* server, uv_stream_t* client);
 UV_EXTERN int uv_read_start(uv_stream_t*,
                             uv_alloc_cb alloc_cb,
                             uv_read_cb read_cb);
+UV_EXTERN int uv_read_start_v(uv_stream_t*,
+                              uv_alloc_cb alloc_cb,
+                              uv_read_v_cb read_cb);
 UV_EXTERN int uv_read_stop(uv_stream_t*);
 
 UV_EXTERN int uv_write(uv_write_t* req,
@@ -558,6 +576,11 @@ UV_EXTERN int uv_write2(uv_write_t* req,
                         unsigned int nbufs,
                         uv_stream_t* send_handle,
                         uv_write_cb cb);
+UV_EXTERN int uv_write_nocopy(uv_write_t* req,
+                              uv_stream_t* handle,
+                              uv_buf_t bufs[],
+                              unsigned int nbufs,
+                              uv_write_cb cb);
 UV_EXTERN int uv_try_write(uv_stream_t* handle,
                            const uv_buf_t bufs[],
                            unsigned int nbufs);
@@ -565,6 +588,12 @@ UV_EXTERN int uv_try_write2(uv_stream_t* handle,
                             const uv_buf_t bufs[],
                             unsigned int nbufs,
                             uv_stream_t* send_handle);
+UV_EXTERN int uv_stream_sendfile(uv_write_t* req,
+                                 uv_stream_t* handle,
+                                 uv_file file,
+                                 int64_t offset,
+                                 size_t length,
+                                 uv_write_cb cb);
 
 /* uv_write_t is a subclass of uv_req_t. */
 struct uv_write_s {
@@ -576,10 +605,57 @@ struct uv_write_s {
 };
 
 
+/* uv_splice_t is a subclass of uv_req_t. */
+struct uv_splice_s {
+  UV_REQ_FIELDS
+  uv_splice_cb cb;
+  uv_stream_t* src;
+  uv_stream_t* dst;
+  uint64_t nbytes;
+  UV_SPLICE_PRIVATE_FIELDS
+};
+
+UV_EXTERN int uv_stream_splice(uv_splice_t* req,
+                               uv_stream_t* src,
+                               uv_stream_t* dst,
+                               uv_splice_cb cb);
+
+
 UV_EXTERN int uv_is_readable(const uv_stream_t* handle);
 UV_EXTERN int uv_is_writable(const uv_stream_t* handle);
 
 UV_EXTERN int uv_stream_set_blocking(uv_stream_t* handle, int blocking);
+UV_EXTERN int uv_stream_set_cork(uv_stream_t* handle,
+                                 int enable,
+                                 size_t threshold);
+UV_EXTERN int uv_stream_set_watermarks(uv_stream_t* handle,
+                                       size_t low,
+                                       size_t high,
+                                       uv_watermark_cb cb);
+
+typedef enum {
+  UV_FRAMING_NONE = 0,
+  /* Each frame starts with its length as an unsigned integer. */
+  UV_FRAMING_PREFIX,
+  /* Each frame ends with a delimiter byte. */
+  UV_FRAMING_DELIMITER
+} uv_framing_type;
+
+enum uv_framing_flags {
+  /* The length prefix is in network byte order. */
+  UV_FRAMING_BIG_ENDIAN = 1
+};
+
+typedef struct uv_stream_framing_s {
+  uv_framing_type type;
+  unsigned int flags;
+  unsigned int prefix_size; /* 1, 2, 4 or 8 bytes. */
+  unsigned char delimiter;
+  size_t max_frame_size;
+} uv_stream_framing_t;
+
+UV_EXTERN int uv_stream_set_framing(uv_stream_t* handle,
+                                    const uv_stream_framing_t* framing);
 
 UV_EXTERN int uv_is_closing(const uv_handle_t* handle);
 
@@ -608,6 +684,29 @@ UV_EXTERN int uv_tcp_keepalive_ex(uv_tcp_t* handle,
                                   unsigned int intvl,
                                   unsigned int cnt);
 UV_EXTERN int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable);
+UV_EXTERN int uv_tcp_zerocopy(uv_tcp_t* handle, int enable, size_t threshold);
+UV_EXTERN int uv_tcp_notsent_lowat(uv_tcp_t* handle, unsigned int bytes);
+
+struct uv_tcp_info_s {
+  uint64_t rtt;             /* Smoothed round-trip time, in microseconds. */
+  uint64_t rtt_var;         /* Round-trip time variation, in microseconds. */
+  uint64_t min_rtt;         /* Lowest round-trip time, in microseconds. */
+  uint64_t cwnd;            /* Congestion window, in segments. */
+  uint64_t ssthresh;        /* Slow start threshold, in segments. */
+  uint64_t mss;             /* Sender's maximum segment size, in bytes. */
+  uint64_t unacked;         /* Segments sent but not yet acknowledged. */
+  uint64_t lost;            /* Segments presumed lost. */
+  uint64_t retransmits;     /* Segments retransmitted so far. */
+  uint64_t notsent_bytes;   /* Bytes in the socket buffer not sent yet. */
+  uint64_t delivery_rate;   /* Recent delivery rate, in bytes per second. */
+  uint64_t bytes_sent;
+  uint64_t bytes_acked;
+  uint64_t bytes_received;
+  /* private */
+  uint64_t reserved[8];
+};
+
+UV_EXTERN int uv_tcp_get_info(const uv_tcp_t* handle, uv_tcp_info_t* info);
 
 enum uv_tcp_flags {
   /* Used with uv_tcp_bind, when an IPv6 address is used. */
@@ -623,6 +722,16 @@ enum uv_tcp_flags {
    * FreeBSD 12.0+, Solaris 11.4, and AIX 7.2.5+ for now.
    */
   UV_TCP_REUSEPORT = 2,
+
+  /* Enable TCP Fast Open. With uv_tcp_bind, the handle accepts data in the
+   * SYN once it is listening; the queue of such pending connections is as
+   * long as the listen backlog. With uv_tcp_connect2, the SYN is held back
+   * until the first write so that it can carry that data.
+   *
+   * Listeners need a platform with the TCP_FASTOPEN socket option, connecting
+   * with this flag is available only on Linux 4.11+ for now.
+   */
+  UV_TCP_FASTOPEN = 4,
 };
 
 UV_EXTERN int uv_tcp_bind(uv_tcp_t* handle,
@@ -639,6 +748,12 @@ UV_EXTERN int uv_tcp_connect(uv_connect_t* req,
                              uv_tcp_t* handle,
                              const struct sockaddr* addr,
                              uv_connect_cb cb);
+UV_EXTERN int uv_tcp_connect2(uv_connect_t* req,
+                              uv_tcp_t* handle,
+                              const struct sockaddr* addr,
+                              unsigned int flags,
+                              uv_connect_cb cb);
+UV_EXTERN int uv_tcp_fastopen_accepted(const uv_tcp_t* handle);
 
 /* uv_connect_t is a subclass of uv_req_t. */
 struct uv_connect_s {
@@ -708,7 +823,20 @@ enum uv_udp_flags {
    * Indicates that recvmmsg should be used, if available. The uv_alloc_cb
    * for this handle should create buffers that are multiples of 64 KiB.
    */
-  UV_UDP_RECVMMSG = 256
+  UV_UDP_RECVMMSG = 256,
+  /*
+   * Indicates that UDP_GRO should be enabled so that the kernel coalesces
+   * datagrams of the same flow. Passed to uv_udp_init_ex(), and set in
+   * uv_udp_recv_cb when the buffer holds more than one datagram. Use
+   * uv_udp_get_gro_segment_size() to split it.
+   */
+  UV_UDP_GRO = 512,
+  /*
+   * Indicates that the buffer is a slot of the receive ring set with
+   * uv_udp_set_recv_ring(). It is lent to the application until it is
+   * passed to uv_udp_recv_ring_release().
+   */
+  UV_UDP_RING_BUF = 1024
 };
 
 typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
@@ -718,6 +846,49 @@ typedef void (*uv_udp_recv_cb)(uv_udp_t* handle,
                                const struct sockaddr* addr,
                                unsigned flags);
 
+enum uv_udp_recv_info_flags {
+  /* local_addr and ifindex are set (IP_PKTINFO / IPV6_RECVPKTINFO). */
+  UV_UDP_INFO_LOCAL_ADDR = 1,
+  /* timestamp is set (SO_TIMESTAMPNS or SO_TIMESTAMP). */
+  UV_UDP_INFO_TIMESTAMP = 2,
+  /* tos is set (IP_RECVTOS / IPV6_RECVTCLASS). */
+  UV_UDP_INFO_TOS = 4
+};
+
+typedef struct uv_udp_recv_info_s {
+  /* UV_UDP_INFO_* flags of the fields that are set for this datagram. */
+  unsigned int flags;
+  /* Interface the datagram arrived on. */
+  unsigned int ifindex;
+  /* Address the datagram was sent to. The port is not set. */
+  struct sockaddr_storage local_addr;
+  /* When the kernel received the datagram, relative to the epoch. */
+  uv_timespec64_t timestamp;
+  /* IPv4 TOS or IPv6 traffic class byte, ECN in the two low bits. */
+  unsigned char tos;
+} uv_udp_recv_info_t;
+
+typedef void (*uv_udp_recv_ex_cb)(uv_udp_t* handle,
+                                  ssize_t nread,
+                                  const uv_buf_t* buf,
+                                  const struct sockaddr* addr,
+                                  const uv_udp_recv_info_t* info,
+                                  unsigned flags);
+
+typedef struct uv_udp_stats_s {
+  uint64_t recv_packets;
+  uint64_t recv_bytes;
+  uint64_t recv_eagain;
+  /* recvmmsg_packets / recvmmsg_calls is the average batch fill. */
+  uint64_t recvmmsg_calls;
+  uint64_t recvmmsg_packets;
+  uint64_t send_packets;
+  uint64_t send_bytes;
+  uint64_t send_eagain;
+  /* Datagrams the kernel dropped because the receive buffer was full. */
+  uint64_t kernel_drops;
+} uv_udp_stats_t;
+
 /* uv_udp_t is a subclass of uv_handle_t. */
 struct uv_udp_s {
   UV_HANDLE_FIELDS
@@ -751,6 +922,10 @@ UV_EXTERN int uv_udp_open_ex(uv_udp_t* handle,
 UV_EXTERN int uv_udp_bind(uv_udp_t* handle,
                           const struct sockaddr* addr,
                           unsigned int flags);
+UV_EXTERN int uv_udp_bind_reuseport_group(uv_udp_t* handles[/*count*/],
+                                          unsigned int count,
+                                          const struct sockaddr* addr,
+                                          unsigned int flags);
 UV_EXTERN int uv_udp_connect(uv_udp_t* handle, const struct sockaddr* addr);
 
 UV_EXTERN int uv_udp_getpeername(const uv_udp_t* handle,
@@ -780,6 +955,35 @@ UV_EXTERN int uv_udp_send(uv_udp_send_t* req,
                           unsigned int nbufs,
                           const struct sockaddr* addr,
                           uv_udp_send_cb send_cb);
+UV_EXTERN int uv_udp_send_gso(uv_udp_send_t* req,
+                              uv_udp_t* handle,
+                              const uv_buf_t bufs[],
+                              unsigned int nbufs,
+                              const struct sockaddr* addr,
+                              unsigned int segment_size,
+                              uv_udp_send_cb send_cb);
+UV_EXTERN int uv_udp_send_from(uv_udp_send_t* req,
+                               uv_udp_t* handle,
+                               const uv_buf_t bufs[],
+                               unsigned int nbufs,
+                               const struct sockaddr* addr,
+                               const struct sockaddr* src_addr,
+                               uv_udp_send_cb send_cb);
+UV_EXTERN int uv_udp_send_at(uv_udp_send_t* req,
+                             uv_udp_t* handle,
+                             const uv_buf_t bufs[],
+                             unsigned int nbufs,
+                             const struct sockaddr* addr,
+                             uint64_t txtime,
+                             uv_udp_send_cb send_cb);
+UV_EXTERN int uv_udp_send_batch(uv_udp_send_t* req,
+                                uv_udp_t* handle,
+                                uv_buf_t* bufs[/*count*/],
+                                unsigned int nbufs[/*count*/],
+                                struct sockaddr* addrs[/*count*/],
+                                unsigned int count,
+                                uv_udp_send_cb send_cb);
+UV_EXTERN int uv_udp_set_pacing_rate(uv_udp_t* handle, uint64_t rate);
 UV_EXTERN int uv_udp_try_send(uv_udp_t* handle,
                               const uv_buf_t bufs[],
                               unsigned int nbufs,
@@ -793,8 +997,22 @@ UV_EXTERN int uv_udp_try_send2(uv_udp_t* handle,
 UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle,
                                 uv_alloc_cb alloc_cb,
                                 uv_udp_recv_cb recv_cb);
+UV_EXTERN int uv_udp_recv_start_ex(uv_udp_t* handle,
+                                   uv_alloc_cb alloc_cb,
+                                   uv_udp_recv_ex_cb recv_cb,
+                                   unsigned int info_flags);
 UV_EXTERN int uv_udp_using_recvmmsg(const uv_udp_t* handle);
+UV_EXTERN size_t uv_udp_get_gro_segment_size(const uv_udp_t* handle);
+UV_EXTERN int uv_udp_set_mmsg_batch(uv_udp_t* handle,
+                                    unsigned int recv_batch,
+                                    unsigned int send_batch,
+                                    int adaptive);
+UV_EXTERN int uv_udp_set_recv_ring(uv_udp_t* handle,
+                                   unsigned int nslots,
+                                   size_t slot_size);
+UV_EXTERN int uv_udp_recv_ring_release(uv_udp_t* handle, const uv_buf_t* buf);
 UV_EXTERN int uv_udp_recv_stop(uv_udp_t* handle);
+UV_EXTERN int uv_udp_get_stats(uv_udp_t* handle, uv_udp_stats_t* stats);
 UV_EXTERN size_t uv_udp_get_send_queue_size(const uv_udp_t* handle);
 UV_EXTERN size_t uv_udp_get_send_queue_count(const uv_udp_t* handle);
 
@@ -1182,6 +1400,16 @@ UV_EXTERN int uv_kill(int pid, int signum);
 UV_EXTERN uv_pid_t uv_process_get_pid(const uv_process_t*);
 
 
+typedef enum {
+  UV_WORK_CPU,
+  UV_WORK_FAST_IO,
+  UV_WORK_SLOW_IO,
+  /* UV_WORK_USER to UV_WORK_KIND_MAX - 1 are free for use by applications.
+   * UV_WORK_KIND_MAX may grow, no public struct depends on it. */
+  UV_WORK_USER,
+  UV_WORK_KIND_MAX = UV_WORK_USER + 8
+} uv_work_kind;
+
 /*
  * uv_work_t is a subclass of uv_req_t.
  */
@@ -1197,6 +1425,38 @@ UV_EXTERN int uv_queue_work(uv_loop_t* loop,
                             uv_work_t* req,
                             uv_work_cb work_cb,
                             uv_after_work_cb after_work_cb);
+UV_EXTERN int uv_queue_work_ex(uv_loop_t* loop,
+                               uv_work_t* req,
+                               uv_work_kind kind,
+                               uv_work_cb work_cb,
+                               uv_after_work_cb after_work_cb);
+UV_EXTERN int uv_threadpool_set_limit(uv_work_kind kind, unsigned int limit);
+UV_EXTERN int uv_threadpool_get_limit(uv_work_kind kind, unsigned int* limit);
+
+/*
+ * uv_work_bulk_t is a subclass of uv_req_t.
+ */
+struct uv_work_bulk_s {
+  UV_REQ_FIELDS
+  uv_loop_t* loop;
+  size_t count;
+  size_t chunk_size;
+  uv_work_bulk_cb work_cb;
+  uv_after_work_bulk_cb after_work_cb;
+  /* private */
+  size_t next_index;
+  void* lanes;
+  unsigned int nlanes;
+  unsigned int pending_lanes;
+  unsigned int cancelled_lanes;
+};
+
+UV_EXTERN int uv_queue_work_bulk(uv_loop_t* loop,
+                                 uv_work_bulk_t* req,
+                                 size_t count,
+                                 size_t chunk_size,
+                                 uv_work_bulk_cb work_cb,
+                                 uv_after_work_bulk_cb after_work_cb);
 
 UV_EXTERN int uv_cancel(uv_req_t* req);
 
@@ -1399,6 +1659,34 @@ struct uv_metrics_s {
 UV_EXTERN int uv_metrics_info(uv_loop_t* loop, uv_metrics_t* metrics);
 UV_EXTERN uint64_t uv_metrics_idle_time(uv_loop_t* loop);
 
+/* Bucket 0 counts durations below 1 microsecond, bucket i counts durations
+ * in [2^(i-1), 2^i) microseconds, the last bucket counts everything longer.
+ */
+#define UV_WORK_HISTOGRAM_SIZE 24
+
+struct uv_work_metrics_s {
+  uint64_t queued;
+  uint64_t running;
+  uint64_t submitted;
+  uint64_t completed;
+  uint64_t cancelled;
+  uint64_t wait_time; /* nanoseconds */
+  uint64_t run_time; /* nanoseconds */
+  uint64_t wait_histogram[UV_WORK_HISTOGRAM_SIZE];
+  uint64_t run_histogram[UV_WORK_HISTOGRAM_SIZE];
+};
+
+struct uv_threadpool_metrics_s {
+  unsigned int nthreads;
+  unsigned int busy_threads;
+  unsigned int idle_threads;
+};
+
+UV_EXTERN int uv_threadpool_metrics(uv_threadpool_metrics_t* metrics);
+UV_EXTERN int uv_threadpool_work_metrics(uv_loop_t* loop,
+                                         uv_work_kind kind,
+                                         uv_work_metrics_t* metrics);
+
 typedef enum {
   UV_FS_UNKNOWN = -1,
   UV_FS_CUSTOM,
@@ -261,6 +261,10 @@ typedef struct {
   int error;                                                                  \
   uv_buf_t bufsml[4];                                                         \
 
+#define UV_SPLICE_PRIVATE_FIELDS                                              \
+  int fds[2];                                                                 \
+  size_t buffered;                                                            \
+
 #define UV_CONNECT_PRIVATE_FIELDS                                             \
   struct uv__queue queue;                                                     \
 
@@ -387,6 +387,9 @@ typedef struct {
   HANDLE event_handle;          \
   HANDLE wait_handle;
 
+#define UV_SPLICE_PRIVATE_FIELDS                                              \
+  /* empty */
+
 #define UV_CONNECT_PRIVATE_FIELDS                                             \
   /* empty */
 
@@ -29,100 +29,438 @@
 
 #define MAX_THREADPOOL_SIZE 1024
 
+/* Bounds for the number of iterations a worker busy-waits for new work
+ * before it goes to sleep.
+ */
+#define MIN_SPIN 64
+#define MAX_SPIN 4096
+
+/* Every worker sleeps on its own condition variable so that post() can wake
+ * exactly one specific worker, the one that went idle most recently and is
+ * therefore most likely to still have a warm cache.
+ */
+struct uv__worker {
+  uv_thread_t thread;
+  uv_cond_t cond;
+  struct uv__queue link;  /* In `idle_workers` or `spinning_workers`. */
+  unsigned int spin;
+  uv_sem_t* started;  /* Posted once the thread runs, see init_threads(). */
+};
+
 static uv_once_t once = UV_ONCE_INIT;
-static uv_cond_t cond;
 static uv_mutex_t mutex;
 static unsigned int idle_threads;
-static unsigned int slow_io_work_running;
 static unsigned int nthreads;
-static uv_thread_t* threads;
-static uv_thread_t default_threads[4];
+static struct uv__worker* workers;
+static struct uv__worker default_workers[4];
+static struct uv__queue idle_workers;
+static struct uv__queue spinning_workers;
+static int wq_generation;  /* Bumped by wake_worker(), read by spinners. */
 static struct uv__queue exit_message;
+static uv_work_metrics_t work_metrics[UV_WORK_KIND_MAX];  /* Under `mutex`. */
+
+/* Work waits in the `pending_wq` of its kind, and the kind's
+ * `run_work_message` takes its place in `wq`. That is how a worker knows the
+ * kind of the work it runs. Workers skip the messages of kinds that are at
+ * their limit, so a flood of work of one kind can't monopolize the threadpool.
+ */
 static struct uv__queue wq;
-static struct uv__queue run_slow_work_message;
-static struct uv__queue slow_io_pending_wq;
+static struct uv__queue run_work_message[UV_WORK_KIND_MAX];
+static struct uv__queue pending_wq[UV_WORK_KIND_MAX];
+static unsigned int work_limit[UV_WORK_KIND_MAX];  /* 0 means no limit. */
+static int work_limit_set[UV_WORK_KIND_MAX];
+
+/* uv_threadpool_set_limit() doesn't start the threads, init_threads() picks
+ * up the limits set before. Writers of `work_limit` hold `limit_mutex`, and
+ * `mutex` as well once the threads run.
+ */
+static uv_once_t limit_once = UV_ONCE_INIT;
+static uv_mutex_t limit_mutex;
+static int threads_running;  /* Under `limit_mutex`. */
 
-static unsigned int slow_work_thread_threshold(void) {
-  return (nthreads + 1) / 2;
+/* Submission times of the work in `pending_wq`, oldest first, for the wait
+ * time metrics. struct uv__work is embedded in public requests and can't
+ * carry them. A ring buffer per kind, its capacity a power of two.
+ */
+struct uv__work_stamp {
+  struct uv__work* w;
+  uint64_t time;
+};
+
+static struct {
+  struct uv__work_stamp* v;
+  unsigned int head;
+  unsigned int len;
+  unsigned int cap;
+} submit_stamps[UV_WORK_KIND_MAX];
+
+static unsigned int slow_work_thread_threshold(unsigned int n) {
+  return (n + 1) / 2;
 }
 
+/* A bulk request is spread over up to `nthreads` lanes. Each lane is queued
+ * like a regular work request and pulls chunks of indices from the request
+ * until none are left.
+ */
+struct uv__work_bulk_lane {
+  struct uv__work work;
+  uv_work_bulk_t* req;
+};
+
 static void uv__cancelled(struct uv__work* w) {
   abort();
 }
 
 
+static unsigned int uv__work_histogram_bucket(uint64_t ns) {
+  unsigned int i;
+  uint64_t us;
+
+  us = ns / 1000;
+  for (i = 0; us != 0 && i < UV_WORK_HISTOGRAM_SIZE - 1; i++)
+    us >>= 1;
+
+  return i;
+}
+
+
+static void uv__work_metrics_wait(uv_work_metrics_t* m, uint64_t wait_time) {
+  m->wait_time += wait_time;
+  m->wait_histogram[uv__work_histogram_bucket(wait_time)]++;
+}
+
+
+static void uv__work_metrics_run(uv_work_metrics_t* m, uint64_t run_time) {
+  m->completed++;
+  m->run_time += run_time;
+  m->run_histogram[uv__work_histogram_bucket(run_time)]++;
+}
+
+
+/* `mutex` must be held. */
+static int below_limit(unsigned int kind) {
+  return work_limit[kind] == 0 || work_metrics[kind].running < work_limit[kind];
+}
+
+
+static int is_run_work_message(struct uv__queue* q) {
+  return (uintptr_t) q - (uintptr_t) run_work_message <
+         sizeof(run_work_message);
+}
+
+
+static int is_pending_wq(struct uv__queue* q) {
+  return (uintptr_t) q - (uintptr_t) pending_wq < sizeof(pending_wq);
+}
+
+
+/* Returns the kind of work that is waiting in one of the `pending_wq`.
+ * `mutex` must be held.
+ */
+static unsigned int pending_kind(struct uv__work* w) {
+  struct uv__queue* q;
+
+  q = uv__queue_next(&w->wq);
+  while (!is_pending_wq(q))
+    q = uv__queue_next(q);
+
+  return q - pending_wq;
+}
+
+
+/* Records when `w` was submitted. Best effort, the wait time of work that
+ * has no stamp is not measured. `mutex` must be held.
+ */
+static void stamp_push(unsigned int kind, struct uv__work* w, uint64_t time) {
+  struct uv__work_stamp* v;
+  unsigned int mask;
+  unsigned int cap;
+  unsigned int i;
+
+  if (submit_stamps[kind].len == submit_stamps[kind].cap) {
+    cap = 2 * submit_stamps[kind].cap;
+    if (cap == 0)
+      cap = 16;
+
+    v = uv__malloc(cap * sizeof(*v));
+    if (v == NULL)
+      return;
+
+    mask = submit_stamps[kind].cap - 1;
+    for (i = 0; i < submit_stamps[kind].len; i++)
+      v[i] = submit_stamps[kind].v[(submit_stamps[kind].head + i) & mask];
+
+    uv__free(submit_stamps[kind].v);
+    submit_stamps[kind].v = v;
+    submit_stamps[kind].head = 0;
+    submit_stamps[kind].cap = cap;
+  }
+
+  mask = submit_stamps[kind].cap - 1;
+  i = (submit_stamps[kind].head + submit_stamps[kind].len) & mask;
+  submit_stamps[kind].v[i].w = w;
+  submit_stamps[kind].v[i].time = time;
+  submit_stamps[kind].len++;
+}
+
+
+/* Takes the stamp of `w`, the oldest work of its kind. Returns 0 if it has
+ * none. `mutex` must be held.
+ */
+static int stamp_pop(unsigned int kind, struct uv__work* w, uint64_t* time) {
+  struct uv__work_stamp* e;
+
+  if (submit_stamps[kind].len == 0)
+    return 0;
+
+  e = &submit_stamps[kind].v[submit_stamps[kind].head];
+  if (e->w != w)
+    return 0;
+
+  *time = e->time;
+  submit_stamps[kind].head++;
+  submit_stamps[kind].head &= submit_stamps[kind].cap - 1;
+  submit_stamps[kind].len--;
+  return 1;
+}
+
+
+/* Returns the submission time of the oldest work of `kind` that has a stamp.
+ * `mutex` must be held.
+ */
+static int stamp_peek(unsigned int kind, uint64_t* time) {
+  if (submit_stamps[kind].len == 0)
+    return 0;
+
+  *time = submit_stamps[kind].v[submit_stamps[kind].head].time;
+  return 1;
+}
+
+
+/* Drops the stamp of cancelled work. `mutex` must be held. */
+static void stamp_remove(unsigned int kind, struct uv__work* w) {
+  struct uv__work_stamp* v;
+  unsigned int mask;
+  unsigned int head;
+  unsigned int i;
+
+  v = submit_stamps[kind].v;
+  head = submit_stamps[kind].head;
+  mask = submit_stamps[kind].cap - 1;
+
+  for (i = 0; i < submit_stamps[kind].len; i++)
+    if (v[(head + i) & mask].w == w)
+      break;
+
+  if (i == submit_stamps[kind].len)
+    return;
+
+  for (i++; i < submit_stamps[kind].len; i++)
+    v[(head + i - 1) & mask] = v[(head + i) & mask];
+
+  submit_stamps[kind].len--;
+}
+
+
+/* Queues the `run_work_message` of `kind` ahead of the kinds whose oldest
+ * work is younger, so that work runs in submission order across kinds.
+ * `mutex` must be held.
+ */
+static void schedule_kind(unsigned int kind) {
+  struct uv__queue* q;
+  uint64_t other;
+  uint64_t time;
+
+  if (stamp_peek(kind, &time))
+    uv__queue_foreach(q, &wq)
+      if (is_run_work_message(q) &&
+          stamp_peek(q - run_work_message, &other) &&
+          other > time) {
+        uv__queue_insert_tail(q, &run_work_message[kind]);
+        return;
+      }
+
+  uv__queue_insert_tail(&wq, &run_work_message[kind]);
+}
+
+
+/* Returns the first entry in `wq` that a worker can act on, or NULL when
+ * there is nothing to do. `mutex` must be held.
+ */
+static struct uv__queue* next_work(void) {
+  struct uv__queue* q;
+
+  uv__queue_foreach(q, &wq)
+    if (!is_run_work_message(q) || below_limit(q - run_work_message))
+      return q;
+
+  return NULL;
+}
+
+
+static int work_available(void) {
+  return next_work() != NULL;
+}
+
+
+/* Hands new work to one worker. A spinning worker is claimed so other posts
+ * don't count on it, and told through `wq_generation` to stop spinning.
+ * `mutex` must be held. Returns 0 if all workers are busy.
+ */
+static int wake_worker(void) {
+  struct uv__worker* w;
+  struct uv__queue* q;
+
+  if (!uv__queue_empty(&spinning_workers)) {
+    q = uv__queue_head(&spinning_workers);
+    uv__queue_remove(q);
+    uv__queue_init(q);
+    uv__exchange_int_relaxed(&wq_generation, wq_generation + 1);
+    return 1;
+  }
+
+  if (!uv__queue_empty(&idle_workers)) {
+    q = uv__queue_head(&idle_workers);
+    uv__queue_remove(q);
+    uv__queue_init(q);
+    w = uv__queue_data(q, struct uv__worker, link);
+    uv_cond_signal(&w->cond);
+    return 1;
+  }
+
+  return 0;
+}
+
+
+/* Waits until post() hands out new work. The worker busy-waits for a short
+ * while first because a futex wakeup costs tens of microseconds. How long it
+ * spins adapts to whether spinning paid off the last time.
+ * `mutex` must be held and is held again on return.
+ */
+static void worker_wait(struct uv__worker* self) {
+  unsigned int i;
+  int generation;
+
+  if (self->spin > 0) {
+    generation = wq_generation;
+    uv__queue_insert_head(&spinning_workers, &self->link);
+    uv_mutex_unlock(&mutex);
+
+    for (i = 0; i < self->spin; i++) {
+      if (uv__load_int_relaxed(&wq_generation) != generation)
+        break;
+      uv__cpu_relax();
+    }
+
+    uv_mutex_lock(&mutex);
+    if (!uv__queue_empty(&self->link)) {
+      uv__queue_remove(&self->link);
+      uv__queue_init(&self->link);
+    }
+
+    if (work_available()) {
+      self->spin *= 2;
+      if (self->spin > MAX_SPIN)
+        self->spin = MAX_SPIN;
+      return;
+    }
+
+    self->spin /= 2;
+    if (self->spin < MIN_SPIN)
+      self->spin = MIN_SPIN;
+  }
+
+  idle_threads += 1;
+  uv__queue_insert_head(&idle_workers, &self->link);
+  uv_cond_wait(&self->cond, &mutex);
+  if (!uv__queue_empty(&self->link)) {
+    /* Spurious wakeup. */
+    uv__queue_remove(&self->link);
+    uv__queue_init(&self->link);
+  }
+  idle_threads -= 1;
+}
+
+
 /* To avoid deadlock with uv_cancel() it's crucial that the worker
  * never holds the global mutex and the loop-local mutex at the same time.
  */
 static void worker(void* arg) {
+  uv__work_metrics_t* loop_metrics;
+  uv_work_metrics_t* m;
   struct uv__work* w;
   struct uv__queue* q;
-  int is_slow_work;
+  uint64_t submit_time;
+  uint64_t start_time;
+  uint64_t wait_time;
+  uint64_t run_time;
+  struct uv__worker* self;
+  unsigned int kind;
+  int has_wait_time;
+
+  self = arg;
+  arg = NULL;
 
   uv_thread_setname("libuv-worker");
-  uv_sem_post((uv_sem_t*) arg);
-  arg = NULL;
+  uv_sem_post(self->started);
 
   uv_mutex_lock(&mutex);
   for (;;) {
     /* `mutex` should always be locked at this point. */
 
-    /* Keep waiting while either no work is present or only slow I/O
-       and we're at the threshold for that. */
-    while (uv__queue_empty(&wq) ||
-           (uv__queue_head(&wq) == &run_slow_work_message &&
-            uv__queue_next(&run_slow_work_message) == &wq &&
-            slow_io_work_running >= slow_work_thread_threshold())) {
-      idle_threads += 1;
-      uv_cond_wait(&cond, &mutex);
-      idle_threads -= 1;
-    }
+    while ((q = next_work()) == NULL)
+      worker_wait(self);
 
-    q = uv__queue_head(&wq);
     if (q == &exit_message) {
-      uv_cond_signal(&cond);
+      wake_worker();
       uv_mutex_unlock(&mutex);
       break;
     }
 
     uv__queue_remove(q);
-    uv__queue_init(q);  /* Signal uv_cancel() that the work req is executing. */
-
-    is_slow_work = 0;
-    if (q == &run_slow_work_message) {
-      /* If we're at the slow I/O threshold, re-schedule until after all
-         other work in the queue is done. */
-      if (slow_io_work_running >= slow_work_thread_threshold()) {
-        uv__queue_insert_tail(&wq, q);
-        continue;
-      }
-
-      /* If we encountered a request to run slow I/O work but there is none
-         to run, that means it's cancelled => Start over. */
-      if (uv__queue_empty(&slow_io_pending_wq))
-        continue;
+    uv__queue_init(q);
+    kind = q - run_work_message;
 
-      is_slow_work = 1;
-      slow_io_work_running++;
+    /* If we encountered a request to run work but there is none to run,
+       that means it's cancelled => Start over. */
+    if (uv__queue_empty(&pending_wq[kind]))
+      continue;
 
-      q = uv__queue_head(&slow_io_pending_wq);
-      uv__queue_remove(q);
-      uv__queue_init(q);
+    q = uv__queue_head(&pending_wq[kind]);
+    uv__queue_remove(q);
+    uv__queue_init(q);  /* Signal uv_cancel() that the work req is executing. */
 
-      /* If there is more slow I/O work, schedule it to be run as well. */
-      if (!uv__queue_empty(&slow_io_pending_wq)) {
-        uv__queue_insert_tail(&wq, &run_slow_work_message);
-        if (idle_threads > 0)
-          uv_cond_signal(&cond);
-      }
+    w = uv__queue_data(q, struct uv__work, wq);
+    loop_metrics = &uv__get_internal_fields(w->loop)->work_metrics;
+    start_time = uv_hrtime();
+    has_wait_time = stamp_pop(kind, w, &submit_time);
+    wait_time = 0;
+    if (has_wait_time)
+      wait_time = start_time - submit_time;
+
+    m = &work_metrics[kind];
+    m->queued--;
+    m->running++;
+    if (has_wait_time)
+      uv__work_metrics_wait(m, wait_time);
+    loop_metrics->work[kind].queued--;
+
+    /* If there is more work of this kind, schedule it to be run as well. */
+    if (!uv__queue_empty(&pending_wq[kind])) {
+      schedule_kind(kind);
+      if (below_limit(kind))
+        wake_worker();
     }
 
     uv_mutex_unlock(&mutex);
 
-    w = uv__queue_data(q, struct uv__work, wq);
     w->work(w);
+    run_time = uv_hrtime() - start_time;
 
     uv_mutex_lock(&w->loop->wq_mutex);
+    if (has_wait_time)
+      uv__work_metrics_wait(&loop_metrics->work[kind], wait_time);
+    uv__work_metrics_run(&loop_metrics->work[kind], run_time);
     w->work = NULL;  /* Signal uv_cancel() that the work req is done
                         executing. */
     uv__queue_insert_tail(&w->loop->wq, &w->wq);
@@ -132,31 +470,85 @@ static void worker(void* arg) {
     /* Lock `mutex` since that is expected at the start of the next
      * iteration. */
     uv_mutex_lock(&mutex);
-    if (is_slow_work) {
-      /* `slow_io_work_running` is protected by `mutex`. */
-      slow_io_work_running--;
-    }
+    m->running--;
+    uv__work_metrics_run(m, run_time);
   }
 }
 
 
+/* `mutex` must be held. */
+static void uv__work_metrics_submit(uv_loop_t* loop,
+                                    enum uv__work_kind kind,
+                                    unsigned int n) {
+  uv__work_metrics_t* loop_metrics;
+
+  loop_metrics = &uv__get_internal_fields(loop)->work_metrics;
+  loop_metrics->work[kind].queued += n;
+  loop_metrics->work[kind].submitted += n;
+  work_metrics[kind].queued += n;
+  work_metrics[kind].submitted += n;
+}
+
+
+/* Queues `w` and returns whether a worker should be woken up for it.
+ * `mutex` must be held.
+ */
+static int post_locked(struct uv__work* w, unsigned int kind, uint64_t now) {
+  stamp_push(kind, w, now);
+  uv__queue_insert_tail(&pending_wq[kind], &w->wq);
+  if (!uv__queue_empty(&run_work_message[kind])) {
+    /* Running work of this kind is already scheduled => A worker that runs
+       said other work will schedule this one as well, and wake another
+       worker for it. Waking one here too would find nothing to do. */
+    return 0;
+  }
+
+  uv__queue_insert_tail(&wq, &run_work_message[kind]);
+  return below_limit(kind);
+}
+
+
 static void post(struct uv__queue* q, enum uv__work_kind kind) {
+  uint64_t now;
+  int wake;
+
+  now = uv_hrtime();
   uv_mutex_lock(&mutex);
-  if (kind == UV__WORK_SLOW_IO) {
-    /* Insert into a separate queue. */
-    uv__queue_insert_tail(&slow_io_pending_wq, q);
-    if (!uv__queue_empty(&run_slow_work_message)) {
-      /* Running slow I/O tasks is already scheduled => Nothing to do here.
-         The worker that runs said other task will schedule this one as well. */
-      uv_mutex_unlock(&mutex);
-      return;
-    }
-    q = &run_slow_work_message;
+  if (q == &exit_message) {
+    uv__queue_insert_tail(&wq, q);
+    wake = 1;
+  } else {
+    uv__work_metrics_submit(uv__queue_data(q, struct uv__work, wq)->loop,
+                            kind,
+                            1);
+    wake = post_locked(uv__queue_data(q, struct uv__work, wq), kind, now);
   }
 
-  uv__queue_insert_tail(&wq, q);
-  if (idle_threads > 0)
-    uv_cond_signal(&cond);
+  if (wake)
+    wake_worker();
+  uv_mutex_unlock(&mutex);
+}
+
+
+/* Like post() but queues all lanes of a bulk request with a single
+ * acquisition of `mutex`.
+ */
+static void post_bulk(struct uv__work_bulk_lane* lanes,
+                      unsigned int n,
+                      enum uv__work_kind kind) {
+  unsigned int nwake;
+  unsigned int i;
+  uint64_t now;
+
+  now = uv_hrtime();
+  uv_mutex_lock(&mutex);
+  uv__work_metrics_submit(lanes[0].work.loop, kind, n);
+  nwake = 0;
+  for (i = 0; i < n; i++)
+    nwake += post_locked(&lanes[i].work, kind, now);
+  for (i = 0; i < nwake; i++)
+    if (!wake_worker())
+      break;
   uv_mutex_unlock(&mutex);
 }
 
@@ -177,31 +569,128 @@ void uv__threadpool_cleanup(void) {
 #endif
 
   for (i = 0; i < nthreads; i++)
-    if (uv_thread_join(threads + i))
+    if (uv_thread_join(&workers[i].thread))
       abort();
 
-  if (threads != default_threads)
-    uv__free(threads);
+  for (i = 0; i < nthreads; i++)
+    uv_cond_destroy(&workers[i].cond);
+
+  if (workers != default_workers)
+    uv__free(workers);
+
+  for (i = 0; i < UV_WORK_KIND_MAX; i++) {
+    uv__free(submit_stamps[i].v);
+    memset(&submit_stamps[i], 0, sizeof(submit_stamps[i]));
+  }
+
+  uv_mutex_lock(&limit_mutex);
+  threads_running = 0;
+  uv_mutex_unlock(&limit_mutex);
 
   uv_mutex_destroy(&mutex);
-  uv_cond_destroy(&cond);
 
-  threads = NULL;
+  workers = NULL;
   nthreads = 0;
 }
 
 
-static void init_threads(void) {
-  uv_thread_options_t config;
-  unsigned int i;
+/* Parses a CPU list like "0-3,8" into `mask`. Returns the number of CPUs in
+ * the list, or 0 if the list is malformed or names a CPU outside the mask.
+ */
+static unsigned int parse_cpu_list(const char* s, char* mask, size_t size) {
+  unsigned long first;
+  unsigned long last;
+  unsigned int n;
+  char* end;
+
+  n = 0;
+  for (;;) {
+    first = strtoul(s, &end, 10);
+    if (end == s)
+      return 0;
+
+    last = first;
+    if (*end == '-') {
+      s = end + 1;
+      last = strtoul(s, &end, 10);
+      if (end == s)
+        return 0;
+    }
+
+    if (first > last || last >= size)
+      return 0;
+
+    for (; first <= last; first++) {
+      n += !mask[first];
+      mask[first] = 1;
+    }
+
+    if (*end == '\0')
+      return n;
+
+    if (*end != ',')
+      return 0;
+
+    s = end + 1;
+  }
+}
+
+
+static void init_limit_mutex(void) {
+  if (uv_mutex_init(&limit_mutex))
+    abort();
+}
+
+
+/* Returns the number of threads the pool starts with. Stores the CPUs from
+ * UV_THREADPOOL_CPUS in `*cpumask` when `cpumask` isn't NULL, or NULL if
+ * the variable isn't set or usable. The caller frees it.
+ */
+static unsigned int threadpool_size(char** cpumask, int* cpumasksize) {
+  unsigned int ncpus;
+  unsigned int n;
   size_t buflen;
   char buf[16];
+  char cpus[256];
+  char* mask;
   const char* val;
   int err;
 
-  uv_sem_t sem;
+  /* UV_THREADPOOL_CPUS restricts the workers to a set of CPUs. Keeping them
+   * off the CPUs that run the event loops is up to the user, who knows where
+   * the loops are pinned.
+   */
+  mask = NULL;
+  *cpumasksize = uv_cpumask_size();
+  ncpus = uv_available_parallelism();
+  buflen = ARRAY_SIZE(cpus);
+  err = uv_os_getenv("UV_THREADPOOL_CPUS", cpus, &buflen);
+  if (err == 0 && *cpumasksize > 0) {
+    mask = uv__calloc(*cpumasksize, 1);
+    if (mask != NULL) {
+      n = parse_cpu_list(cpus, mask, *cpumasksize);
+      if (n == 0) {
+        uv__free(mask);
+        mask = NULL;
+      } else if (n < ncpus) {
+        ncpus = n;
+      }
+    }
+  }
 
-  nthreads = ARRAY_SIZE(default_threads);
+  if (cpumask != NULL)
+    *cpumask = mask;
+  else
+    uv__free(mask);
+
+  /* Don't oversubscribe CPU-constrained containers but keep at least two
+   * threads so a single blocking operation can't stall the threadpool.
+   */
+  n = ARRAY_SIZE(default_workers);
+  if (n > ncpus)
+    n = ncpus;
+  if (n < 2)
+    n = 2;
 
   buflen = ARRAY_SIZE(buf);
   err = uv_os_getenv("UV_THREADPOOL_SIZE", buf, &buflen);
@@ -210,30 +699,64 @@ static void init_threads(void) {
     val = buf;
   
   if (val != NULL)
-    nthreads = atoi(val);
-  if (nthreads == 0)
-    nthreads = 1;
-  if (nthreads > MAX_THREADPOOL_SIZE)
-    nthreads = MAX_THREADPOOL_SIZE;
-
-  threads = default_threads;
-  if (nthreads > ARRAY_SIZE(default_threads)) {
-    threads = uv__malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
-      nthreads = ARRAY_SIZE(default_threads);
-      threads = default_threads;
+    n = atoi(val);
+  if (n == 0)
+    n = 1;
+  if (n > MAX_THREADPOOL_SIZE)
+    n = MAX_THREADPOOL_SIZE;
+
+  return n;
+}
+
+
+static void init_threads(void) {
+  uv_thread_options_t config;
+  unsigned int i;
+  char* cpumask;
+  unsigned int spin;
+  int cpumasksize;
+  uv_sem_t sem;
+
+  memset(work_metrics, 0, sizeof(work_metrics));
+
+  nthreads = threadpool_size(&cpumask, &cpumasksize);
+
+  workers = default_workers;
+  if (nthreads > ARRAY_SIZE(default_workers)) {
+    workers = uv__malloc(nthreads * sizeof(workers[0]));
+    if (workers == NULL) {
+      nthreads = ARRAY_SIZE(default_workers);
+      workers = default_workers;
     }
   }
 
-  if (uv_cond_init(&cond))
-    abort();
-
   if (uv_mutex_init(&mutex))
     abort();
 
+  /* By default at most half of the threads run slow I/O so that slow DNS
+     lookups can't block file system operations. */
+  uv_once(&limit_once, init_limit_mutex);
+  uv_mutex_lock(&limit_mutex);
+  if (!work_limit_set[UV__WORK_SLOW_IO])
+    work_limit[UV__WORK_SLOW_IO] = slow_work_thread_threshold(nthreads);
+  threads_running = 1;
+  uv_mutex_unlock(&limit_mutex);
+
   uv__queue_init(&wq);
-  uv__queue_init(&slow_io_pending_wq);
-  uv__queue_init(&run_slow_work_message);
+  for (i = 0; i < UV_WORK_KIND_MAX; i++) {
+    uv__queue_init(&pending_wq[i]);
+    uv__queue_init(&run_work_message[i]);
+    submit_stamps[i].head = 0;  /* Stale after fork(). */
+    submit_stamps[i].len = 0;
+  }
+
+  uv__queue_init(&idle_workers);
+  uv__queue_init(&spinning_workers);
+
+  /* Busy-waiting only helps when the submitting thread runs on another CPU. */
+  spin = 0;
+  if (uv_available_parallelism() > 1)
+    spin = MIN_SPIN;
 
   if (uv_sem_init(&sem, 0))
     abort();
@@ -241,14 +764,27 @@ static void init_threads(void) {
   config.flags = UV_THREAD_HAS_STACK_SIZE;
   config.stack_size = 8u << 20;  /* 8 MB */
 
-  for (i = 0; i < nthreads; i++)
-    if (uv_thread_create_ex(threads + i, &config, worker, &sem))
+  for (i = 0; i < nthreads; i++) {
+    if (uv_cond_init(&workers[i].cond))
       abort();
+    uv__queue_init(&workers[i].link);
+    workers[i].spin = spin;
+    workers[i].started = &sem;
+    if (uv_thread_create_ex(&workers[i].thread, &config, worker, workers + i))
+      abort();
+  }
 
   for (i = 0; i < nthreads; i++)
     uv_sem_wait(&sem);
 
   uv_sem_destroy(&sem);
+
+  if (cpumask != NULL) {
+    /* Best effort, the workers are still usable if this fails. */
+    for (i = 0; i < nthreads; i++)
+      uv_thread_setaffinity(&workers[i].thread, cpumask, NULL, cpumasksize);
+    uv__free(cpumask);
+  }
 }
 
 
@@ -256,6 +792,8 @@ static void init_threads(void) {
 static void reset_once(void) {
   uv_once_t child_once = UV_ONCE_INIT;
   memcpy(&once, &child_once, sizeof(child_once));
+  memcpy(&limit_once, &child_once, sizeof(child_once));
+  threads_running = 0;
 }
 #endif
 
@@ -290,15 +828,25 @@ void uv__work_submit(uv_loop_t* loop,
  * that go through io_uring instead of the thread pool.
  */
 static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
+  unsigned int kind;
   int cancelled;
 
   uv_once(&once, init_once);  /* Ensure |mutex| is initialized. */
   uv_mutex_lock(&mutex);
   uv_mutex_lock(&w->loop->wq_mutex);
 
-  cancelled = !uv__queue_empty(&w->wq) && w->work != NULL;
-  if (cancelled)
+  cancelled = !uv__queue_empty(&w->wq) &&
+              w->work != NULL &&
+              w->work != uv__cancelled;
+  if (cancelled) {
+    kind = pending_kind(w);
     uv__queue_remove(&w->wq);
+    stamp_remove(kind, w);
+    uv__get_internal_fields(w->loop)->work_metrics.work[kind].queued--;
+    uv__get_internal_fields(w->loop)->work_metrics.work[kind].cancelled++;
+    work_metrics[kind].queued--;
+    work_metrics[kind].cancelled++;
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
   uv_mutex_unlock(&mutex);
@@ -316,6 +864,66 @@ static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
 }
 
 
+int uv_threadpool_metrics(uv_threadpool_metrics_t* metrics) {
+  unsigned int i;
+
+  if (metrics == NULL)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);  /* Ensure |mutex| is initialized. */
+
+  uv_mutex_lock(&mutex);
+  metrics->nthreads = nthreads;
+  metrics->idle_threads = idle_threads;
+  metrics->busy_threads = 0;
+  for (i = 0; i < UV_WORK_KIND_MAX; i++)
+    metrics->busy_threads += work_metrics[i].running;
+  uv_mutex_unlock(&mutex);
+
+  return 0;
+}
+
+
+int uv_threadpool_work_metrics(uv_loop_t* loop,
+                               uv_work_kind kind,
+                               uv_work_metrics_t* metrics) {
+  uv_work_metrics_t* lm;
+
+  if ((unsigned int) kind >= UV_WORK_KIND_MAX || metrics == NULL)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);  /* Ensure |mutex| is initialized. */
+
+  if (loop == NULL) {
+    uv_mutex_lock(&mutex);
+    *metrics = work_metrics[kind];
+    uv_mutex_unlock(&mutex);
+    return 0;
+  }
+
+  /* Snapshot the completion counters before the submission counters so that
+   * `running` can't underflow when a request completes in between.
+   */
+  lm = &uv__get_internal_fields(loop)->work_metrics.work[kind];
+  uv_mutex_lock(&loop->wq_mutex);
+  *metrics = *lm;
+  uv_mutex_unlock(&loop->wq_mutex);
+
+  uv_mutex_lock(&mutex);
+  metrics->queued = lm->queued;
+  metrics->submitted = lm->submitted;
+  metrics->cancelled = lm->cancelled;
+  uv_mutex_unlock(&mutex);
+
+  metrics->running = metrics->submitted -
+                     metrics->queued -
+                     metrics->cancelled -
+                     metrics->completed;
+
+  return 0;
+}
+
+
 void uv__work_done(uv_async_t* handle) {
   struct uv__work* w;
   uv_loop_t* loop;
@@ -380,22 +988,218 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+  return uv_queue_work_ex(loop, req, UV_WORK_CPU, work_cb, after_work_cb);
+}
+
+
+int uv_queue_work_ex(uv_loop_t* loop,
+                     uv_work_t* req,
+                     uv_work_kind kind,
+                     uv_work_cb work_cb,
+                     uv_after_work_cb after_work_cb) {
   if (work_cb == NULL)
     return UV_EINVAL;
 
+  if ((unsigned int) kind >= UV_WORK_KIND_MAX)
+    return UV_EINVAL;
+
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
   uv__work_submit(loop,
                   &req->work_req,
-                  UV__WORK_CPU,
+                  (enum uv__work_kind) kind,
                   uv__queue_work,
                   uv__queue_done);
   return 0;
 }
 
 
+int uv_threadpool_set_limit(uv_work_kind kind, unsigned int limit) {
+  unsigned int i;
+
+  if ((unsigned int) kind >= UV_WORK_KIND_MAX)
+    return UV_EINVAL;
+
+  uv_once(&limit_once, init_limit_mutex);
+  uv_mutex_lock(&limit_mutex);
+  work_limit_set[kind] = 1;
+
+  if (!threads_running) {
+    work_limit[kind] = limit;
+    uv_mutex_unlock(&limit_mutex);
+    return 0;
+  }
+
+  uv_mutex_lock(&mutex);
+  work_limit[kind] = limit;
+
+  /* Work that was held back may be able to run now. */
+  for (i = 0; i < nthreads && work_available(); i++)
+    if (!wake_worker())
+      break;
+  uv_mutex_unlock(&mutex);
+  uv_mutex_unlock(&limit_mutex);
+
+  return 0;
+}
+
+
+int uv_threadpool_get_limit(uv_work_kind kind, unsigned int* limit) {
+  int cpumasksize;
+
+  if ((unsigned int) kind >= UV_WORK_KIND_MAX || limit == NULL)
+    return UV_EINVAL;
+
+  /* Like uv_threadpool_set_limit(), don't start the threads. */
+  uv_once(&limit_once, init_limit_mutex);
+  uv_mutex_lock(&limit_mutex);
+  *limit = work_limit[kind];
+  if (!threads_running &&
+      !work_limit_set[kind] &&
+      kind == (uv_work_kind) UV__WORK_SLOW_IO) {
+    *limit = slow_work_thread_threshold(threadpool_size(NULL, &cpumasksize));
+  }
+  uv_mutex_unlock(&limit_mutex);
+
+  return 0;
+}
+
+
+static void uv__work_bulk_work(struct uv__work* w) {
+  struct uv__work_bulk_lane* lane;
+  uv_work_bulk_t* req;
+  size_t start;
+  size_t end;
+
+  lane = container_of(w, struct uv__work_bulk_lane, work);
+  req = lane->req;
+
+  for (;;) {
+    start = uv__fetch_add_size_relaxed(&req->next_index, req->chunk_size);
+    if (start >= req->count)
+      break;
+
+    end = start + req->chunk_size;
+    if (end > req->count)
+      end = req->count;
+
+    req->work_cb(req, start, end);
+  }
+}
+
+
+static void uv__work_bulk_done(struct uv__work* w, int err) {
+  struct uv__work_bulk_lane* lane;
+  uv_work_bulk_t* req;
+
+  lane = container_of(w, struct uv__work_bulk_lane, work);
+  req = lane->req;
+
+  if (err == UV_ECANCELED)
+    req->cancelled_lanes++;
+
+  if (--req->pending_lanes > 0)
+    return;
+
+  uv__free(req->lanes);
+  req->lanes = NULL;
+  uv__req_unregister(req->loop);
+
+  /* Lanes that did run have processed every chunk. */
+  err = 0;
+  if (req->cancelled_lanes == req->nlanes)
+    err = UV_ECANCELED;
+
+  if (req->after_work_cb != NULL)
+    req->after_work_cb(req, err);
+}
+
+
+int uv_queue_work_bulk(uv_loop_t* loop,
+                       uv_work_bulk_t* req,
+                       size_t count,
+                       size_t chunk_size,
+                       uv_work_bulk_cb work_cb,
+                       uv_after_work_bulk_cb after_work_cb) {
+  struct uv__work_bulk_lane* lanes;
+  size_t nchunks;
+  unsigned int nlanes;
+  unsigned int i;
+
+  if (work_cb == NULL || count == 0)
+    return UV_EINVAL;
+
+  uv_once(&once, init_once);
+
+  /* Aim for several chunks per thread so threads that finish early can take
+   * over the remaining work of slower ones.
+   */
+  if (chunk_size == 0)
+    chunk_size = 1 + (count - 1) / (8 * (size_t) nthreads);
+
+  nchunks = 1 + (count - 1) / chunk_size;
+  nlanes = nthreads;
+  if (nlanes > nchunks)
+    nlanes = nchunks;
+
+  /* Each lane advances `next_index` past `count` at most once. */
+  if (chunk_size > (SIZE_MAX - count) / nlanes)
+    return UV_EINVAL;
+
+  lanes = uv__malloc(nlanes * sizeof(*lanes));
+  if (lanes == NULL)
+    return UV_ENOMEM;
+
+  uv__req_init(loop, req, UV_WORK_BULK);
+  req->loop = loop;
+  req->count = count;
+  req->chunk_size = chunk_size;
+  req->work_cb = work_cb;
+  req->after_work_cb = after_work_cb;
+  req->next_index = 0;
+  req->lanes = lanes;
+  req->nlanes = nlanes;
+  req->pending_lanes = nlanes;
+  req->cancelled_lanes = 0;
+
+  for (i = 0; i < nlanes; i++) {
+    lanes[i].req = req;
+    lanes[i].work.loop = loop;
+    lanes[i].work.work = uv__work_bulk_work;
+    lanes[i].work.done = uv__work_bulk_done;
+  }
+
+  post_bulk(lanes, nlanes, UV__WORK_CPU);
+  return 0;
+}
+
+
+static int uv__work_bulk_cancel(uv_work_bulk_t* req) {
+  struct uv__work_bulk_lane* lanes;
+  unsigned int cancelled;
+  unsigned int i;
+
+  if (req->lanes == NULL)
+    return UV_EBUSY;
+
+  /* Lanes that are already running process the remaining chunks, so the
+   * request as a whole is only cancelled when none of its lanes has started.
+   */
+  lanes = req->lanes;
+  cancelled = 0;
+  for (i = 0; i < req->nlanes; i++)
+    if (uv__work_cancel(req->loop, (uv_req_t*) req, &lanes[i].work) == 0)
+      cancelled++;
+
+  if (cancelled < req->nlanes)
+    return UV_EBUSY;
+
+  return 0;
+}
+
+
 int uv_cancel(uv_req_t* req) {
   struct uv__work* wreq;
   uv_loop_t* loop;
@@ -421,6 +1225,8 @@ int uv_cancel(uv_req_t* req) {
     loop =  ((uv_work_t*) req)->loop;
     wreq = &((uv_work_t*) req)->work_req;
     break;
+  case UV_WORK_BULK:
+    return uv__work_bulk_cancel((uv_work_bulk_t*) req);
   default:
     return UV_EINVAL;
   }
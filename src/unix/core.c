@@ -173,6 +173,12 @@ void uv_close(uv_handle_t* handle, uv_close_cb close_cb) {
 
   case UV_TCP:
     uv__tcp_close((uv_tcp_t*)handle);
+    /* The socket stays open until the kernel has released the buffers of
+     * the zero-copy writes. The stream code will call
+     * uv__make_close_pending() for us.
+     */
+    if (((uv_tcp_t*) handle)->io_watcher.fd != -1)
+      return;
     break;
 
   case UV_UDP:
@@ -404,6 +410,7 @@ static int uv__backend_timeout(const uv_loop_t* loop) {
       (uv__has_active_handles(loop) || uv__has_active_reqs(loop)) &&
       uv__queue_empty(&loop->pending_queue) &&
       uv__queue_empty(&loop->idle_handles) &&
+      uv__queue_empty(&uv__get_internal_fields(loop)->corked_streams) &&
       (loop->flags & UV_LOOP_REAP_CHILDREN) == 0 &&
       loop->closing_handles == NULL)
     return uv__next_timeout(loop);
@@ -471,6 +478,7 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
      */
     uv__metrics_update_idle_time(loop);
 
+    uv__stream_flush_corked(loop);
     uv__run_check(loop);
     uv__run_closing_handles(loop);
 
@@ -955,7 +963,8 @@ int uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
   assert(uv__io_cb_get(w) >= UV__AHAFS_EVENT);
   assert(uv__io_cb_get(w) <= UV__UDP_IO);
-  assert(0 == (events & ~(POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI)));
+  assert(0 == (events & ~(POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI |
+                          UV__POLLERR)));
   assert(0 != events);
   assert(w->fd >= 0);
   assert(w->fd < INT_MAX);
@@ -1003,7 +1012,8 @@ int uv__io_init_start(uv_loop_t* loop,
 
 
 void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
-  assert(0 == (events & ~(POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI)));
+  assert(0 == (events & ~(POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI |
+                          UV__POLLERR)));
   assert(0 != events);
 
   if (w->fd == -1)
@@ -1034,7 +1044,9 @@ void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
 
 void uv__io_close(uv_loop_t* loop, uv__io_t* w) {
-  uv__io_stop(loop, w, POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI);
+  uv__io_stop(loop,
+              w,
+              POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI | UV__POLLERR);
   uv__queue_remove(&w->pending_queue);
 
   /* Remove stale events for this file descriptor */
@@ -1050,7 +1062,8 @@ void uv__io_feed(uv_loop_t* loop, uv__io_t* w) {
 
 
 int uv__io_active(const uv__io_t* w, unsigned int events) {
-  assert(0 == (events & ~(POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI)));
+  assert(0 == (events & ~(POLLIN | POLLOUT | UV__POLLRDHUP | UV__POLLPRI |
+                          UV__POLLERR)));
   assert(0 != events);
   return 0 != (w->pevents & events);
 }
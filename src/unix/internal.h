@@ -156,6 +156,24 @@ union uv__sockaddr {
 # define UV__POLLPRI 0
 #endif
 
+/* Keeps a file descriptor registered for errors only, e.g. to wait for the
+ * socket's error queue. epoll reports EPOLLERR whether it's asked for or not
+ * and, unlike POLLPRI, the other events stay off.
+ */
+#if defined(__linux__)
+# define UV__POLLERR POLLERR
+#else
+# define UV__POLLERR 0
+#endif
+
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+# define UV__HAVE_ZEROCOPY 1
+# define UV__MSG_ZEROCOPY MSG_ZEROCOPY
+#else
+# define UV__HAVE_ZEROCOPY 0
+# define UV__MSG_ZEROCOPY 0
+#endif
+
 #if !defined(O_CLOEXEC) && defined(__FreeBSD__)
 /*
  * It may be that we are just missing `__POSIX_VISIBLE >= 200809`.
@@ -190,6 +208,34 @@ struct uv__stream_queued_fds_s {
   int fds[1];
 };
 
+/* Stream state that doesn't fit in uv_stream_t without changing its size.
+ * Allocated when one of the features is first used and reached through the
+ * handle's `u` union, which only the Windows port uses.
+ */
+typedef struct {
+  uv_stream_t* stream;
+  /* In the loop's list of corked streams that have data to flush. */
+  struct uv__queue cork_queue;
+  size_t cork_threshold;
+  uv_splice_t* splice_read_req;
+  uv_splice_t* splice_write_req;
+  size_t watermark_low;
+  size_t watermark_high;
+  uv_watermark_cb watermark_cb;
+  uv_read_v_cb read_v_cb;
+  void* framing;
+  /* Zero-copy writes waiting for their completion notification. */
+  struct uv__queue zerocopy_queue;
+  size_t zerocopy_threshold;
+  unsigned int zerocopy_sent;
+  unsigned int zerocopy_acked;
+  unsigned int zerocopy_released;
+  unsigned int notsent_lowat;
+} uv__stream_ext_t;
+
+#define uv__stream_ext(handle)                                                \
+  ((uv__stream_ext_t*) (handle)->u.reserved[0])
+
 #ifdef __linux__
 struct uv__statx_timestamp {
   int64_t tv_sec;
@@ -347,6 +393,8 @@ void uv__stream_init(uv_loop_t* loop, uv_stream_t* stream,
     uv_handle_type type);
 int uv__stream_open(uv_stream_t*, int fd, int flags);
 void uv__stream_destroy(uv_stream_t* stream);
+uv__stream_ext_t* uv__stream_ext_get(uv_stream_t* stream);
+void uv__stream_flush_corked(uv_loop_t* loop);
 #if defined(__APPLE__)
 int uv__stream_try_select(uv_stream_t* stream, int* fd);
 #endif /* defined(__APPLE__) */
@@ -359,6 +407,8 @@ int uv__slurp(const char* filename, char* buf, size_t len);
 /* tcp */
 int uv__tcp_listen(uv_tcp_t* tcp, int backlog, uv_connection_cb cb);
 int uv__tcp_nodelay(int fd, int on);
+int uv__tcp_zerocopy(int fd, int on);
+int uv__tcp_notsent_lowat(int fd, unsigned int bytes);
 int uv__tcp_keepalive(int fd,
                       int on,
                       unsigned int idle,
@@ -402,6 +452,7 @@ int uv__thread_getname(uv_thread_t* tid, char* name, size_t size);
 size_t uv__thread_stack_size(void);
 void uv__udp_close(uv_udp_t* handle);
 void uv__udp_finish_close(uv_udp_t* handle);
+void uv__udp_fork(uv_loop_t* loop);
 FILE* uv__open_file(const char* path);
 int uv__search_path(const char* prog, char* buf, size_t* buflen);
 void uv__wait_children(uv_loop_t* loop);
@@ -433,6 +484,38 @@ int uv__iou_fs_statx(uv_loop_t* loop,
                      int is_lstat);
 int uv__iou_fs_symlink(uv_loop_t* loop, uv_fs_t* req);
 int uv__iou_fs_unlink(uv_loop_t* loop, uv_fs_t* req);
+
+/* Buffers provided to the kernel for multishot UDP receives. The caller lays
+ * out the buffers `stride` bytes apart from `base`, each `size` bytes long,
+ * and the kernel writes `hdrlen` bytes of metadata in front of the payload.
+ */
+typedef struct {
+  uv_udp_t* handle;
+  void* ring;  /* struct uv__io_uring_buf[mask + 1], shared with the kernel */
+  size_t ringlen;
+  char* base;
+  size_t stride;
+  size_t size;
+  size_t hdrlen;
+  uint16_t mask;
+  uint16_t tail;
+  uint16_t bgid;
+  int armed;
+} uv__iou_pbuf_t;
+
+int uv__iou_udp_pbuf_init(uv_loop_t* loop,
+                          uv__iou_pbuf_t* pb,
+                          unsigned int nbufs,
+                          size_t controllen);
+void uv__iou_udp_pbuf_put(uv__iou_pbuf_t* pb, unsigned int bid);
+void uv__iou_udp_pbuf_destroy(uv_loop_t* loop, uv__iou_pbuf_t* pb);
+int uv__iou_udp_recvmsg(uv_loop_t* loop, int fd, uv__iou_pbuf_t* pb);
+void uv__iou_udp_cancel(uv_loop_t* loop, uv__iou_pbuf_t* pb);
+void uv__udp_recvmsg_cqe(uv_udp_t* handle,
+                         ssize_t nread,
+                         struct msghdr* h,
+                         unsigned int bid,
+                         int more);
 #else
 #define uv__iou_fs_close(loop, req) 0
 #define uv__iou_fs_ftruncate(loop, req) 0
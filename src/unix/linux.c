@@ -148,6 +148,7 @@ enum {
   UV__IORING_OP_READV = 1,
   UV__IORING_OP_WRITEV = 2,
   UV__IORING_OP_FSYNC = 3,
+  UV__IORING_OP_RECVMSG = 10,
   UV__IORING_OP_OPENAT = 18,
   UV__IORING_OP_CLOSE = 19,
   UV__IORING_OP_STATX = 21,
@@ -170,6 +171,25 @@ enum {
   UV__IORING_SQ_CQ_OVERFLOW = 2u,
 };
 
+enum {
+  UV__IOSQE_BUFFER_SELECT = 32u,
+};
+
+enum {
+  UV__IORING_RECV_MULTISHOT = 2u,  /* linux v6.0 */
+};
+
+enum {
+  UV__IORING_CQE_F_BUFFER = 1u,
+  UV__IORING_CQE_F_MORE = 2u,
+};
+
+enum {
+  UV__IORING_REGISTER_PBUF_RING = 22,  /* linux v5.19 */
+  UV__IORING_UNREGISTER_PBUF_RING = 23,
+  UV__IORING_REGISTER_SYNC_CANCEL = 24,  /* linux v6.0 */
+};
+
 struct uv__io_cqring_offsets {
   uint32_t head;
   uint32_t tail;
@@ -227,6 +247,7 @@ struct uv__io_uring_sqe {
   uint64_t user_data;
   union {
     uint16_t buf_index;
+    uint16_t buf_group;
     uint64_t pad[3];
   };
 };
@@ -259,6 +280,55 @@ STATIC_ASSERT(40 + 40 + 40 == sizeof(struct uv__io_uring_params));
 STATIC_ASSERT(40 == offsetof(struct uv__io_uring_params, sq_off));
 STATIC_ASSERT(80 == offsetof(struct uv__io_uring_params, cq_off));
 
+/* Entry of a provided buffer ring. The tail of the ring overlays the `resv`
+ * field of the first entry.
+ */
+struct uv__io_uring_buf {
+  uint64_t addr;
+  uint32_t len;
+  uint16_t bid;
+  uint16_t resv;
+};
+
+STATIC_ASSERT(16 == sizeof(struct uv__io_uring_buf));
+
+struct uv__io_uring_buf_reg {
+  uint64_t ring_addr;
+  uint32_t ring_entries;
+  uint16_t bgid;
+  uint16_t flags;
+  uint64_t resv[3];
+};
+
+STATIC_ASSERT(40 == sizeof(struct uv__io_uring_buf_reg));
+
+struct uv__io_uring_sync_cancel_reg {
+  uint64_t addr;
+  int32_t fd;
+  uint32_t flags;
+  int64_t timeout[2];  /* struct __kernel_timespec */
+  uint8_t opcode;
+  uint8_t pad[7];
+  uint64_t pad2[3];
+};
+
+STATIC_ASSERT(64 == sizeof(struct uv__io_uring_sync_cancel_reg));
+
+/* Written at the start of the buffer by a multishot IORING_OP_RECVMSG,
+ * followed by the peer address, the control messages and the payload.
+ */
+struct uv__io_uring_recvmsg_out {
+  uint32_t namelen;
+  uint32_t controllen;
+  uint32_t payloadlen;
+  uint32_t flags;
+};
+
+STATIC_ASSERT(16 == sizeof(struct uv__io_uring_recvmsg_out));
+
+/* Room for the peer address, padded to keep the control messages aligned. */
+#define UV__IOU_RECVMSG_NAMELEN (sizeof(struct sockaddr_in6) + 4)
+
 STATIC_ASSERT(EPOLL_CTL_ADD < 4);
 STATIC_ASSERT(EPOLL_CTL_DEL < 4);
 STATIC_ASSERT(EPOLL_CTL_MOD < 4);
@@ -461,6 +531,28 @@ int uv__io_uring_register(int fd, unsigned opcode, void* arg, unsigned nargs) {
 }
 
 
+/* Whether the UV_USE_IO_URING environment variable is a positive number.
+ * The rings that are off by default, the SQPOLL ring for file operations and
+ * the multishot UDP ring, need it.
+ */
+static int uv__io_uring_opted_in(void) {
+  /* Ternary: unknown=0, yes=1, no=-1 */
+  static _Atomic int use_io_uring;
+  char* val;
+  int use;
+
+  use = atomic_load_explicit(&use_io_uring, memory_order_relaxed);
+
+  if (use == 0) {
+    val = getenv("UV_USE_IO_URING");
+    use = val != NULL && atoi(val) > 0 ? 1 : -1;
+    atomic_store_explicit(&use_io_uring, use, memory_order_relaxed);
+  }
+
+  return use > 0;
+}
+
+
 static int uv__use_io_uring(uint32_t flags) {
 #if defined(__ANDROID_API__)
   return 0;  /* Possibly available but blocked by seccomp. */
@@ -471,11 +563,6 @@ static int uv__use_io_uring(uint32_t flags) {
   /* See https://github.com/libuv/libuv/issues/4283. */
   return 0; /* Random SIGSEGV in signal handler. */
 #else
-  /* Ternary: unknown=0, yes=1, no=-1 */
-  static _Atomic int use_io_uring;
-  char* val;
-  int use;
-
 #if defined(__hppa__)
   /* io_uring first supported on parisc in 6.1, functional in .51
    * https://lore.kernel.org/all/cb912694-b1fe-dbb0-4d8c-d608f3526905@gmx.de/
@@ -492,15 +579,7 @@ static int uv__use_io_uring(uint32_t flags) {
   if (uv__kernel_version() < /*5.10.186*/0x050ABA)
     return 0;
 
-  use = atomic_load_explicit(&use_io_uring, memory_order_relaxed);
-
-  if (use == 0) {
-    val = getenv("UV_USE_IO_URING");
-    use = val != NULL && atoi(val) > 0 ? 1 : -1;
-    atomic_store_explicit(&use_io_uring, use, memory_order_relaxed);
-  }
-
-  return use > 0;
+  return uv__io_uring_opted_in();
 #endif
 }
 
@@ -649,6 +728,7 @@ int uv__platform_loop_init(uv_loop_t* loop) {
   lfields = uv__get_internal_fields(loop);
   lfields->ctl.ringfd = -1;
   lfields->iou.ringfd = -2;  /* "uninitialized" */
+  lfields->udp.ringfd = -2;  /* "uninitialized" */
 
   loop->inotify_watchers = NULL;
   loop->inotify_fd = -1;
@@ -679,6 +759,9 @@ int uv__io_fork(uv_loop_t* loop) {
   if (err)
     return err;
 
+  /* The multishot UDP recvmsgs stayed with the parent, see uv__udp_fork(). */
+  uv__get_internal_fields(loop)->udp.in_flight = 0;
+
   return uv__inotify_fork(loop, root);
 }
 
@@ -689,6 +772,7 @@ void uv__platform_loop_delete(uv_loop_t* loop) {
   lfields = uv__get_internal_fields(loop);
   uv__iou_delete(&lfields->ctl);
   uv__iou_delete(&lfields->iou);
+  uv__iou_delete(&lfields->udp);
 
   if (loop->inotify_fd != -1) {
     uv__io_stop(loop, &loop->inotify_read_watcher, POLLIN);
@@ -1183,6 +1267,364 @@ static void uv__iou_fs_cleanup_fallback(uv_fs_t* req) {
 }
 
 
+/* Lazily creates the ring for multishot UDP receives. It doesn't use SQPOLL,
+ * submissions go to the kernel right away, and it's watched by epoll so that
+ * completions wake up the event loop. Off unless the UV_USE_IO_URING
+ * environment variable is a positive number, like the file operations ring.
+ */
+static struct uv__iou* uv__iou_udp_get(uv_loop_t* loop) {
+  struct epoll_event e;
+  struct uv__iou* iou;
+
+  iou = &uv__get_internal_fields(loop)->udp;
+
+  if (iou->ringfd == -2) {
+    /* Multishot IORING_OP_RECVMSG and IORING_REGISTER_SYNC_CANCEL. */
+    if (uv__io_uring_opted_in() &&
+        uv__kernel_version() >= /* 6.0.0 */ 0x060000) {
+      uv__iou_init(loop->backend_fd, iou, 256, 0);
+    }
+
+    if (iou->ringfd == -2) {
+      iou->ringfd = -1;  /* "failed" */
+    } else {
+      memset(&e, 0, sizeof(e));
+      e.events = POLLIN;
+      e.data.fd = iou->ringfd;
+
+      if (epoll_ctl(loop->backend_fd, EPOLL_CTL_ADD, iou->ringfd, &e))
+        uv__iou_delete(iou);
+    }
+  }
+
+  if (iou->ringfd == -1)
+    return NULL;
+
+  return iou;
+}
+
+
+int uv__iou_udp_pbuf_init(uv_loop_t* loop,
+                          uv__iou_pbuf_t* pb,
+                          unsigned int nbufs,
+                          size_t controllen) {
+  struct uv__io_uring_buf_reg reg;
+  uv__loop_internal_fields_t* lfields;
+  struct uv__iou* iou;
+  unsigned int entries;
+  size_t ringlen;
+  void* ring;
+
+  memset(pb, 0, sizeof(*pb));
+
+  /* Buffer ids are 16 bits and the ring size must be a power of two. */
+  if (nbufs == 0 || nbufs > 32768)
+    return UV_EINVAL;
+
+  iou = uv__iou_udp_get(loop);
+  if (iou == NULL)
+    return UV_ENOSYS;
+
+  for (entries = 1; entries < nbufs; entries *= 2);
+
+  ringlen = entries * sizeof(struct uv__io_uring_buf);
+  ring = mmap(NULL,
+              ringlen,
+              PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+              -1,
+              0);
+
+  if (ring == MAP_FAILED)
+    return UV__ERR(errno);
+
+  lfields = uv__get_internal_fields(loop);
+
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = (uintptr_t) ring;
+  reg.ring_entries = entries;
+  reg.bgid = ++lfields->udp_bgid;
+
+  if (uv__io_uring_register(iou->ringfd,
+                            UV__IORING_REGISTER_PBUF_RING,
+                            &reg,
+                            1)) {
+    munmap(ring, ringlen);
+    return UV_ENOSYS;
+  }
+
+  pb->ring = ring;
+  pb->ringlen = ringlen;
+  pb->mask = entries - 1;
+  pb->bgid = reg.bgid;
+  pb->hdrlen = sizeof(struct uv__io_uring_recvmsg_out) +
+               UV__IOU_RECVMSG_NAMELEN +
+               controllen;
+
+  return 0;
+}
+
+
+void uv__iou_udp_pbuf_put(uv__iou_pbuf_t* pb, unsigned int bid) {
+  struct uv__io_uring_buf* bufs;
+  struct uv__io_uring_buf* b;
+
+  /* Don't touch `resv`, it's the tail of the ring in the first entry. */
+  bufs = pb->ring;
+  b = &bufs[pb->tail & pb->mask];
+  b->addr = (uintptr_t) (pb->base + bid * pb->stride);
+  b->len = pb->size;
+  b->bid = bid;
+
+  pb->tail++;
+  atomic_store_explicit((_Atomic uint16_t*) &bufs[0].resv,
+                        pb->tail,
+                        memory_order_release);
+}
+
+
+void uv__iou_udp_pbuf_destroy(uv_loop_t* loop, uv__iou_pbuf_t* pb) {
+  struct uv__io_uring_buf_reg reg;
+  struct uv__iou* iou;
+
+  if (pb->ring == NULL)
+    return;
+
+  assert(!pb->armed);
+  iou = &uv__get_internal_fields(loop)->udp;
+
+  /* Fails harmlessly when the ring went away, e.g. in uv_loop_fork(). */
+  memset(&reg, 0, sizeof(reg));
+  reg.bgid = pb->bgid;
+  if (iou->ringfd > -1)
+    uv__io_uring_register(iou->ringfd,
+                          UV__IORING_UNREGISTER_PBUF_RING,
+                          &reg,
+                          1);
+
+  munmap(pb->ring, pb->ringlen);
+  pb->ring = NULL;
+}
+
+
+/* Arms a multishot recvmsg that picks its buffers from `pb` and keeps posting
+ * completions until it runs out of them, fails or gets cancelled.
+ */
+int uv__iou_udp_recvmsg(uv_loop_t* loop, int fd, uv__iou_pbuf_t* pb) {
+  struct uv__io_uring_sqe* sqe;
+  struct uv__iou* iou;
+  struct msghdr msg;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t mask;
+  int rc;
+
+  assert(!pb->armed);
+  iou = &uv__get_internal_fields(loop)->udp;
+  if (iou->ringfd < 0)
+    return UV_ENOSYS;
+
+  head = atomic_load_explicit((_Atomic uint32_t*) iou->sqhead,
+                              memory_order_acquire);
+  tail = *iou->sqtail;
+  mask = iou->sqmask;
+
+  if ((head & mask) == ((tail + 1) & mask))
+    return UV_EBUSY;
+
+  /* Only the lengths matter, they size the regions in front of the payload.
+   * The kernel copies the msghdr when the sqe is submitted.
+   */
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_namelen = UV__IOU_RECVMSG_NAMELEN;
+  msg.msg_controllen = pb->hdrlen - UV__IOU_RECVMSG_NAMELEN -
+                       sizeof(struct uv__io_uring_recvmsg_out);
+
+  sqe = iou->sqe;
+  sqe = &sqe[tail & mask];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = UV__IORING_OP_RECVMSG;
+  sqe->fd = fd;
+  sqe->addr = (uintptr_t) &msg;
+  sqe->len = 1;
+  sqe->ioprio = UV__IORING_RECV_MULTISHOT;
+  sqe->flags = UV__IOSQE_BUFFER_SELECT;
+  sqe->buf_group = pb->bgid;
+  sqe->user_data = (uintptr_t) pb;
+
+  atomic_store_explicit((_Atomic uint32_t*) iou->sqtail,
+                        tail + 1,
+                        memory_order_release);
+
+  do
+    rc = uv__io_uring_enter(iou->ringfd, 1, 0, 0);
+  while (rc == -1 && errno == EINTR);
+
+  if (rc != 1) {
+    /* Not consumed, take it back. */
+    *iou->sqtail = tail;
+    return rc == -1 ? UV__ERR(errno) : UV_EBUSY;
+  }
+
+  pb->armed = 1;
+  iou->in_flight++;
+
+  return 0;
+}
+
+
+/* Stops the multishot recvmsg of `pb`. Cancellation is synchronous, so
+ * once this returns the kernel no longer touches the buffers. Completions
+ * it already posted are dropped and their buffers go back to the kernel.
+ */
+void uv__iou_udp_cancel(uv_loop_t* loop, uv__iou_pbuf_t* pb) {
+  struct uv__io_uring_sync_cancel_reg reg;
+  struct uv__io_uring_cqe* cqe;
+  struct uv__io_uring_cqe* e;
+  struct uv__iou* iou;
+  uint32_t flags;
+  uint32_t tail;
+  uint32_t i;
+  int rc;
+
+  if (!pb->armed)
+    return;
+
+  iou = &uv__get_internal_fields(loop)->udp;
+  pb->armed = 0;
+  iou->in_flight--;
+
+  memset(&reg, 0, sizeof(reg));
+  reg.addr = (uintptr_t) pb;
+  reg.fd = -1;
+  reg.timeout[0] = -1;
+  reg.timeout[1] = -1;
+
+  do
+    rc = uv__io_uring_register(iou->ringfd,
+                               UV__IORING_REGISTER_SYNC_CANCEL,
+                               &reg,
+                               1);
+  while (rc == -1 && errno == EINTR);
+
+  /* Get overflowed completions into the ring so they can be scrubbed. */
+  flags = atomic_load_explicit((_Atomic uint32_t*) iou->sqflags,
+                               memory_order_acquire);
+
+  if (flags & UV__IORING_SQ_CQ_OVERFLOW)
+    uv__io_uring_enter(iou->ringfd, 0, 0, UV__IORING_ENTER_GETEVENTS);
+
+  tail = atomic_load_explicit((_Atomic uint32_t*) iou->cqtail,
+                              memory_order_acquire);
+  cqe = iou->cqe;
+
+  for (i = *iou->cqhead; i != tail; i++) {
+    e = &cqe[i & iou->cqmask];
+
+    if (e->user_data != (uintptr_t) pb)
+      continue;
+
+    if (e->flags & UV__IORING_CQE_F_BUFFER)
+      uv__iou_udp_pbuf_put(pb, e->flags >> 16);
+
+    e->user_data = 0;  /* Skipped by uv__poll_io_uring_udp(). */
+  }
+}
+
+
+static void uv__poll_io_uring_udp(uv_loop_t* loop, struct uv__iou* iou) {
+  struct uv__io_uring_recvmsg_out* out;
+  struct uv__io_uring_cqe* cqe;
+  struct uv__io_uring_cqe* e;
+  uv__iou_pbuf_t* pb;
+  struct msghdr h;
+  struct iovec iov;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t mask;
+  uint32_t i;
+  uint32_t flags;
+  unsigned int bid;
+  char* base;
+  int nevents;
+  int more;
+  int res;
+
+  head = *iou->cqhead;
+  tail = atomic_load_explicit((_Atomic uint32_t*) iou->cqtail,
+                              memory_order_acquire);
+  mask = iou->cqmask;
+  cqe = iou->cqe;
+  nevents = 0;
+
+  for (i = head; i != tail; i++) {
+    e = &cqe[i & mask];
+    pb = (uv__iou_pbuf_t*) (uintptr_t) e->user_data;
+    res = e->res;
+    flags = e->flags;
+
+    /* Consume the completion before calling out, recv_cb may stop or close
+     * the handle and uv__iou_udp_cancel() must not see it again.
+     */
+    atomic_store_explicit((_Atomic uint32_t*) iou->cqhead,
+                          i + 1,
+                          memory_order_release);
+
+    if (pb == NULL)
+      continue;  /* Scrubbed by uv__iou_udp_cancel(). */
+
+    more = !!(flags & UV__IORING_CQE_F_MORE);
+    if (!more) {
+      pb->armed = 0;
+      iou->in_flight--;
+    }
+
+    uv__metrics_update_idle_time(loop);
+    nevents++;
+
+    if (res < 0 || !(flags & UV__IORING_CQE_F_BUFFER)) {
+      uv__udp_recvmsg_cqe(pb->handle, res < 0 ? res : 0, NULL, 0, more);
+      continue;
+    }
+
+    bid = flags >> 16;
+    base = pb->base + bid * pb->stride;
+    out = (struct uv__io_uring_recvmsg_out*) base;
+
+    iov.iov_base = base + pb->hdrlen;
+    iov.iov_len = pb->size - pb->hdrlen;
+
+    memset(&h, 0, sizeof(h));
+    h.msg_name = out->namelen > 0 ? base + sizeof(*out) : NULL;
+    h.msg_namelen = out->namelen;
+    h.msg_iov = &iov;
+    h.msg_iovlen = 1;
+    h.msg_control = base + sizeof(*out) + UV__IOU_RECVMSG_NAMELEN;
+    h.msg_controllen = out->controllen;
+    h.msg_flags = out->flags;
+
+    uv__udp_recvmsg_cqe(pb->handle,
+                        (ssize_t) res - (ssize_t) pb->hdrlen,
+                        &h,
+                        bid,
+                        more);
+  }
+
+  /* Same as uv__poll_io_uring(), flush overflowed completions for the next
+   * loop iteration.
+   */
+  flags = atomic_load_explicit((_Atomic uint32_t*) iou->sqflags,
+                               memory_order_acquire);
+
+  if (flags & UV__IORING_SQ_CQ_OVERFLOW)
+    uv__io_uring_enter(iou->ringfd, 0, 0, UV__IORING_ENTER_GETEVENTS);
+
+  uv__metrics_inc_events(loop, nevents);
+  if (uv__get_internal_fields(loop)->current_timeout == 0)
+    uv__metrics_inc_events_waiting(loop, nevents);
+}
+
+
 static void uv__poll_io_uring(uv_loop_t* loop, struct uv__iou* iou) {
   struct uv__io_uring_cqe* cqe;
   struct uv__io_uring_cqe* e;
@@ -1378,6 +1820,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   struct epoll_event e;
   struct uv__iou* ctl;
   struct uv__iou* iou;
+  struct uv__iou* udp;
   int real_timeout;
   struct uv__queue* q;
   uv__io_t* w;
@@ -1399,6 +1842,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   lfields = uv__get_internal_fields(loop);
   ctl = &lfields->ctl;
   iou = &lfields->iou;
+  udp = &lfields->udp;
 
   sigmask = NULL;
   if (loop->flags & UV_LOOP_BLOCK_SIGPROF) {
@@ -1462,7 +1906,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
 
   for (;;) {
     if (loop->nfds == 0)
-      if (iou->in_flight == 0)
+      if (iou->in_flight == 0 && udp->in_flight == 0)
         break;
 
     /* All event mask mutations should be visible to the kernel before
@@ -1515,6 +1959,12 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
         continue;
       }
 
+      if (fd == udp->ringfd) {
+        uv__poll_io_uring_udp(loop, udp);
+        have_iou_events = 1;
+        continue;
+      }
+
       assert(fd >= 0);
       assert((unsigned) fd < loop->nwatchers);
 
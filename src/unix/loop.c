@@ -49,6 +49,7 @@ int uv_loop_init(uv_loop_t* loop) {
          sizeof(lfields->loop_metrics.metrics));
 
   heap_init((struct heap*) &loop->timer_heap);
+  uv__queue_init(&lfields->corked_streams);
   uv__queue_init(&loop->wq);
   uv__queue_init(&loop->idle_handles);
   uv__queue_init(&loop->async_handles);
@@ -149,6 +150,8 @@ int uv_loop_fork(uv_loop_t* loop) {
   if (err)
     return err;
 
+  uv__udp_fork(loop);
+
   /* Rearm all the watchers that aren't re-queued by the above. */
   for (i = 0; i < loop->nwatchers; i++) {
     w = loop->watchers[i];
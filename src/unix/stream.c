@@ -35,6 +35,15 @@
 #include <unistd.h>
 #include <limits.h> /* IOV_MAX */
 
+#if defined(__linux__)
+# include <fcntl.h>
+# include <sys/sendfile.h>
+#endif
+
+#if UV__HAVE_ZEROCOPY
+# include <linux/errqueue.h>
+#endif
+
 #if defined(__APPLE__)
 # include <sys/event.h>
 # include <sys/time.h>
@@ -70,12 +79,53 @@ union uv__cmsg {
 
 STATIC_ASSERT(256 == sizeof(union uv__cmsg));
 
+/* State of uv_stream_set_framing(). Frames are read into buf and handed to
+ * read_cb straight from there, partial frames stay behind until the rest
+ * arrives.
+ */
+typedef struct {
+  uv_stream_framing_t opts;
+  char* buf;
+  size_t size;
+  size_t len;
+  size_t need;     /* Bytes still missing from the next frame. */
+  size_t scanned;  /* Bytes of the next frame searched for the delimiter. */
+  int lowat;       /* Current SO_RCVLOWAT. */
+} uv__stream_framing_t;
+
+/* Private state of a uv_write_t, kept in the reserved fields of the request
+ * so that UV_WRITE_PRIVATE_FIELDS doesn't change size. Those are only as
+ * aligned as a pointer, hence the byte array for the 64-bit offset.
+ */
+typedef struct {
+  unsigned int flags;
+  unsigned int zerocopy_id;
+  int sendfile_fd;
+  char sendfile_offset[sizeof(int64_t)];
+} uv__write_ext_t;
+
+STATIC_ASSERT(sizeof(uv__write_ext_t) <= sizeof(((uv_req_t*) 0)->reserved));
+
+#define uv__write_ext(req) ((uv__write_ext_t*) (req)->reserved)
+
+enum {
+  UV__WRITE_ZEROCOPY = 1,  /* Sent with MSG_ZEROCOPY. */
+  UV__WRITE_NOCOPY = 2     /* From uv_write_nocopy(), bufs is the user's. */
+};
+
 static void uv__stream_connect(uv_stream_t*);
 static void uv__write(uv_stream_t* stream);
 static void uv__read(uv_stream_t* stream);
 static void uv__write_callbacks(uv_stream_t* stream);
 static size_t uv__write_req_size(uv_write_t* req);
 static void uv__drain(uv_stream_t* stream);
+static void uv__stream_watermarks(uv_stream_t* stream);
+static void uv__stream_close_fd(uv_stream_t* handle);
+static int uv__read_frames(uv_stream_t* stream);
+#if defined(__linux__)
+static void uv__stream_splice_run(uv_splice_t* req);
+static void uv__stream_splice_detach(uv_splice_t* req);
+#endif
 
 
 void uv__stream_init(uv_loop_t* loop,
@@ -96,6 +146,7 @@ void uv__stream_init(uv_loop_t* loop,
   uv__queue_init(&stream->write_queue);
   uv__queue_init(&stream->write_completed_queue);
   stream->write_queue_size = 0;
+  stream->u.reserved[0] = NULL;  /* See uv__stream_ext_get(). */
 
   if (loop->emfile_fd == -1) {
     err = uv__open_cloexec("/dev/null", O_RDONLY);
@@ -116,6 +167,83 @@ void uv__stream_init(uv_loop_t* loop,
 }
 
 
+/* Returns the stream's uv__stream_ext_t, allocating it if the stream doesn't
+ * have one yet. Freed by uv__stream_destroy().
+ */
+uv__stream_ext_t* uv__stream_ext_get(uv_stream_t* stream) {
+  uv__stream_ext_t* ext;
+
+  ext = uv__stream_ext(stream);
+  if (ext != NULL)
+    return ext;
+
+  ext = uv__calloc(1, sizeof(*ext));
+  if (ext == NULL)
+    return NULL;
+
+  ext->stream = stream;
+  uv__queue_init(&ext->cork_queue);
+  uv__queue_init(&ext->zerocopy_queue);
+  stream->u.reserved[0] = ext;
+
+  return ext;
+}
+
+
+/* Writes the data that corked streams queued up during this loop iteration.
+ * Runs right before the check handles, after the I/O callbacks.
+ */
+void uv__stream_flush_corked(uv_loop_t* loop) {
+  uv__stream_ext_t* ext;
+  struct uv__queue* q;
+  struct uv__queue queue;
+
+  uv__queue_move(&uv__get_internal_fields(loop)->corked_streams, &queue);
+
+  while (!uv__queue_empty(&queue)) {
+    q = uv__queue_head(&queue);
+    uv__queue_remove(q);
+    uv__queue_init(q);
+
+    ext = uv__queue_data(q, uv__stream_ext_t, cork_queue);
+    uv__stream_io(loop, &ext->stream->io_watcher, POLLOUT);
+  }
+}
+
+
+static uv__stream_framing_t* uv__stream_framing(const uv_stream_t* stream) {
+  uv__stream_ext_t* ext;
+
+  ext = uv__stream_ext(stream);
+  return ext != NULL ? ext->framing : NULL;
+}
+
+
+static uv_splice_t* uv__stream_splice_read_req(const uv_stream_t* stream) {
+  uv__stream_ext_t* ext;
+
+  ext = uv__stream_ext(stream);
+  return ext != NULL ? ext->splice_read_req : NULL;
+}
+
+
+static uv_splice_t* uv__stream_splice_write_req(const uv_stream_t* stream) {
+  uv__stream_ext_t* ext;
+
+  ext = uv__stream_ext(stream);
+  return ext != NULL ? ext->splice_write_req : NULL;
+}
+
+
+/* Returns 1 if zero-copy writes are waiting for their notification. */
+static int uv__stream_zerocopy_pending(const uv_stream_t* stream) {
+  uv__stream_ext_t* ext;
+
+  ext = uv__stream_ext(stream);
+  return ext != NULL && !uv__queue_empty(&ext->zerocopy_queue);
+}
+
+
 static void uv__stream_osx_interrupt_select(uv_stream_t* stream) {
 #if defined(__APPLE__)
   /* Notify select() thread about state change */
@@ -400,6 +528,8 @@ failed_malloc:
 
 
 int uv__stream_open(uv_stream_t* stream, int fd, int flags) {
+  uv__stream_ext_t* ext;
+  int err;
 #if defined(__APPLE__)
   int enable;
 #endif
@@ -419,6 +549,16 @@ int uv__stream_open(uv_stream_t* stream, int fd, int flags) {
         uv__tcp_keepalive(fd, 1, 60, 1, 10)) {
       return UV__ERR(errno);
     }
+
+    if ((stream->flags & UV_HANDLE_TCP_ZEROCOPY) && uv__tcp_zerocopy(fd, 1))
+      return UV__ERR(errno);
+
+    ext = uv__stream_ext(stream);
+    if (ext != NULL && ext->notsent_lowat != 0) {
+      err = uv__tcp_notsent_lowat(fd, ext->notsent_lowat);
+      if (err)
+        return err;
+    }
   }
 
 #if defined(__APPLE__)
@@ -452,20 +592,51 @@ void uv__stream_flush_write_queue(uv_stream_t* stream, int error) {
 
 
 void uv__stream_destroy(uv_stream_t* stream) {
+  uv__stream_ext_t* ext;
+  uv_splice_t* splice_req;
+
   assert(!uv__io_active(&stream->io_watcher, POLLIN | POLLOUT));
   assert(stream->flags & UV_HANDLE_CLOSED);
 
+  ext = uv__stream_ext(stream);
+
   if (stream->connect_req) {
     uv__req_unregister(stream->loop);
     stream->connect_req->cb(stream->connect_req, UV_ECANCELED);
     stream->connect_req = NULL;
   }
 
+  /* uv__stream_close() detached the splices but left them for us to cancel. */
+  if (ext != NULL && ext->splice_read_req != NULL) {
+    splice_req = ext->splice_read_req;
+    ext->splice_read_req = NULL;
+    uv__req_unregister(stream->loop);
+    splice_req->cb(splice_req, UV_ECANCELED);
+  }
+
+  if (ext != NULL && ext->splice_write_req != NULL) {
+    splice_req = ext->splice_write_req;
+    ext->splice_write_req = NULL;
+    uv__req_unregister(stream->loop);
+    splice_req->cb(splice_req, UV_ECANCELED);
+  }
+
+  /* uv__stream_close() waited for the zero-copy writes. */
+  assert(!uv__stream_zerocopy_pending(stream));
+
   uv__stream_flush_write_queue(stream, UV_ECANCELED);
   uv__write_callbacks(stream);
   uv__drain(stream);
 
   assert(stream->write_queue_size == 0);
+
+  if (ext != NULL) {
+    if (ext->framing != NULL)
+      uv__free(((uv__stream_framing_t*) ext->framing)->buf);
+    uv__free(ext->framing);
+    uv__free(ext);
+    stream->u.reserved[0] = NULL;
+  }
 }
 
 
@@ -633,6 +804,10 @@ static void uv__drain(uv_stream_t* stream) {
   if (!uv__is_stream_shutting(stream))
     return;
 
+  /* Shut down once the zero-copy writes have completed. */
+  if (uv__stream_zerocopy_pending(stream))
+    return;
+
   req = stream->shutdown_req;
   assert(req);
 
@@ -695,7 +870,7 @@ static int uv__write_req_update(uv_stream_t* stream,
 
   do {
     len = n < buf->len ? n : buf->len;
-    if (buf->len != 0)
+    if (buf->base != NULL)  /* NULL for uv_stream_sendfile() requests. */
       buf->base += len;
     buf->len -= len;
     buf += (buf->len == 0);  /* Advance to next buffer if this one is empty. */
@@ -710,6 +885,7 @@ static int uv__write_req_update(uv_stream_t* stream,
 
 static void uv__write_req_finish(uv_write_t* req) {
   uv_stream_t* stream = req->handle;
+  uv__stream_ext_t* ext;
 
   /* Pop the req off tcp->write_queue. */
   uv__queue_remove(&req->queue);
@@ -721,11 +897,28 @@ static void uv__write_req_finish(uv_write_t* req) {
    * to revisit in future revisions of the libuv API.
    */
   if (req->error == 0) {
-    if (req->bufs != req->bufsml)
+    if (req->bufs != req->bufsml &&
+        !(uv__write_ext(req)->flags & UV__WRITE_NOCOPY)) {
       uv__free(req->bufs);
+    }
     req->bufs = NULL;
   }
 
+  /* The kernel may still be reading from the buffers of a zero-copy write,
+   * even one that failed part way. Park the request until the completion
+   * notification arrives. Requests that finish after it are parked too,
+   * failed or not, so callbacks run in write order.
+   */
+  ext = uv__stream_ext(stream);
+  if (ext != NULL) {
+    if ((uv__write_ext(req)->flags & UV__WRITE_ZEROCOPY) ||
+        !uv__queue_empty(&ext->zerocopy_queue)) {
+      uv__queue_insert_tail(&ext->zerocopy_queue, &req->queue);
+      uv__io_start(stream->loop, &stream->io_watcher, UV__POLLERR);
+      return;
+    }
+  }
+
   /* Add it to the write_completed_queue where it will have its
    * callback called in the near future.
    */
@@ -734,6 +927,83 @@ static void uv__write_req_finish(uv_write_t* req) {
 }
 
 
+#if UV__HAVE_ZEROCOPY
+/* Reads the completion notifications of zero-copy writes from the socket's
+ * error queue. Each successful MSG_ZEROCOPY send is numbered by the kernel
+ * and notifications report inclusive ranges of those numbers.
+ */
+static void uv__stream_zerocopy_reap(uv_stream_t* stream) {
+  struct sock_extended_err* serr;
+  uv__stream_ext_t* ext;
+  struct cmsghdr* cmsg;
+  struct uv__queue* q;
+  struct msghdr msg;
+  union uv__cmsg control;
+  uv_write_t* req;
+  ssize_t n;
+
+  ext = uv__stream_ext(stream);
+
+  for (;;) {
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = &control.hdr;
+    msg.msg_controllen = sizeof(control);
+
+    do
+      n = recvmsg(uv__stream_fd(stream), &msg, MSG_ERRQUEUE);
+    while (n == -1 && errno == EINTR);
+
+    if (n == -1)
+      break;
+
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
+        continue;
+
+      serr = (struct sock_extended_err*) CMSG_DATA(cmsg);
+      if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+        continue;
+
+      ext->zerocopy_released += serr->ee_data - serr->ee_info + 1;
+      if (serr->ee_info == ext->zerocopy_acked)
+        ext->zerocopy_acked = serr->ee_data + 1;
+
+      /* The kernel had to copy the data after all, for example because the
+       * device can't scatter-gather or the peer is local. Stop paying for
+       * the notifications.
+       */
+      if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+        stream->flags |= UV_HANDLE_TCP_ZEROCOPY_COPIED;
+    }
+  }
+
+  /* Ranges are normally reported in order. If one wasn't, wait until
+   * everything has been released.
+   */
+  if (ext->zerocopy_released == ext->zerocopy_sent)
+    ext->zerocopy_acked = ext->zerocopy_sent;
+
+  while (!uv__queue_empty(&ext->zerocopy_queue)) {
+    q = uv__queue_head(&ext->zerocopy_queue);
+    req = uv__queue_data(q, uv_write_t, queue);
+
+    /* Serial number arithmetic, the counter wraps around. */
+    if ((uv__write_ext(req)->flags & UV__WRITE_ZEROCOPY) &&
+        (int) (ext->zerocopy_acked - uv__write_ext(req)->zerocopy_id) <= 0) {
+      break;
+    }
+
+    uv__queue_remove(q);
+    uv__queue_insert_tail(&stream->write_completed_queue, q);
+  }
+
+  if (uv__queue_empty(&ext->zerocopy_queue))
+    uv__io_stop(stream->loop, &stream->io_watcher, UV__POLLERR);
+}
+#endif  /* UV__HAVE_ZEROCOPY */
+
+
 static int uv__handle_fd(uv_handle_t* handle) {
   switch (handle->type) {
     case UV_NAMED_PIPE:
@@ -751,7 +1021,8 @@ static int uv__handle_fd(uv_handle_t* handle) {
 static int uv__try_write(uv_stream_t* stream,
                          const uv_buf_t bufs[],
                          unsigned int nbufs,
-                         uv_stream_t* send_handle) {
+                         uv_stream_t* send_handle,
+                         int flags) {
   struct iovec* iov;
   int iovmax;
   int iovcnt;
@@ -805,6 +1076,16 @@ static int uv__try_write(uv_stream_t* stream,
     do
       n = sendmsg(uv__stream_fd(stream), &msg, 0);
     while (n == -1 && errno == EINTR);
+  } else if (flags != 0) {
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    do
+      n = sendmsg(uv__stream_fd(stream), &msg, flags);
+    while (n == -1 && errno == EINTR);
   } else {
     do
       n = uv__writev(uv__stream_fd(stream), iov, iovcnt);
@@ -814,6 +1095,12 @@ static int uv__try_write(uv_stream_t* stream,
   if (n >= 0)
     return n;
 
+  /* Pending zero-copy notifications are charged against the socket's option
+   * memory. ENOBUFS means that is used up; the caller can copy instead.
+   */
+  if (errno == ENOBUFS && (flags & UV__MSG_ZEROCOPY))
+    return UV_ENOBUFS;
+
   if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
     return UV_EAGAIN;
 
@@ -834,11 +1121,153 @@ static int uv__try_write(uv_stream_t* stream,
   return UV__ERR(errno);
 }
 
+/* Returns MSG_ZEROCOPY if the rest of the request is large enough to be
+ * worth sending with zero-copy, or 0 otherwise.
+ */
+static int uv__write_zerocopy_flags(uv_stream_t* stream, uv_write_t* req) {
+  if (stream->type != UV_TCP)
+    return 0;
+
+  if ((stream->flags & (UV_HANDLE_TCP_ZEROCOPY |
+                        UV_HANDLE_TCP_ZEROCOPY_COPIED)) !=
+      UV_HANDLE_TCP_ZEROCOPY)
+    return 0;
+
+  /* uv_tcp_zerocopy() allocated the ext before setting the flag. */
+  if (uv__write_req_size(req) < uv__stream_ext(stream)->zerocopy_threshold)
+    return 0;
+
+  return UV__MSG_ZEROCOPY;
+}
+
+
+/* Sends the rest of a uv_stream_sendfile() request. The length that is left
+ * is kept in bufs[0].len, like uv_fs_sendfile() does. Returns the number of
+ * bytes sent or an error code.
+ */
+static ssize_t uv__write_sendfile(uv_stream_t* stream, uv_write_t* req) {
+#if defined(__linux__)
+  uv__write_ext_t* wext;
+  int64_t offset;
+  ssize_t n;
+  off_t off;
+
+  if (req->bufs[0].len == 0)
+    return 0;
+
+  wext = uv__write_ext(req);
+  memcpy(&offset, wext->sendfile_offset, sizeof(offset));
+  off = offset;
+
+  do
+    n = sendfile(uv__stream_fd(stream), wext->sendfile_fd, &off,
+                 req->bufs[0].len);
+  while (n == -1 && errno == EINTR);
+
+  /* The file is shorter than the caller said it would be. */
+  if (n == 0)
+    return UV_EOF;
+
+  if (n > 0) {
+    offset += n;
+    memcpy(wext->sendfile_offset, &offset, sizeof(offset));
+    return n;
+  }
+
+  if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+    return UV_EAGAIN;
+
+  return UV__ERR(errno);
+#else
+  return UV_ENOTSUP;  /* Not reached, uv_stream_sendfile() refuses. */
+#endif
+}
+
+
+/* Writes the requests at the head of the write queue with a single writev().
+ * Requests that pass a handle, that send a file or that are sent with
+ * zero-copy end the batch.
+ * Returns the number of bytes written or an error code, or 0 without writing
+ * anything when fewer than two requests can be batched. The number of
+ * requests in the batch is stored in `nreqs`.
+ */
+static ssize_t uv__write_gather(uv_stream_t* stream, unsigned int* nreqs) {
+  uv_buf_t bufs[64];
+  struct uv__queue* q;
+  uv_write_t* req;
+  unsigned int nbufs;
+  unsigned int n;
+  int flags;
+
+  *nreqs = 0;
+  nbufs = 0;
+  flags = 0;
+
+  uv__queue_foreach(q, &stream->write_queue) {
+    req = uv__queue_data(q, uv_write_t, queue);
+    n = req->nbufs - req->write_index;
+
+    if (req->send_handle != NULL ||
+        uv__write_ext(req)->sendfile_fd != -1 ||
+        uv__write_zerocopy_flags(stream, req) != 0 ||
+        nbufs + n > ARRAY_SIZE(bufs)) {
+#ifdef MSG_MORE
+      /* More data follows right away, don't push out a partial segment. */
+      if (stream->type == UV_TCP)
+        flags = MSG_MORE;
+#endif
+      break;
+    }
+
+    memcpy(bufs + nbufs, req->bufs + req->write_index, n * sizeof(bufs[0]));
+    nbufs += n;
+    *nreqs += 1;
+  }
+
+  if (*nreqs < 2)
+    return 0;
+
+  return uv__try_write(stream, bufs, nbufs, NULL, flags);
+}
+
+
+/* Hands the `n` bytes written by uv__write_gather() out to the requests in
+ * the batch. Returns 1 if all of them have been written completely.
+ */
+static int uv__write_gather_update(uv_stream_t* stream,
+                                   size_t n,
+                                   unsigned int nreqs) {
+  struct uv__queue* q;
+  uv_write_t* req;
+  size_t len;
+
+  while (nreqs-- > 0) {
+    q = uv__queue_head(&stream->write_queue);
+    req = uv__queue_data(q, uv_write_t, queue);
+
+    len = uv__write_req_size(req);
+    if (len > n)
+      len = n;
+    n -= len;
+
+    if (!uv__write_req_update(stream, req, len))
+      return 0;
+
+    uv__write_req_finish(req);
+  }
+
+  return 1;
+}
+
+
 static void uv__write(uv_stream_t* stream) {
+  uv__write_ext_t* wext;
   struct uv__queue* q;
   uv_write_t* req;
+  unsigned int nreqs;
   ssize_t n;
   int count;
+  int flags;
 
   assert(uv__stream_fd(stream) >= 0);
 
@@ -856,14 +1285,60 @@ static void uv__write(uv_stream_t* stream) {
     req = uv__queue_data(q, uv_write_t, queue);
     assert(req->handle == stream);
 
-    n = uv__try_write(stream,
-                      &(req->bufs[req->write_index]),
-                      req->nbufs - req->write_index,
-                      req->send_handle);
+    /* Corked streams write the requests that queued up together in one go,
+     * other streams keep writing them one by one.
+     */
+    nreqs = 0;
+    if ((stream->flags & UV_HANDLE_CORKED) &&
+        req->send_handle == NULL &&
+        uv__queue_next(q) != &stream->write_queue) {
+      n = uv__write_gather(stream, &nreqs);
+    }
+
+    if (nreqs > 1) {
+      if (n >= 0) {
+        if (uv__write_gather_update(stream, n, nreqs)) {
+          if (count-- > 0)
+            continue;
+
+          return;
+        }
+      } else if (n != UV_EAGAIN) {
+        goto error;
+      }
+
+      goto wait;
+    }
+
+    if (uv__write_ext(req)->sendfile_fd != -1) {
+      flags = 0;
+      n = uv__write_sendfile(stream, req);
+    } else {
+      flags = uv__write_zerocopy_flags(stream, req);
+      n = uv__try_write(stream,
+                        &(req->bufs[req->write_index]),
+                        req->nbufs - req->write_index,
+                        req->send_handle,
+                        flags);
+    }
+
+    if (n == UV_ENOBUFS && flags != 0) {
+      flags = 0;
+      n = uv__try_write(stream,
+                        &(req->bufs[req->write_index]),
+                        req->nbufs - req->write_index,
+                        req->send_handle,
+                        flags);
+    }
 
     /* Ensure the handle isn't sent again in case this is a partial write. */
     if (n >= 0) {
       req->send_handle = NULL;
+      if (n > 0 && flags != 0) {
+        wext = uv__write_ext(req);
+        wext->flags |= UV__WRITE_ZEROCOPY;
+        wext->zerocopy_id = uv__stream_ext(stream)->zerocopy_sent++;
+      }
       if (uv__write_req_update(stream, req, n)) {
         uv__write_req_finish(req);
         if (count-- > 0)
@@ -874,6 +1349,7 @@ static void uv__write(uv_stream_t* stream) {
     } else if (n != UV_EAGAIN)
       goto error;
 
+wait:
     /* If this is a blocking stream, try again. */
     if (stream->flags & UV_HANDLE_BLOCKING_WRITES)
       continue;
@@ -895,6 +1371,32 @@ error:
 }
 
 
+/* Tells the user when write_queue_size goes up to the high watermark, and
+ * again when it has come back down to the low watermark.
+ */
+static void uv__stream_watermarks(uv_stream_t* stream) {
+  uv__stream_ext_t* ext;
+
+  ext = uv__stream_ext(stream);
+  if (ext == NULL || ext->watermark_cb == NULL)
+    return;
+
+  if (stream->flags & UV_HANDLE_HIGH_WATERMARK) {
+    if (stream->write_queue_size > ext->watermark_low)
+      return;
+
+    stream->flags &= ~UV_HANDLE_HIGH_WATERMARK;
+    ext->watermark_cb(stream, 0);
+  } else {
+    if (stream->write_queue_size < ext->watermark_high)
+      return;
+
+    stream->flags |= UV_HANDLE_HIGH_WATERMARK;
+    ext->watermark_cb(stream, 1);
+  }
+}
+
+
 static void uv__write_callbacks(uv_stream_t* stream) {
   uv_write_t* req;
   struct uv__queue* q;
@@ -914,8 +1416,10 @@ static void uv__write_callbacks(uv_stream_t* stream) {
 
     if (req->bufs != NULL) {
       stream->write_queue_size -= uv__write_req_size(req);
-      if (req->bufs != req->bufsml)
+      if (req->bufs != req->bufsml &&
+          !(uv__write_ext(req)->flags & UV__WRITE_NOCOPY)) {
         uv__free(req->bufs);
+      }
       req->bufs = NULL;
     }
 
@@ -1023,43 +1527,348 @@ static int uv__stream_recv_cmsg(uv_stream_t* stream, struct msghdr* msg) {
 }
 
 
-static void uv__read(uv_stream_t* stream) {
-  uv_buf_t buf;
+static void uv__read_error(uv_stream_t* stream,
+                           int err,
+                           const uv_buf_t* buf) {
+  /* Error. User should call uv_close(). */
+  stream->flags &= ~(UV_HANDLE_READABLE | UV_HANDLE_WRITABLE);
+  stream->read_cb(stream, err, buf);
+  if (stream->read_cb != NULL) {
+    stream->read_cb = NULL;
+    stream->alloc_cb = NULL;
+    uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
+    uv__handle_stop(stream);
+    uv__stream_osx_interrupt_select(stream);
+  }
+}
+
+
+/* The read_cb of streams started with uv_read_start_v(). uv__read_v() does
+ * the batched reads, this delivers EOF and errors from the other paths.
+ */
+static void uv__read_v_cb(uv_stream_t* stream,
+                          ssize_t nread,
+                          const uv_buf_t* buf) {
+  uv__stream_ext(stream)->read_v_cb(stream, nread, buf, 1);
+}
+
+
+/* Like uv__read() but passes the data of several reads to the callback in
+ * one go. The callback also gets the buffers that weren't filled, with
+ * their length set to zero, so that it can release them.
+ */
+static void uv__read_v(uv_stream_t* stream) {
+  uv_buf_t bufs[16];
+  uv_buf_t errbuf;
+  uv_buf_t* buf;
+  unsigned int nbufs;
   ssize_t nread;
-  struct msghdr msg;
-  union uv__cmsg cmsg;
-  int count;
+  size_t total;
+  size_t len;
   int err;
-  int is_ipc;
 
-  /* Prevent loop starvation when the data comes in as fast as (or faster than)
-   * we can read it. XXX Need to rearm fd if we switch to edge-triggered I/O.
-   */
-  count = 32;
+  nbufs = 0;
+  total = 0;
+  err = 0;
 
-  is_ipc = stream->type == UV_NAMED_PIPE && ((uv_pipe_t*) stream)->ipc;
+  while (nbufs < ARRAY_SIZE(bufs)) {
+    buf = &bufs[nbufs];
+    *buf = uv_buf_init(NULL, 0);
+    stream->alloc_cb((uv_handle_t*) stream, 64 * 1024, buf);
+    if (buf->base == NULL || buf->len == 0) {
+      /* User indicates it can't or won't handle the read. */
+      err = UV_ENOBUFS;
+      break;
+    }
 
-  while (stream->read_cb
-      && (count-- > 0)) {
-    assert(stream->alloc_cb != NULL);
+    nbufs++;
+    len = buf->len > UV__IO_MAX_BYTES ? UV__IO_MAX_BYTES : buf->len;
 
-    buf = uv_buf_init(NULL, 0);
-    stream->alloc_cb((uv_handle_t*)stream, 64 * 1024, &buf);
-    if (buf.base == NULL || buf.len == 0) {
-      /* User indicates it can't or won't handle the read. */
-      stream->read_cb(stream, UV_ENOBUFS, &buf);
-      return;
+    do
+      nread = read(uv__stream_fd(stream), buf->base, len);
+    while (nread < 0 && errno == EINTR);
+
+    if (nread <= 0) {
+      if (nread == 0)
+        err = UV_EOF;
+      else if (errno != EAGAIN && errno != EWOULDBLOCK)
+        err = UV__ERR(errno);
+      buf->len = 0;
+      break;
     }
 
-    assert(buf.base != NULL);
-    assert(uv__stream_fd(stream) >= 0);
+    buf->len = nread;
+    total += nread;
 
-    if (!is_ipc) {
-      do {
-        nread = read(uv__stream_fd(stream),
-                     buf.base,
-                     buf.len > UV__IO_MAX_BYTES ? UV__IO_MAX_BYTES : buf.len);
-      } while (nread < 0 && errno == EINTR);
+    /* Same as in uv__read(), a short read means there's no more data. */
+    if ((size_t) nread < len)
+      break;
+  }
+
+  /* The buffer that goes with the EOF or the error. */
+  errbuf = uv_buf_init(NULL, 0);
+  if (err == UV_ENOBUFS)
+    errbuf = bufs[nbufs];
+  else if (err != 0 && total == 0)
+    errbuf = bufs[--nbufs];
+
+  if (nbufs > 0) {
+    uv__stream_ext(stream)->read_v_cb(stream, total, bufs, nbufs);
+    if (stream->read_cb != uv__read_v_cb)
+      return;  /* read_cb stopped reading. */
+  }
+
+  if (err == UV_EOF)
+    uv__stream_eof(stream, &errbuf);
+  else if (err == UV_ENOBUFS)
+    stream->read_cb(stream, err, &errbuf);
+  else if (err != 0)
+    uv__read_error(stream, err, &errbuf);
+}
+
+
+/* Returns the size of the frame at the start of the buffer, 0 if it hasn't
+ * been received in full yet or UV_EMSGSIZE if it's over max_frame_size.
+ */
+static ssize_t uv__frame_size(uv__stream_framing_t* f,
+                              const char* base,
+                              size_t len) {
+  const unsigned char* p;
+  const char* end;
+  uint64_t size;
+  unsigned int i;
+
+  if (f->opts.type == UV_FRAMING_DELIMITER) {
+    end = memchr(base + f->scanned, f->opts.delimiter, len - f->scanned);
+    if (end != NULL) {
+      f->scanned = 0;
+      return end - base + 1;
+    }
+
+    if (len >= f->opts.max_frame_size)
+      return UV_EMSGSIZE;
+
+    f->scanned = len;
+    f->need = 1;
+    return 0;
+  }
+
+  if (len < f->opts.prefix_size) {
+    f->need = f->opts.prefix_size - len;
+    return 0;
+  }
+
+  p = (const unsigned char*) base;
+  size = 0;
+  for (i = 0; i < f->opts.prefix_size; i++)
+    if (f->opts.flags & UV_FRAMING_BIG_ENDIAN)
+      size = size << 8 | p[i];
+    else
+      size |= (uint64_t) p[i] << (8 * i);
+
+  if (size > f->opts.max_frame_size)
+    return UV_EMSGSIZE;
+
+  size += f->opts.prefix_size;
+  if (len < size) {
+    f->need = size - len;
+    return 0;
+  }
+
+  return size;
+}
+
+
+/* Passes the complete frames in the buffer to read_cb. Returns non-zero if
+ * reading stopped, either because of an error or because read_cb stopped it.
+ */
+static int uv__read_frames(uv_stream_t* stream) {
+  uv__stream_framing_t* f;
+  uv_buf_t buf;
+  ssize_t size;
+  size_t off;
+  int stopped;
+
+  f = uv__stream_framing(stream);
+  off = 0;
+  stopped = 0;
+
+  for (;;) {
+    size = uv__frame_size(f, f->buf + off, f->len - off);
+    if (size == 0)
+      break;
+
+    if (size < 0) {
+      f->len = 0;
+      f->scanned = 0;
+      buf = uv_buf_init(NULL, 0);
+      uv__read_error(stream, size, &buf);
+      return 1;
+    }
+
+    buf = uv_buf_init(f->buf + off, size);
+    off += size;
+    stream->read_cb(stream, size, &buf);
+
+    if (stream->read_cb == NULL) {
+      stopped = 1;
+      break;
+    }
+  }
+
+  if (off > 0) {
+    f->len -= off;
+    memmove(f->buf, f->buf + off, f->len);
+  }
+
+  return stopped;
+}
+
+
+/* Tells the kernel not to report the socket readable before the rest of the
+ * length prefix or frame is in. The delimiter can be anywhere so that mode
+ * leaves it at the default of one byte.
+ */
+static void uv__read_frames_lowat(uv_stream_t* stream) {
+#ifdef SO_RCVLOWAT
+  uv__stream_framing_t* f;
+  int lowat;
+
+  f = uv__stream_framing(stream);
+  if (stream->type != UV_TCP)
+    return;
+
+  lowat = 1;
+  if (f->opts.type == UV_FRAMING_PREFIX)
+    lowat = f->need < 64 * 1024 ? f->need : 64 * 1024;
+
+  if (lowat == f->lowat)
+    return;
+
+  if (setsockopt(uv__stream_fd(stream),
+                 SOL_SOCKET,
+                 SO_RCVLOWAT,
+                 &lowat,
+                 sizeof(lowat)) == 0) {
+    f->lowat = lowat;
+  }
+#endif
+}
+
+
+/* uv__read() for streams with framing enabled. The data is read into the
+ * buffer of the framing state instead of one from alloc_cb, the buffer grows
+ * to fit the largest frame.
+ */
+static void uv__read_framed(uv_stream_t* stream) {
+  uv__stream_framing_t* f;
+  uv_buf_t buf;
+  ssize_t nread;
+  size_t space;
+  char* base;
+  int count;
+
+  f = uv__stream_framing(stream);
+  count = 32;
+
+  while (count-- > 0) {
+    space = f->need > 64 * 1024 ? f->need : 64 * 1024;
+    if (f->size - f->len < space) {
+      base = uv__realloc(f->buf, f->len + space);
+      if (base == NULL) {
+        buf = uv_buf_init(NULL, 0);
+        stream->read_cb(stream, UV_ENOBUFS, &buf);
+        return;
+      }
+
+      f->buf = base;
+      f->size = f->len + space;
+    }
+
+    space = f->size - f->len;
+    if (space > UV__IO_MAX_BYTES)
+      space = UV__IO_MAX_BYTES;
+
+    do
+      nread = read(uv__stream_fd(stream), f->buf + f->len, space);
+    while (nread < 0 && errno == EINTR);
+
+    if (nread < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+
+      buf = uv_buf_init(NULL, 0);
+      uv__read_error(stream, UV__ERR(errno), &buf);
+      return;
+    }
+
+    if (nread == 0) {
+      /* A partial frame at the end of the stream is dropped. */
+      buf = uv_buf_init(NULL, 0);
+      uv__stream_eof(stream, &buf);
+      return;
+    }
+
+    f->len += nread;
+    if (uv__read_frames(stream))
+      return;
+
+    /* Same as in uv__read(), a short read means there's no more data. */
+    if ((size_t) nread < space)
+      break;
+  }
+
+  uv__read_frames_lowat(stream);
+}
+
+
+static void uv__read(uv_stream_t* stream) {
+  uv_buf_t buf;
+  ssize_t nread;
+  struct msghdr msg;
+  union uv__cmsg cmsg;
+  int count;
+  int err;
+  int is_ipc;
+
+  if (uv__stream_framing(stream) != NULL) {
+    uv__read_framed(stream);
+    return;
+  }
+
+  if (stream->read_cb == uv__read_v_cb) {
+    uv__read_v(stream);
+    return;
+  }
+
+  /* Prevent loop starvation when the data comes in as fast as (or faster than)
+   * we can read it. XXX Need to rearm fd if we switch to edge-triggered I/O.
+   */
+  count = 32;
+
+  is_ipc = stream->type == UV_NAMED_PIPE && ((uv_pipe_t*) stream)->ipc;
+
+  while (stream->read_cb
+      && (count-- > 0)) {
+    assert(stream->alloc_cb != NULL);
+
+    buf = uv_buf_init(NULL, 0);
+    stream->alloc_cb((uv_handle_t*)stream, 64 * 1024, &buf);
+    if (buf.base == NULL || buf.len == 0) {
+      /* User indicates it can't or won't handle the read. */
+      stream->read_cb(stream, UV_ENOBUFS, &buf);
+      return;
+    }
+
+    assert(buf.base != NULL);
+    assert(uv__stream_fd(stream) >= 0);
+
+    if (!is_ipc) {
+      do {
+        nread = read(uv__stream_fd(stream),
+                     buf.base,
+                     buf.len > UV__IO_MAX_BYTES ? UV__IO_MAX_BYTES : buf.len);
+      } while (nread < 0 && errno == EINTR);
     } else {
       /* ipc uses recvmsg */
       if (buf.len > UV__IO_MAX_BYTES)
@@ -1093,16 +1902,7 @@ static void uv__read(uv_stream_t* stream) {
         return;
 #endif
       } else {
-        /* Error. User should call uv_close(). */
-        stream->flags &= ~(UV_HANDLE_READABLE | UV_HANDLE_WRITABLE);
-        stream->read_cb(stream, UV__ERR(errno), &buf);
-        if (stream->read_cb != NULL) {
-          stream->read_cb = NULL;
-          stream->alloc_cb = NULL;
-          uv__io_stop(stream->loop, &stream->io_watcher, POLLIN);
-          uv__handle_stop(stream);
-          uv__stream_osx_interrupt_select(stream);
-        }
+        uv__read_error(stream, UV__ERR(errno), &buf);
       }
       return;
     } else if (nread == 0) {
@@ -1171,6 +1971,9 @@ int uv_shutdown(uv_shutdown_t* req, uv_stream_t* stream, uv_shutdown_cb cb) {
     return UV_ENOTCONN;
   }
 
+  if (uv__stream_splice_write_req(stream) != NULL)
+    return UV_EBUSY;
+
   assert(uv__stream_fd(stream) >= 0);
 
   /* Initialize request. The `shutdown(2)` call will always be deferred until
@@ -1189,6 +1992,9 @@ int uv_shutdown(uv_shutdown_t* req, uv_stream_t* stream, uv_shutdown_cb cb) {
 
 
 void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
+#if defined(__linux__)
+  uv_splice_t* splice_req;
+#endif
   uv_stream_t* stream;
 
   stream = container_of(w, uv_stream_t, io_watcher);
@@ -1196,6 +2002,19 @@ void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   assert(stream->type == UV_TCP ||
          stream->type == UV_NAMED_PIPE ||
          stream->type == UV_TTY);
+
+#if UV__HAVE_ZEROCOPY
+  /* Closed while zero-copy writes were in flight, see uv__stream_close(). */
+  if (stream->flags & UV_HANDLE_CLOSING) {
+    uv__stream_zerocopy_reap(stream);
+    if (!uv__stream_zerocopy_pending(stream)) {
+      uv__stream_close_fd(stream);
+      uv__make_close_pending((uv_handle_t*) stream);
+    }
+    return;
+  }
+#endif
+
   assert(!(stream->flags & UV_HANDLE_CLOSING));
 
   if (stream->connect_req) {
@@ -1205,8 +2024,38 @@ void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 
   assert(uv__stream_fd(stream) >= 0);
 
-  if (events & (POLLIN | POLLERR))
+#if UV__HAVE_ZEROCOPY
+  if ((events & POLLERR) &&
+      stream->type == UV_TCP &&
+      uv__stream_ext(stream) != NULL &&
+      uv__stream_ext(stream)->zerocopy_released !=
+      uv__stream_ext(stream)->zerocopy_sent) {
+    uv__stream_zerocopy_reap(stream);
+  }
+#endif
+
+#if defined(__linux__)
+  splice_req = uv__stream_splice_read_req(stream);
+  if (splice_req != NULL && (events & (POLLIN | POLLERR | POLLHUP))) {
+    uv__stream_splice_run(splice_req);
+    if (uv__stream_fd(stream) == -1)
+      return;  /* splice_cb closed stream. */
+  }
+#endif
+
+  /* Frames left in the buffer when reading was stopped. uv__read_start()
+   * feeds the watcher to get them delivered.
+   */
+  if (uv__stream_framing(stream) != NULL &&
+      stream->read_cb != NULL &&
+      !(events & (POLLIN | POLLERR))) {
+    uv__read_frames(stream);
+  }
+
+  if ((events & (POLLIN | POLLERR)) &&
+      uv__stream_splice_read_req(stream) == NULL) {
     uv__read(stream);
+  }
 
   if (uv__stream_fd(stream) == -1)
     return;  /* read_cb closed stream. */
@@ -1230,12 +2079,24 @@ void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   }
 
   if (events & (POLLOUT | POLLERR | POLLHUP)) {
+#if defined(__linux__)
+    splice_req = uv__stream_splice_write_req(stream);
+    if (splice_req != NULL) {
+      uv__stream_splice_run(splice_req);
+      if (uv__stream_fd(stream) == -1)
+        return;  /* splice_cb closed stream. */
+    }
+#endif
+
     uv__write(stream);
     uv__write_callbacks(stream);
+    uv__stream_watermarks(stream);
 
-    /* Write queue drained. */
-    if (uv__queue_empty(&stream->write_queue))
+    /* Write queue drained. The splice still needs POLLOUT, if any. */
+    if (uv__queue_empty(&stream->write_queue) &&
+        uv__stream_splice_write_req(stream) == NULL) {
       uv__drain(stream);
+    }
   }
 }
 
@@ -1326,6 +2187,9 @@ static int uv__check_before_write(uv_stream_t* stream,
   if (!(stream->flags & UV_HANDLE_WRITABLE))
     return UV_EPIPE;
 
+  if (uv__stream_splice_write_req(stream) != NULL)
+    return UV_EBUSY;
+
   if (send_handle != NULL) {
     if (stream->type != UV_NAMED_PIPE || !((uv_pipe_t*)stream)->ipc)
       return UV_EINVAL;
@@ -1349,6 +2213,66 @@ static int uv__check_before_write(uv_stream_t* stream,
   return 0;
 }
 
+/* Appends `req` to the write queue and starts writing it when possible.
+ * `empty_queue` tells if the queue was empty before the request was set up.
+ */
+static void uv__write_queue(uv_stream_t* stream,
+                            uv_write_t* req,
+                            int empty_queue) {
+  uv__stream_ext_t* ext;
+
+  uv__queue_insert_tail(&stream->write_queue, &req->queue);
+
+  /* If the queue was empty when this function began, we should attempt to
+   * do the write immediately. Otherwise start the write_watcher and wait
+   * for the fd to become writable.
+   */
+  if (stream->connect_req) {
+    /* Still connecting, do nothing. */
+  }
+  else if ((stream->flags & UV_HANDLE_CORKED) &&
+           !(stream->flags & UV_HANDLE_BLOCKING_WRITES) &&
+           !uv__io_active(&stream->io_watcher, POLLOUT)) {
+    /* Corked: the queue is flushed by uv__stream_flush_corked() in the check
+     * phase of this loop iteration, or now when enough data has accumulated.
+     */
+    ext = uv__stream_ext(stream);
+    if (stream->write_queue_size >= ext->cork_threshold)
+      uv__write(stream);
+    else if (uv__queue_empty(&ext->cork_queue))
+      uv__queue_insert_tail(
+          &uv__get_internal_fields(stream->loop)->corked_streams,
+          &ext->cork_queue);
+  }
+  else if (empty_queue) {
+    uv__write(stream);
+  }
+  else {
+    /*
+     * blocking streams should never have anything in the queue.
+     * if this assert fires then somehow the blocking stream isn't being
+     * sufficiently flushed in uv__write.
+     */
+    assert(!(stream->flags & UV_HANDLE_BLOCKING_WRITES));
+    uv__io_start(stream->loop, &stream->io_watcher, POLLOUT);
+    uv__stream_osx_interrupt_select(stream);
+  }
+
+  /* Don't call watermark_cb from inside uv_write(), uv__stream_io() checks
+   * the watermarks again when the watcher is fed. A connecting stream gets
+   * there once the connection is made.
+   */
+  ext = uv__stream_ext(stream);
+  if (ext != NULL &&
+      ext->watermark_cb != NULL &&
+      stream->connect_req == NULL &&
+      !(stream->flags & UV_HANDLE_HIGH_WATERMARK) &&
+      stream->write_queue_size >= ext->watermark_high) {
+    uv__io_feed(stream->loop, &stream->io_watcher);
+  }
+}
+
+
 int uv_write2(uv_write_t* req,
               uv_stream_t* stream,
               const uv_buf_t bufs[],
@@ -1376,6 +2300,8 @@ int uv_write2(uv_write_t* req,
   req->handle = stream;
   req->error = 0;
   req->send_handle = send_handle;
+  uv__write_ext(req)->flags = 0;
+  uv__write_ext(req)->sendfile_fd = -1;
   uv__queue_init(&req->queue);
 
   req->bufs = req->bufsml;
@@ -1390,29 +2316,91 @@ int uv_write2(uv_write_t* req,
   req->write_index = 0;
   stream->write_queue_size += uv__count_bufs(bufs, nbufs);
 
-  /* Append the request to write_queue. */
-  uv__queue_insert_tail(&stream->write_queue, &req->queue);
+  uv__write_queue(stream, req, empty_queue);
+
+  return 0;
+}
 
-  /* If the queue was empty when this function began, we should attempt to
-   * do the write immediately. Otherwise start the write_watcher and wait
-   * for the fd to become writable.
-   */
-  if (stream->connect_req) {
-    /* Still connecting, do nothing. */
-  }
-  else if (empty_queue) {
-    uv__write(stream);
-  }
-  else {
-    /*
-     * blocking streams should never have anything in the queue.
-     * if this assert fires then somehow the blocking stream isn't being
-     * sufficiently flushed in uv__write.
-     */
-    assert(!(stream->flags & UV_HANDLE_BLOCKING_WRITES));
-    uv__io_start(stream->loop, &stream->io_watcher, POLLOUT);
-    uv__stream_osx_interrupt_select(stream);
-  }
+
+int uv_stream_sendfile(uv_write_t* req,
+                       uv_stream_t* stream,
+                       uv_file file,
+                       int64_t offset,
+                       size_t length,
+                       uv_write_cb cb) {
+  uv_buf_t buf;
+  int empty_queue;
+  int err;
+
+#if defined(__linux__)
+  if (file < 0 || offset < 0)
+    return UV_EINVAL;
+
+  buf = uv_buf_init(NULL, length);
+  err = uv__check_before_write(stream, &buf, 1, NULL);
+  if (err < 0)
+    return err;
+
+  empty_queue = (stream->write_queue_size == 0);
+
+  uv__req_init(stream->loop, req, UV_WRITE);
+  req->cb = cb;
+  req->handle = stream;
+  req->error = 0;
+  req->send_handle = NULL;
+  uv__write_ext(req)->flags = 0;
+  uv__write_ext(req)->sendfile_fd = file;
+  memcpy(uv__write_ext(req)->sendfile_offset, &offset, sizeof(offset));
+  uv__queue_init(&req->queue);
+
+  req->bufs = req->bufsml;
+  req->bufs[0] = buf;
+  req->nbufs = 1;
+  req->write_index = 0;
+  stream->write_queue_size += length;
+
+  uv__write_queue(stream, req, empty_queue);
+
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+/* Like uv_write() but the uv_buf_t array is used in place instead of being
+ * copied, which saves the allocation for more than ARRAY_SIZE(req->bufsml)
+ * buffers. The array is updated as the data goes out.
+ */
+int uv_write_nocopy(uv_write_t* req,
+                    uv_stream_t* stream,
+                    uv_buf_t bufs[],
+                    unsigned int nbufs,
+                    uv_write_cb cb) {
+  int empty_queue;
+  int err;
+
+  err = uv__check_before_write(stream, bufs, nbufs, NULL);
+  if (err < 0)
+    return err;
+
+  empty_queue = (stream->write_queue_size == 0);
+
+  uv__req_init(stream->loop, req, UV_WRITE);
+  req->cb = cb;
+  req->handle = stream;
+  req->error = 0;
+  req->send_handle = NULL;
+  uv__write_ext(req)->flags = UV__WRITE_NOCOPY;
+  uv__write_ext(req)->sendfile_fd = -1;
+  uv__queue_init(&req->queue);
+
+  req->bufs = bufs;
+  req->nbufs = nbufs;
+  req->write_index = 0;
+  stream->write_queue_size += uv__count_bufs(bufs, nbufs);
+
+  uv__write_queue(stream, req, empty_queue);
 
   return 0;
 }
@@ -1451,7 +2439,7 @@ int uv_try_write2(uv_stream_t* stream,
   if (err < 0)
     return err;
 
-  return uv__try_write(stream, bufs, nbufs, send_handle);
+  return uv__try_write(stream, bufs, nbufs, send_handle, 0);
 }
 
 
@@ -1461,6 +2449,9 @@ int uv__read_start(uv_stream_t* stream,
   assert(stream->type == UV_TCP || stream->type == UV_NAMED_PIPE ||
       stream->type == UV_TTY);
 
+  if (uv__stream_splice_read_req(stream) != NULL)
+    return UV_EBUSY;
+
   stream->flags &= ~UV_HANDLE_READ_EOF;
 
   /* TODO: try to do the read inline? */
@@ -1474,10 +2465,49 @@ int uv__read_start(uv_stream_t* stream,
   uv__handle_start(stream);
   uv__stream_osx_interrupt_select(stream);
 
+  if (uv__stream_framing(stream) != NULL &&
+      uv__stream_framing(stream)->len > 0) {
+    uv__io_feed(stream->loop, &stream->io_watcher);
+  }
+
   return 0;
 }
 
 
+int uv_read_start_v(uv_stream_t* stream,
+                    uv_alloc_cb alloc_cb,
+                    uv_read_v_cb read_cb) {
+  uv__stream_ext_t* ext;
+  int err;
+
+  if (stream == NULL || alloc_cb == NULL || read_cb == NULL)
+    return UV_EINVAL;
+
+  /* Handles that are passed along can't be matched up with the buffers. */
+  if (stream->type == UV_NAMED_PIPE && ((uv_pipe_t*) stream)->ipc)
+    return UV_EINVAL;
+
+  if (stream->flags & UV_HANDLE_CLOSING)
+    return UV_EINVAL;
+
+  if (stream->read_cb != NULL)
+    return UV_EALREADY;
+
+  if (!(stream->flags & UV_HANDLE_READABLE))
+    return UV_ENOTCONN;
+
+  ext = uv__stream_ext_get(stream);
+  if (ext == NULL)
+    return UV_ENOMEM;
+
+  err = uv__read_start(stream, alloc_cb, uv__read_v_cb);
+  if (err == 0)
+    ext->read_v_cb = read_cb;
+
+  return err;
+}
+
+
 int uv_read_stop(uv_stream_t* stream) {
   if (stream->read_cb == NULL)
     return 0;
@@ -1519,9 +2549,25 @@ int uv___stream_fd(const uv_stream_t* handle) {
 #endif /* defined(__APPLE__) */
 
 
+static void uv__stream_close_fd(uv_stream_t* handle) {
+  uv__io_close(handle->loop, &handle->io_watcher);
+
+  if (handle->io_watcher.fd != -1) {
+    /* Don't close stdio file descriptors.  Nothing good comes from it. */
+    if (handle->io_watcher.fd > STDERR_FILENO)
+      uv__close(handle->io_watcher.fd);
+    handle->io_watcher.fd = -1;
+  }
+}
+
+
 void uv__stream_close(uv_stream_t* handle) {
   unsigned int i;
   uv__stream_queued_fds_t* queued_fds;
+  uv_write_t* wreq;
+#if defined(__linux__)
+  uv_splice_t* req;
+#endif
 
 #if defined(__APPLE__)
   /* Terminate select loop first */
@@ -1544,18 +2590,56 @@ void uv__stream_close(uv_stream_t* handle) {
   }
 #endif /* defined(__APPLE__) */
 
-  uv__io_close(handle->loop, &handle->io_watcher);
+#if defined(__linux__)
+  /* Stop the splices this stream takes part in. The requests stay attached
+   * to this stream so that uv__stream_destroy() can cancel them.
+   */
+  req = uv__stream_splice_read_req(handle);
+  if (req != NULL) {
+    uv__stream_splice_detach(req);
+    uv__stream_ext(handle)->splice_read_req = req;
+  }
+
+  req = uv__stream_splice_write_req(handle);
+  if (req != NULL) {
+    uv__stream_splice_detach(req);
+    uv__stream_ext(handle)->splice_write_req = req;
+  }
+#endif
+
   uv_read_stop(handle);
   uv__handle_stop(handle);
   handle->flags &= ~(UV_HANDLE_READABLE | UV_HANDLE_WRITABLE);
 
-  if (handle->io_watcher.fd != -1) {
-    /* Don't close stdio file descriptors.  Nothing good comes from it. */
-    if (handle->io_watcher.fd > STDERR_FILENO)
-      uv__close(handle->io_watcher.fd);
-    handle->io_watcher.fd = -1;
+  if (uv__stream_ext(handle) != NULL) {
+    uv__queue_remove(&uv__stream_ext(handle)->cork_queue);
+    uv__queue_init(&uv__stream_ext(handle)->cork_queue);
+  }
+
+  /* A zero-copy write that was only sent in part. It is canceled but the
+   * kernel holds on to the part that went out, so it waits like the others.
+   */
+  if (!uv__queue_empty(&handle->write_queue)) {
+    wreq = uv__queue_data(uv__queue_head(&handle->write_queue),
+                          uv_write_t,
+                          queue);
+    if (uv__write_ext(wreq)->flags & UV__WRITE_ZEROCOPY) {
+      wreq->error = UV_ECANCELED;
+      uv__write_req_finish(wreq);
+    }
   }
 
+  /* The kernel may still be reading from the buffers of zero-copy writes and
+   * their callbacks can't run before it is done with them. Keep the socket
+   * open for the completion notifications, uv__stream_io() closes it after
+   * the last one. uv_close() leaves the handle alone while the socket is
+   * open.
+   */
+  if (uv__stream_zerocopy_pending(handle))
+    uv__io_stop(handle->loop, &handle->io_watcher, POLLIN | POLLOUT);
+  else
+    uv__stream_close_fd(handle);
+
   if (handle->accepted_fd != -1) {
     uv__close(handle->accepted_fd);
     handle->accepted_fd = -1;
@@ -1580,3 +2664,293 @@ int uv_stream_set_blocking(uv_stream_t* handle, int blocking) {
    */
   return uv__nonblock(uv__stream_fd(handle), !blocking);
 }
+
+
+int uv_stream_set_watermarks(uv_stream_t* handle,
+                             size_t low,
+                             size_t high,
+                             uv_watermark_cb cb) {
+  uv__stream_ext_t* ext;
+
+  if (cb != NULL && (high == 0 || low > high))
+    return UV_EINVAL;
+
+  handle->flags &= ~UV_HANDLE_HIGH_WATERMARK;
+
+  ext = uv__stream_ext(handle);
+  if (ext == NULL && cb == NULL)
+    return 0;
+
+  ext = uv__stream_ext_get(handle);
+  if (ext == NULL)
+    return UV_ENOMEM;
+
+  ext->watermark_low = low;
+  ext->watermark_high = high;
+  ext->watermark_cb = cb;
+
+  return 0;
+}
+
+
+int uv_stream_set_framing(uv_stream_t* handle,
+                          const uv_stream_framing_t* framing) {
+  uv__stream_framing_t* f;
+  uv__stream_ext_t* ext;
+  int lowat;
+
+  f = uv__stream_framing(handle);
+
+  /* The frames are delivered from the framing buffer while reading and
+   * switching it out would lose the partial frame.
+   */
+  if (handle->read_cb != NULL)
+    return UV_EBUSY;
+
+  if (f != NULL && f->len > 0)
+    return UV_EBUSY;
+
+  if (framing == NULL || framing->type == UV_FRAMING_NONE) {
+    if (f == NULL)
+      return 0;
+
+#ifdef SO_RCVLOWAT
+    if (f->lowat != 1 && uv__stream_fd(handle) != -1) {
+      lowat = 1;
+      setsockopt(uv__stream_fd(handle),
+                 SOL_SOCKET,
+                 SO_RCVLOWAT,
+                 &lowat,
+                 sizeof(lowat));
+    }
+#endif
+
+    uv__free(f->buf);
+    uv__free(f);
+    uv__stream_ext(handle)->framing = NULL;
+    return 0;
+  }
+
+  if (framing->type == UV_FRAMING_PREFIX) {
+    switch (framing->prefix_size) {
+      case 1:
+      case 2:
+      case 4:
+      case 8:
+        break;
+      default:
+        return UV_EINVAL;
+    }
+  } else if (framing->type != UV_FRAMING_DELIMITER) {
+    return UV_EINVAL;
+  }
+
+  if (framing->flags & ~UV_FRAMING_BIG_ENDIAN)
+    return UV_EINVAL;
+
+  /* Handles that are passed along can't be matched up with the frames. */
+  if (handle->type == UV_NAMED_PIPE && ((uv_pipe_t*) handle)->ipc)
+    return UV_EINVAL;
+
+  if (f == NULL) {
+    ext = uv__stream_ext_get(handle);
+    if (ext == NULL)
+      return UV_ENOMEM;
+
+    f = uv__calloc(1, sizeof(*f));
+    if (f == NULL)
+      return UV_ENOMEM;
+
+    f->lowat = 1;
+    ext->framing = f;
+  }
+
+  f->opts = *framing;
+  if (f->opts.max_frame_size == 0)
+    f->opts.max_frame_size = 16 * 1024 * 1024;
+
+  f->need = 1;
+  if (f->opts.type == UV_FRAMING_PREFIX)
+    f->need = f->opts.prefix_size;
+
+  f->scanned = 0;
+
+  return 0;
+}
+
+
+int uv_stream_set_cork(uv_stream_t* handle, int enable, size_t threshold) {
+  uv__stream_ext_t* ext;
+
+  if (!enable) {
+    handle->flags &= ~UV_HANDLE_CORKED;
+    return 0;
+  }
+
+  ext = uv__stream_ext_get(handle);
+  if (ext == NULL)
+    return UV_ENOMEM;
+
+  if (threshold == 0)
+    threshold = 64 * 1024;
+
+  ext->cork_threshold = threshold;
+  handle->flags |= UV_HANDLE_CORKED;
+
+  return 0;
+}
+
+
+#if defined(__linux__)
+static void uv__stream_splice_detach(uv_splice_t* req) {
+  uv_stream_t* src;
+  uv_stream_t* dst;
+
+  src = req->src;
+  dst = req->dst;
+  uv__stream_ext(src)->splice_read_req = NULL;
+  uv__stream_ext(dst)->splice_write_req = NULL;
+
+  if (!uv__is_closing(src) && src->read_cb == NULL)
+    uv__io_stop(src->loop, &src->io_watcher, POLLIN);
+
+  if (!uv__is_closing(dst) && uv__queue_empty(&dst->write_queue))
+    uv__io_stop(dst->loop, &dst->io_watcher, POLLOUT);
+
+  uv__close(req->fds[0]);
+  uv__close(req->fds[1]);
+  req->fds[0] = -1;
+  req->fds[1] = -1;
+}
+
+
+static void uv__stream_splice_finish(uv_splice_t* req, int status) {
+  uv__stream_splice_detach(req);
+  uv__req_unregister(req->src->loop);
+  req->cb(req, status);
+}
+
+
+static void uv__stream_splice_run(uv_splice_t* req) {
+  uv_stream_t* src;
+  uv_stream_t* dst;
+  ssize_t n;
+  int count;
+
+  src = req->src;
+  dst = req->dst;
+
+  /* Same starvation guard as uv__read() and uv__write(). */
+  for (count = 32; count > 0; count--) {
+    if (req->buffered > 0) {
+      do
+        n = splice(req->fds[0], NULL, uv__stream_fd(dst), NULL, req->buffered,
+                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      while (n == -1 && errno == EINTR);
+
+      if (n == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+          break;
+        uv__stream_splice_finish(req, UV__ERR(errno));
+        return;
+      }
+
+      req->buffered -= n;
+      req->nbytes += n;
+      continue;
+    }
+
+    do
+      n = splice(uv__stream_fd(src), NULL, req->fds[1], NULL, INT32_MAX,
+                 SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    while (n == -1 && errno == EINTR);
+
+    if (n == 0) {
+      uv__stream_splice_finish(req, 0);
+      return;
+    }
+
+    if (n == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+      uv__stream_splice_finish(req, UV__ERR(errno));
+      return;
+    }
+
+    req->buffered = n;
+  }
+
+  /* Wait for whichever side is holding us up. */
+  if (req->buffered > 0) {
+    uv__io_stop(src->loop, &src->io_watcher, POLLIN);
+    uv__io_start(dst->loop, &dst->io_watcher, POLLOUT);
+  } else {
+    if (uv__queue_empty(&dst->write_queue))
+      uv__io_stop(dst->loop, &dst->io_watcher, POLLOUT);
+    uv__io_start(src->loop, &src->io_watcher, POLLIN);
+  }
+}
+#endif  /* defined(__linux__) */
+
+
+int uv_stream_splice(uv_splice_t* req,
+                     uv_stream_t* src,
+                     uv_stream_t* dst,
+                     uv_splice_cb cb) {
+#if defined(__linux__)
+  int fds[2];
+  int err;
+
+  if (src == dst || src->loop != dst->loop)
+    return UV_EINVAL;
+
+  if ((src->type != UV_TCP && src->type != UV_NAMED_PIPE) ||
+      (dst->type != UV_TCP && dst->type != UV_NAMED_PIPE)) {
+    return UV_EINVAL;
+  }
+
+  if (uv__is_closing(src) || uv__is_closing(dst))
+    return UV_EINVAL;
+
+  if (uv__stream_fd(src) < 0 || !(src->flags & UV_HANDLE_READABLE))
+    return UV_ENOTCONN;
+
+  if (uv__stream_fd(dst) < 0 || !(dst->flags & UV_HANDLE_WRITABLE))
+    return UV_EPIPE;
+
+  if (src->read_cb != NULL ||
+      uv__stream_splice_read_req(src) != NULL ||
+      uv__stream_splice_write_req(dst) != NULL ||
+      dst->write_queue_size != 0 ||
+      uv__is_stream_shutting(dst)) {
+    return UV_EBUSY;
+  }
+
+  if (uv__stream_ext_get(src) == NULL || uv__stream_ext_get(dst) == NULL)
+    return UV_ENOMEM;
+
+  err = uv__make_pipe(fds, UV_NONBLOCK_PIPE);
+  if (err)
+    return err;
+
+  /* Best effort, the default of 64 KiB costs a lot of round trips. */
+  fcntl(fds[1], F_SETPIPE_SZ, 1024 * 1024);
+
+  uv__req_init(src->loop, req, UV_SPLICE);
+  req->cb = cb;
+  req->src = src;
+  req->dst = dst;
+  req->nbytes = 0;
+  req->fds[0] = fds[0];
+  req->fds[1] = fds[1];
+  req->buffered = 0;
+  uv__stream_ext(src)->splice_read_req = req;
+  uv__stream_ext(dst)->splice_write_req = req;
+
+  uv__io_start(src->loop, &src->io_watcher, POLLIN);
+
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
@@ -35,6 +35,67 @@
 #include <ifaddrs.h>
 #endif
 
+#if defined(__linux__)
+/* struct tcp_info from <linux/tcp.h>, which can't be included together with
+ * <netinet/tcp.h>. The glibc copy lacks the newer fields. The kernel only
+ * ever appends to it.
+ */
+struct uv__tcp_info {
+  uint8_t state;
+  uint8_t ca_state;
+  uint8_t retransmits;
+  uint8_t probes;
+  uint8_t backoff;
+  uint8_t options;
+  uint8_t wscale;
+  uint8_t flags;
+  uint32_t rto;
+  uint32_t ato;
+  uint32_t snd_mss;
+  uint32_t rcv_mss;
+  uint32_t unacked;
+  uint32_t sacked;
+  uint32_t lost;
+  uint32_t retrans;
+  uint32_t fackets;
+  uint32_t last_data_sent;
+  uint32_t last_ack_sent;
+  uint32_t last_data_recv;
+  uint32_t last_ack_recv;
+  uint32_t pmtu;
+  uint32_t rcv_ssthresh;
+  uint32_t rtt;
+  uint32_t rttvar;
+  uint32_t snd_ssthresh;
+  uint32_t snd_cwnd;
+  uint32_t advmss;
+  uint32_t reordering;
+  uint32_t rcv_rtt;
+  uint32_t rcv_space;
+  uint32_t total_retrans;
+  uint64_t pacing_rate;
+  uint64_t max_pacing_rate;
+  uint64_t bytes_acked;
+  uint64_t bytes_received;
+  uint32_t segs_out;
+  uint32_t segs_in;
+  uint32_t notsent_bytes;
+  uint32_t min_rtt;
+  uint32_t data_segs_in;
+  uint32_t data_segs_out;
+  uint64_t delivery_rate;
+  uint64_t busy_time;
+  uint64_t rwnd_limited;
+  uint64_t sndbuf_limited;
+  uint32_t delivered;
+  uint32_t delivered_ce;
+  uint64_t bytes_sent;
+};
+
+STATIC_ASSERT(104 == offsetof(struct uv__tcp_info, pacing_rate));
+STATIC_ASSERT(200 == offsetof(struct uv__tcp_info, bytes_sent));
+#endif
+
 static int maybe_bind_socket(int fd) {
   union uv__sockaddr s;
   socklen_t slen;
@@ -159,6 +220,11 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   if ((flags & UV_TCP_IPV6ONLY) && addr->sa_family != AF_INET6)
     return UV_EINVAL;
 
+#ifndef TCP_FASTOPEN
+  if (flags & UV_TCP_FASTOPEN)
+    return UV_ENOTSUP;
+#endif
+
   err = maybe_new_socket(tcp, addr->sa_family, 0);
   if (err)
     return err;
@@ -207,6 +273,10 @@ int uv__tcp_bind(uv_tcp_t* tcp,
   if (addr->sa_family == AF_INET6)
     tcp->flags |= UV_HANDLE_IPV6;
 
+  /* The queue length is known only when uv__tcp_listen() is called. */
+  if (flags & UV_TCP_FASTOPEN)
+    tcp->flags |= UV_HANDLE_TCP_FASTOPEN;
+
   return 0;
 }
 
@@ -278,6 +348,7 @@ int uv__tcp_connect(uv_connect_t* req,
                     uv_tcp_t* handle,
                     const struct sockaddr* addr,
                     unsigned int addrlen,
+                    unsigned int flags,
                     uv_connect_cb cb) {
   struct sockaddr_in6 tmp6;
   int err;
@@ -288,6 +359,11 @@ int uv__tcp_connect(uv_connect_t* req,
   if (handle->connect_req != NULL)
     return UV_EALREADY;  /* FIXME(bnoordhuis) UV_EINVAL or maybe UV_EBUSY. */
 
+#ifndef TCP_FASTOPEN_CONNECT
+  if (flags & UV_TCP_FASTOPEN)
+    return UV_ENOTSUP;
+#endif
+
   if (handle->delayed_error != 0)
     goto out;
 
@@ -297,6 +373,22 @@ int uv__tcp_connect(uv_connect_t* req,
   if (err)
     return err;
 
+#ifdef TCP_FASTOPEN_CONNECT
+  /* connect() only sets things up when a cookie for the peer is cached and
+   * returns success. The SYN goes out with the data of the first write.
+   */
+  if (flags & UV_TCP_FASTOPEN) {
+    int on = 1;
+    if (setsockopt(uv__stream_fd(handle),
+                   IPPROTO_TCP,
+                   TCP_FASTOPEN_CONNECT,
+                   &on,
+                   sizeof(on))) {
+      return UV__ERR(errno);
+    }
+  }
+#endif
+
   if (uv__is_ipv6_link_local(addr)) {
     memcpy(&tmp6, addr, sizeof(tmp6));
     if (tmp6.sin6_scope_id == 0) {
@@ -396,6 +488,10 @@ int uv_tcp_getpeername(const uv_tcp_t* handle,
 int uv_tcp_close_reset(uv_tcp_t* handle, uv_close_cb close_cb) {
   int fd;
   struct linger l = { 1, 0 };
+#if UV__HAVE_ZEROCOPY
+  struct sockaddr sa;
+  uv__stream_ext_t* ext;
+#endif
 
   /* Disallow setting SO_LINGER to zero due to some platform inconsistencies */
   if (uv__is_stream_shutting(handle))
@@ -413,6 +509,20 @@ int uv_tcp_close_reset(uv_tcp_t* handle, uv_close_cb close_cb) {
     }
   }
 
+#if UV__HAVE_ZEROCOPY
+  /* uv_close() keeps the socket open until the kernel releases the buffers
+   * of the zero-copy writes, which may take until the connection times out.
+   * Disconnecting sends the RST now and makes the kernel drop the data it
+   * still holds, the completion notifications follow right away.
+   */
+  ext = uv__stream_ext(handle);
+  if (ext != NULL && ext->zerocopy_released != ext->zerocopy_sent) {
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_family = AF_UNSPEC;
+    connect(fd, &sa, sizeof(sa));
+  }
+#endif
+
   uv_close((uv_handle_t*) handle, close_cb);
   return 0;
 }
@@ -437,6 +547,17 @@ int uv__tcp_listen(uv_tcp_t* tcp, int backlog, uv_connection_cb cb) {
   if (err)
     return err;
 
+#ifdef TCP_FASTOPEN
+  if ((tcp->flags & UV_HANDLE_TCP_FASTOPEN) &&
+      setsockopt(tcp->io_watcher.fd,
+                 IPPROTO_TCP,
+                 TCP_FASTOPEN,
+                 &backlog,
+                 sizeof(backlog))) {
+    return UV__ERR(errno);
+  }
+#endif
+
   if (listen(tcp->io_watcher.fd, backlog))
     return UV__ERR(errno);
 
@@ -457,6 +578,28 @@ int uv__tcp_nodelay(int fd, int on) {
 }
 
 
+int uv__tcp_zerocopy(int fd, int on) {
+#if UV__HAVE_ZEROCOPY
+  if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)))
+    return UV__ERR(errno);
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+int uv__tcp_notsent_lowat(int fd, unsigned int bytes) {
+#ifdef TCP_NOTSENT_LOWAT
+  if (setsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &bytes, sizeof(bytes)))
+    return UV__ERR(errno);
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
 #if (defined(UV__SOLARIS_11_4) && !UV__SOLARIS_11_4) || \
     (defined(__DragonFly__) && __DragonFly_version < 500702)
 /* DragonFlyBSD <500702 and Solaris <11.4 require millisecond units
@@ -588,6 +731,122 @@ int uv_tcp_nodelay(uv_tcp_t* handle, int on) {
 }
 
 
+int uv_tcp_zerocopy(uv_tcp_t* handle, int on, size_t threshold) {
+  uv__stream_ext_t* ext;
+  int err;
+
+  if (!UV__HAVE_ZEROCOPY)
+    return UV_ENOTSUP;
+
+  ext = uv__stream_ext_get((uv_stream_t*) handle);
+  if (ext == NULL)
+    return UV_ENOMEM;
+
+  if (uv__stream_fd(handle) != -1) {
+    err = uv__tcp_zerocopy(uv__stream_fd(handle), on);
+    if (err)
+      return err;
+  }
+
+  /* Below ~10 kB the page pinning and the completion notification cost more
+   * than the copy that they avoid.
+   */
+  if (threshold == 0)
+    threshold = 16 * 1024;
+
+  ext->zerocopy_threshold = threshold;
+  handle->flags &= ~UV_HANDLE_TCP_ZEROCOPY_COPIED;
+
+  if (on)
+    handle->flags |= UV_HANDLE_TCP_ZEROCOPY;
+  else
+    handle->flags &= ~UV_HANDLE_TCP_ZEROCOPY;
+
+  return 0;
+}
+
+
+int uv_tcp_notsent_lowat(uv_tcp_t* handle, unsigned int bytes) {
+#ifdef TCP_NOTSENT_LOWAT
+  uv__stream_ext_t* ext;
+  int err;
+
+  ext = uv__stream_ext_get((uv_stream_t*) handle);
+  if (ext == NULL)
+    return UV_ENOMEM;
+
+  if (uv__stream_fd(handle) != -1) {
+    err = uv__tcp_notsent_lowat(uv__stream_fd(handle), bytes);
+    if (err)
+      return err;
+  }
+
+  ext->notsent_lowat = bytes;
+
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+int uv_tcp_get_info(const uv_tcp_t* handle, uv_tcp_info_t* info) {
+#if defined(__linux__)
+  struct uv__tcp_info ti;
+  socklen_t len;
+
+  if (uv__stream_fd(handle) < 0)
+    return UV_EBADF;
+
+  /* Older kernels fill in less, the rest reads as zero. */
+  memset(&ti, 0, sizeof(ti));
+  len = sizeof(ti);
+  if (getsockopt(uv__stream_fd(handle), IPPROTO_TCP, TCP_INFO, &ti, &len))
+    return UV__ERR(errno);
+
+  memset(info, 0, sizeof(*info));
+  info->rtt = ti.rtt;
+  info->rtt_var = ti.rttvar;
+  info->min_rtt = ti.min_rtt;
+  info->cwnd = ti.snd_cwnd;
+  info->ssthresh = ti.snd_ssthresh;
+  info->mss = ti.snd_mss;
+  info->unacked = ti.unacked;
+  info->lost = ti.lost;
+  info->retransmits = ti.total_retrans;
+  info->notsent_bytes = ti.notsent_bytes;
+  info->delivery_rate = ti.delivery_rate;
+  info->bytes_sent = ti.bytes_sent;
+  info->bytes_acked = ti.bytes_acked;
+  info->bytes_received = ti.bytes_received;
+
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+int uv_tcp_fastopen_accepted(const uv_tcp_t* handle) {
+#if defined(__linux__) && defined(TCPI_OPT_SYN_DATA)
+  struct tcp_info info;
+  socklen_t len;
+
+  if (uv__stream_fd(handle) < 0)
+    return UV_EBADF;
+
+  len = sizeof(info);
+  if (getsockopt(uv__stream_fd(handle), IPPROTO_TCP, TCP_INFO, &info, &len))
+    return UV__ERR(errno);
+
+  /* Set on both ends once the data in the SYN was acknowledged. */
+  return !!(info.tcpi_options & TCPI_OPT_SYN_DATA);
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
 int uv_tcp_keepalive(uv_tcp_t* handle, int on, unsigned int idle) {
   return uv_tcp_keepalive_ex(handle, on, idle, 1, 10);
 }
@@ -34,6 +34,20 @@
 
 #if defined(__linux__)
 #include <linux/errqueue.h>
+#include <linux/filter.h>
+#include <netinet/udp.h>
+#endif
+
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+# define UDP_SEGMENT 103
+#endif
+
+#if defined(__linux__) && !defined(UDP_GRO)
+# define UDP_GRO 104
+#endif
+
+#if defined(__linux__) && !defined(SO_ATTACH_REUSEPORT_CBPF)
+# define SO_ATTACH_REUSEPORT_CBPF 51
 #endif
 
 #if defined(IPV6_JOIN_GROUP) && !defined(IPV6_ADD_MEMBERSHIP)
@@ -47,16 +61,243 @@
 static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_recvmsg(uv_udp_t* handle, int flag);
 static void uv__udp_sendmsg(uv_udp_t* handle);
+static void uv__udp_send_enqueue(uv_udp_t* handle,
+                                 uv_udp_send_t* req,
+                                 int empty_queue);
 static int uv__udp_maybe_deferred_bind(uv_udp_t* handle,
                                        int domain,
                                        unsigned int flags);
 static int uv__udp_sendmsg1(int fd,
                             const uv_buf_t* bufs,
                             unsigned int nbufs,
-                            const struct sockaddr* addr);
+                            const struct sockaddr* addr,
+                            const uv_udp_send_t* req);
+
+/* Room for the control messages of an outgoing datagram. */
+union uv__udp_cmsg {
+  struct cmsghdr hdr;
+  char pad[128];
+};
+
+/* The option that reports the destination address of IPv4 datagrams. */
+#if defined(IP_PKTINFO)
+# define UV__IP_RECVDSTADDR IP_PKTINFO
+#elif defined(IP_RECVDSTADDR)
+# define UV__IP_RECVDSTADDR IP_RECVDSTADDR
+#endif
+
+/* Room for the control messages of an incoming datagram: packet info,
+ * timestamp, TOS, GRO segment size and drop count.
+ */
+#define UV__UDP_RECV_CMSG_SIZE 256
+
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__) || \
+  (defined(__sun__) && defined(MSG_WAITFORONE)) || defined(__QNX__)
+# define UV__UDP_HAVE_MMSG 1
+#endif
+
+/* Upper bound of the suggested_size for a recvmmsg() batch. Every datagram
+ * gets UV__UDP_DGRAM_MAXSIZE bytes, a batch of 1024 would ask alloc_cb for
+ * 64 MiB per wakeup. Larger buffers from alloc_cb are still used in full.
+ */
+#define UV__UDP_RECV_SUGGESTED_MAX (32 * UV__UDP_DGRAM_MAXSIZE)
+
+/* Storage for recvmmsg() and sendmmsg() batches when the handle has sizes
+ * other than the default of 20 set by uv_udp_set_mmsg_batch().
+ */
+typedef struct {
+  unsigned int recv_max;
+  unsigned int recv_min;
+  unsigned int recv_batch;  /* Changes between min and max when adaptive. */
+  unsigned int send_max;
+  int adaptive;
+#if defined(UV__UDP_HAVE_MMSG)
+  struct mmsghdr* recv_msgs;
+  struct iovec* recv_iov;
+  struct sockaddr_in6* recv_peers;
+  char (*recv_control)[UV__UDP_RECV_CMSG_SIZE];
+  struct mmsghdr* send_msgs;
+  union uv__udp_cmsg* send_cmsgs;
+  struct sockaddr** send_addrs;
+  unsigned int* send_nbufs;
+  uv_buf_t** send_bufs;
+  uv_udp_send_t** send_reqs;
+#endif
+} uv__udp_mmsg_t;
+
+
+/* Receive slots owned by the handle, set by uv_udp_set_recv_ring(). With
+ * io_uring the slots not lent out are provided to the kernel instead of
+ * being on the free stack, and each slot starts with room for the metadata
+ * of the multishot recvmsg.
+ */
+typedef struct {
+  char* slab;
+  size_t slot_size;
+  size_t stride;  /* Distance between slots. */
+  size_t offset;  /* Where the payload starts in a slot. */
+  unsigned int nslots;
+  unsigned int nfree;
+  unsigned int* free_slots;  /* Stack of the slots not lent out. */
+  unsigned int* lent;  /* Bitmap of the slots lent to the application. */
+#if defined(__linux__)
+  uv__iou_pbuf_t pbuf;
+#endif
+} uv__udp_ring_t;
+
+
+/* Handle state that doesn't fit in uv_udp_t without changing its size. It's
+ * allocated when the handle starts receiving or sending, or when one of the
+ * features that need it is turned on, and lives in the handle's `u` union.
+ */
+typedef struct {
+  unsigned int gro_segment_size;
+  uv__udp_mmsg_t* mmsg;
+  uv__udp_ring_t* recv_ring;
+  uv_udp_recv_ex_cb recv_ex_cb;
+  const uv_udp_recv_info_t* recv_info;
+  unsigned int recv_info_flags;
+  uv_udp_stats_t stats;
+} uv__udp_ext_t;
+
+#define uv__udp_ext(handle)                                                   \
+  ((uv__udp_ext_t*) (handle)->u.reserved[0])
+
+
+/* The extras of uv_udp_send_gso(), uv_udp_send_from(), uv_udp_send_at() and
+ * uv_udp_send_batch(). Plain sends don't have one. Kept in req->reserved[0]
+ * and freed when the request completes.
+ */
+typedef struct {
+  unsigned int segment_size;
+  uint64_t txtime;
+  struct sockaddr_in6 src;
+  uv_buf_t** batch_bufs;
+  unsigned int* batch_nbufs;
+  struct sockaddr** batch_addrs;
+  unsigned int batch_count;
+  unsigned int batch_sent;
+} uv__udp_send_ext_t;
+
+#define uv__udp_send_ext(req)                                                 \
+  ((uv__udp_send_ext_t*) (req)->reserved[0])
+
+
+/* Returns the handle's uv__udp_ext_t, allocating it if the handle doesn't
+ * have one yet. Freed by uv__udp_finish_close().
+ */
+static uv__udp_ext_t* uv__udp_ext_get(uv_udp_t* handle) {
+  uv__udp_ext_t* ext;
+
+  ext = uv__udp_ext(handle);
+  if (ext != NULL)
+    return ext;
+
+  ext = uv__calloc(1, sizeof(*ext));
+  if (ext == NULL)
+    return NULL;
+
+  handle->u.reserved[0] = ext;
+  return ext;
+}
+
+
+static uv__udp_ring_t* uv__udp_recv_ring(const uv_udp_t* handle) {
+  uv__udp_ext_t* ext;
+
+  ext = uv__udp_ext(handle);
+  return ext != NULL ? ext->recv_ring : NULL;
+}
+
+
+static uv__udp_mmsg_t* uv__udp_mmsg(const uv_udp_t* handle) {
+  uv__udp_ext_t* ext;
+
+  ext = uv__udp_ext(handle);
+  return ext != NULL ? ext->mmsg : NULL;
+}
+
+
+/* Whether `req` came from uv_udp_send_batch(). */
+static int uv__udp_send_is_batch(const uv_udp_send_t* req) {
+  uv__udp_send_ext_t* sext;
+
+  sext = uv__udp_send_ext(req);
+  return sext != NULL && sext->batch_count != 0;
+}
+
+
+static void uv__udp_ring_free(uv_loop_t* loop, uv__udp_ring_t* r) {
+  if (r == NULL)
+    return;
+
+#if defined(__linux__)
+  uv__iou_udp_pbuf_destroy(loop, &r->pbuf);
+#endif
+  uv__free(r->slab);
+  uv__free(r->free_slots);
+  uv__free(r->lent);
+  uv__free(r);
+}
+
+
+#define UV__UDP_LENT_BITS (8 * sizeof(unsigned int))
+
+/* Marks `slot` as lent out. Returns 0 if it already was. */
+static int uv__udp_ring_lend(uv__udp_ring_t* r, unsigned int slot) {
+  unsigned int* word;
+  unsigned int bit;
+
+  word = &r->lent[slot / UV__UDP_LENT_BITS];
+  bit = 1u << (slot % UV__UDP_LENT_BITS);
+  if (*word & bit)
+    return 0;
+
+  *word |= bit;
+  return 1;
+}
+
+
+/* Marks `slot` as back with the handle. Returns 0 if it wasn't lent out. */
+static int uv__udp_ring_unlend(uv__udp_ring_t* r, unsigned int slot) {
+  unsigned int* word;
+  unsigned int bit;
+
+  word = &r->lent[slot / UV__UDP_LENT_BITS];
+  bit = 1u << (slot % UV__UDP_LENT_BITS);
+  if (!(*word & bit))
+    return 0;
+
+  *word &= ~bit;
+  return 1;
+}
+
+
+static void uv__udp_mmsg_free(uv__udp_mmsg_t* m) {
+  if (m == NULL)
+    return;
+
+#if defined(UV__UDP_HAVE_MMSG)
+  uv__free(m->recv_msgs);
+  uv__free(m->recv_iov);
+  uv__free(m->recv_peers);
+  uv__free(m->recv_control);
+  uv__free(m->send_msgs);
+  uv__free(m->send_cmsgs);
+  uv__free(m->send_addrs);
+  uv__free(m->send_nbufs);
+  uv__free(m->send_bufs);
+  uv__free(m->send_reqs);
+#endif
+  uv__free(m);
+}
 
 
 void uv__udp_close(uv_udp_t* handle) {
+#if defined(__linux__)
+  if (uv__udp_recv_ring(handle) != NULL)
+    uv__iou_udp_cancel(handle->loop, &uv__udp_recv_ring(handle)->pbuf);
+#endif
   uv__io_close(handle->loop, &handle->io_watcher);
   uv__handle_stop(handle);
 
@@ -69,6 +310,7 @@ void uv__udp_close(uv_udp_t* handle) {
 
 void uv__udp_finish_close(uv_udp_t* handle) {
   uv_udp_send_t* req;
+  uv__udp_ext_t* ext;
   struct uv__queue* q;
 
   assert(!uv__io_active(&handle->io_watcher, POLLIN | POLLOUT));
@@ -92,6 +334,32 @@ void uv__udp_finish_close(uv_udp_t* handle) {
   handle->recv_cb = NULL;
   handle->alloc_cb = NULL;
   /* but _do not_ touch close_cb */
+
+  ext = uv__udp_ext(handle);
+  if (ext != NULL) {
+    uv__udp_mmsg_free(ext->mmsg);
+    uv__udp_ring_free(handle->loop, ext->recv_ring);
+    uv__free(ext);
+    handle->u.reserved[0] = NULL;
+  }
+}
+
+
+/* Payload bytes of a request, all of its datagrams for uv_udp_send_batch(). */
+static size_t uv__udp_send_size(const uv_udp_send_t* req) {
+  uv__udp_send_ext_t* sext;
+  unsigned int i;
+  size_t size;
+
+  if (!uv__udp_send_is_batch(req))
+    return uv__count_bufs(req->bufs, req->nbufs);
+
+  sext = uv__udp_send_ext(req);
+  size = 0;
+  for (i = 0; i < sext->batch_count; i++)
+    size += uv__count_bufs(sext->batch_bufs[i], sext->batch_nbufs[i]);
+
+  return size;
 }
 
 
@@ -109,12 +377,14 @@ static void uv__udp_run_completed(uv_udp_t* handle) {
     req = uv__queue_data(q, uv_udp_send_t, queue);
     uv__req_unregister(handle->loop);
 
-    handle->send_queue_size -= uv__count_bufs(req->bufs, req->nbufs);
+    handle->send_queue_size -= uv__udp_send_size(req);
     handle->send_queue_count--;
 
     if (req->bufs != req->bufsml)
       uv__free(req->bufs);
     req->bufs = NULL;
+    uv__free(uv__udp_send_ext(req));
+    req->reserved[0] = NULL;
 
     if (req->send_cb == NULL)
       continue;
@@ -169,7 +439,213 @@ static int uv__udp_recvmsg_errqueue(uv_udp_t* handle,
   }
   return 0;
 }
+
+
+/* Returns UV_UDP_GRO if the kernel coalesced several datagrams into the one
+ * that was just read, and records their size for
+ * uv_udp_get_gro_segment_size().
+ */
+static int uv__udp_gro_flags(uv_udp_t* handle,
+                             struct msghdr* h,
+                             ssize_t nread) {
+  struct cmsghdr* cmsg;
+  uv__udp_ext_t* ext;
+  int size;
+
+  ext = uv__udp_ext(handle);
+  ext->gro_segment_size = 0;
+  for (cmsg = CMSG_FIRSTHDR(h); cmsg != NULL; cmsg = CMSG_NXTHDR(h, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+      memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+      if (size > 0 && size < nread) {
+        ext->gro_segment_size = size;
+        return UV_UDP_GRO;
+      }
+    }
+  }
+
+  return 0;
+}
+#endif
+
+
+/* Whether the datagrams have control messages to look at. */
+static int uv__udp_want_cmsg(const uv_udp_t* handle, int flag) {
+  if (uv__udp_ext(handle)->recv_info_flags != 0)
+    return 1;
+#if defined(__linux__)
+  if ((flag & MSG_ERRQUEUE) ||
+      (handle->flags & (UV_HANDLE_UDP_GRO | UV_HANDLE_UDP_RXQ_OVFL))) {
+    return 1;
+  }
+#endif
+  return 0;
+}
+
+
+/* Accounts a received datagram, or the GRO-coalesced run of them, in the
+ * statistics of uv_udp_get_stats().
+ */
+static void uv__udp_stat_recv(uv_udp_t* handle,
+                              struct msghdr* h,
+                              size_t nread,
+                              int flags) {
+#if defined(SO_RXQ_OVFL)
+  struct cmsghdr* cmsg;
+  uint32_t drops;
 #endif
+  uv__udp_ext_t* ext;
+  size_t seg;
+
+  ext = uv__udp_ext(handle);
+  seg = ext->gro_segment_size;
+  if ((flags & UV_UDP_GRO) && seg != 0)
+    ext->stats.recv_packets += (nread + seg - 1) / seg;
+  else
+    ext->stats.recv_packets++;
+  ext->stats.recv_bytes += nread;
+
+#if defined(SO_RXQ_OVFL)
+  /* The kernel reports the socket's running total. */
+  if (!(handle->flags & UV_HANDLE_UDP_RXQ_OVFL))
+    return;
+
+  for (cmsg = CMSG_FIRSTHDR(h); cmsg != NULL; cmsg = CMSG_NXTHDR(h, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+      memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+      ext->stats.kernel_drops = drops;
+    }
+  }
+#endif
+}
+
+
+/* Accounts a sent request of `size` bytes. */
+static void uv__udp_stat_send(uv_udp_t* handle,
+                              size_t size,
+                              unsigned int segment_size) {
+  uv__udp_ext_t* ext;
+
+  ext = uv__udp_ext(handle);
+  if (segment_size != 0 && size > segment_size)
+    ext->stats.send_packets += (size + segment_size - 1) / segment_size;
+  else
+    ext->stats.send_packets++;
+  ext->stats.send_bytes += size;
+}
+
+
+/* Collects the metadata of the datagram in `h` that uv_udp_recv_start_ex()
+ * asked for and hands it to the next callback through recv_info.
+ */
+static void uv__udp_recv_info(uv_udp_t* handle,
+                              struct msghdr* h,
+                              uv_udp_recv_info_t* info) {
+  struct sockaddr_in* addr4;
+  struct cmsghdr* cmsg;
+#if defined(IP_PKTINFO)
+  struct in_pktinfo pi;
+#endif
+#if defined(IPV6_RECVPKTINFO)
+  struct sockaddr_in6* addr6;
+  struct in6_pktinfo pi6;
+#endif
+#if defined(IPV6_RECVTCLASS)
+  int tclass;
+#endif
+#if defined(SO_TIMESTAMPNS)
+  struct timespec ts;
+#elif defined(SO_TIMESTAMP)
+  struct timeval tv;
+#endif
+
+  if (uv__udp_ext(handle)->recv_ex_cb == NULL)
+    return;
+
+  memset(info, 0, sizeof(*info));
+  uv__udp_ext(handle)->recv_info = info;
+
+  for (cmsg = CMSG_FIRSTHDR(h); cmsg != NULL; cmsg = CMSG_NXTHDR(h, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_IP) {
+      addr4 = (struct sockaddr_in*) &info->local_addr;
+#if defined(IP_PKTINFO)
+      if (cmsg->cmsg_type == IP_PKTINFO) {
+        memcpy(&pi, CMSG_DATA(cmsg), sizeof(pi));
+        addr4->sin_family = AF_INET;
+        addr4->sin_addr = pi.ipi_addr;
+        info->ifindex = pi.ipi_ifindex;
+        info->flags |= UV_UDP_INFO_LOCAL_ADDR;
+      }
+#elif defined(IP_RECVDSTADDR)
+      if (cmsg->cmsg_type == IP_RECVDSTADDR) {
+        memcpy(&addr4->sin_addr, CMSG_DATA(cmsg), sizeof(addr4->sin_addr));
+        addr4->sin_family = AF_INET;
+        info->flags |= UV_UDP_INFO_LOCAL_ADDR;
+      }
+#endif
+      /* Linux reports the TOS as IP_TOS, the BSDs as IP_RECVTOS. */
+#if defined(IP_RECVTOS)
+      if (cmsg->cmsg_type == IP_TOS || cmsg->cmsg_type == IP_RECVTOS) {
+        info->tos = *(unsigned char*) CMSG_DATA(cmsg);
+        info->flags |= UV_UDP_INFO_TOS;
+      }
+#endif
+    } else if (cmsg->cmsg_level == IPPROTO_IPV6) {
+#if defined(IPV6_RECVPKTINFO)
+      if (cmsg->cmsg_type == IPV6_PKTINFO) {
+        memcpy(&pi6, CMSG_DATA(cmsg), sizeof(pi6));
+        addr6 = (struct sockaddr_in6*) &info->local_addr;
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_addr = pi6.ipi6_addr;
+        if (IN6_IS_ADDR_LINKLOCAL(&pi6.ipi6_addr))
+          addr6->sin6_scope_id = pi6.ipi6_ifindex;
+        info->ifindex = pi6.ipi6_ifindex;
+        info->flags |= UV_UDP_INFO_LOCAL_ADDR;
+      }
+#endif
+#if defined(IPV6_RECVTCLASS)
+      if (cmsg->cmsg_type == IPV6_TCLASS) {
+        memcpy(&tclass, CMSG_DATA(cmsg), sizeof(tclass));
+        info->tos = tclass;
+        info->flags |= UV_UDP_INFO_TOS;
+      }
+#endif
+    } else if (cmsg->cmsg_level == SOL_SOCKET) {
+#if defined(SO_TIMESTAMPNS)
+      if (cmsg->cmsg_type == SO_TIMESTAMPNS) {
+        memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+        info->timestamp.tv_sec = ts.tv_sec;
+        info->timestamp.tv_nsec = ts.tv_nsec;
+        info->flags |= UV_UDP_INFO_TIMESTAMP;
+      }
+#elif defined(SO_TIMESTAMP)
+      if (cmsg->cmsg_type == SCM_TIMESTAMP) {
+        memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+        info->timestamp.tv_sec = tv.tv_sec;
+        info->timestamp.tv_nsec = tv.tv_usec * 1000;
+        info->flags |= UV_UDP_INFO_TIMESTAMP;
+      }
+#endif
+    }
+  }
+}
+
+
+/* recv_cb of handles started with uv_udp_recv_start_ex(). */
+static void uv__udp_recv_ex(uv_udp_t* handle,
+                            ssize_t nread,
+                            const uv_buf_t* buf,
+                            const struct sockaddr* addr,
+                            unsigned flags) {
+  const uv_udp_recv_info_t* info;
+  uv__udp_ext_t* ext;
+
+  /* Only the datagram that the metadata was collected for gets it. */
+  ext = uv__udp_ext(handle);
+  info = ext->recv_info;
+  ext->recv_info = NULL;
+  ext->recv_ex_cb(handle, nread, buf, addr, info, flags);
+}
 
 
 void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
@@ -203,24 +679,44 @@ void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
 
 static int uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf, int flag) {
 #if defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__)
-  struct sockaddr_in6 peers[20];
-  struct iovec iov[ARRAY_SIZE(peers)];
-  struct mmsghdr msgs[ARRAY_SIZE(peers)];
+  struct sockaddr_in6 peers_buf[20];
+  struct iovec iov_buf[ARRAY_SIZE(peers_buf)];
+  struct mmsghdr msgs_buf[ARRAY_SIZE(peers_buf)];
+  char control_buf[ARRAY_SIZE(peers_buf)][UV__UDP_RECV_CMSG_SIZE];
+  struct sockaddr_in6* peers;
+  struct iovec* iov;
+  struct mmsghdr* msgs;
+  char (*control)[UV__UDP_RECV_CMSG_SIZE];
+  uv_udp_recv_info_t info;
+  uv__udp_mmsg_t* m;
   ssize_t nread;
   uv_buf_t chunk_buf;
+  size_t batch;
   size_t chunks;
   int flags;
   size_t k;
-#if defined(__linux__)
-  char control[ARRAY_SIZE(peers)][64];
-#endif
+
+  m = uv__udp_mmsg(handle);
+  if (m != NULL) {
+    peers = m->recv_peers;
+    iov = m->recv_iov;
+    msgs = m->recv_msgs;
+    control = m->recv_control;
+    batch = m->recv_batch;
+  } else {
+    peers = peers_buf;
+    iov = iov_buf;
+    msgs = msgs_buf;
+    control = control_buf;
+    batch = ARRAY_SIZE(peers_buf);
+  }
 
   /* prepare structures for recvmmsg */
   chunks = buf->len / UV__UDP_DGRAM_MAXSIZE;
   if (chunks == 0)
     return UV_EINVAL;
-  if (chunks > ARRAY_SIZE(iov))
-    chunks = ARRAY_SIZE(iov);
+  if (chunks > batch)
+    chunks = batch;
   for (k = 0; k < chunks; ++k) {
     iov[k].iov_base = buf->base + k * UV__UDP_DGRAM_MAXSIZE;
     iov[k].iov_len = UV__UDP_DGRAM_MAXSIZE;
@@ -233,12 +729,10 @@ static int uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf, int flag) {
     msgs[k].msg_hdr.msg_controllen = 0;
     msgs[k].msg_hdr.msg_flags = 0;
     msgs[k].msg_len = 0;
-#if defined(__linux__)
-    if (flag & MSG_ERRQUEUE) {
+    if (uv__udp_want_cmsg(handle, flag)) {
       msgs[k].msg_hdr.msg_control = control[k];
       msgs[k].msg_hdr.msg_controllen = sizeof(control[k]);
     }
-#endif
   }
 
 #if defined(__APPLE__)
@@ -253,12 +747,29 @@ static int uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf, int flag) {
 
   if (nread < 1) {
     /* uv__udp_recvmsg() emits the terminal callback for nread <= 0. */
-    if (nread == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+    if (nread == 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
+      uv__udp_ext(handle)->stats.recv_eagain++;
       return 0;
+    }
 
     return UV__ERR(errno);
   }
 
+  uv__udp_ext(handle)->stats.recvmmsg_calls++;
+  uv__udp_ext(handle)->stats.recvmmsg_packets += nread;
+
+  /* Grow the batch while the kernel keeps filling it, shrink it again when
+   * it's mostly empty.
+   */
+  if (m != NULL && m->adaptive) {
+    if ((size_t) nread == batch && m->recv_batch < m->recv_max)
+      m->recv_batch = m->recv_batch * 2 < m->recv_max ?
+                      m->recv_batch * 2 : m->recv_max;
+    else if ((size_t) nread <= batch / 4 && m->recv_batch > m->recv_min)
+      m->recv_batch = m->recv_batch / 2 > m->recv_min ?
+                      m->recv_batch / 2 : m->recv_min;
+  }
+
   /* pass each chunk to the application */
   for (k = 0; k < (size_t) nread && handle->recv_cb != NULL; k++) {
     flags = UV_UDP_MMSG_CHUNK;
@@ -267,12 +778,17 @@ static int uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf, int flag) {
 
     chunk_buf = uv_buf_init(iov[k].iov_base, iov[k].iov_len);
 #if defined(__linux__)
+    if (handle->flags & UV_HANDLE_UDP_GRO)
+      flags |= uv__udp_gro_flags(handle, &msgs[k].msg_hdr, msgs[k].msg_len);
+
     if ((flag & MSG_ERRQUEUE) &&
         uv__udp_recvmsg_errqueue(handle, &msgs[k].msg_hdr, &chunk_buf,
                                  (const struct sockaddr*) &peers[k], flags)) {
       continue;
     }
 #endif
+    uv__udp_stat_recv(handle, &msgs[k].msg_hdr, msgs[k].msg_len, flags);
+    uv__udp_recv_info(handle, &msgs[k].msg_hdr, &info);
     handle->recv_cb(handle,
                     msgs[k].msg_len,
                     &chunk_buf,
@@ -290,18 +806,381 @@ static int uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf, int flag) {
 #endif  /* __linux__ || ____FreeBSD__ || __APPLE__ */
 }
 
-static void uv__udp_recvmsg(uv_udp_t* handle, int flag) {
+#if defined(__linux__)
+/* Reads the error queue of a handle that receives through io_uring. The
+ * slots are with the kernel, the errors get a buffer of their own.
+ */
+static void uv__udp_recvmsg_errqueue_iou(uv_udp_t* handle) {
   struct sockaddr_storage peer;
+  char control[UV__UDP_RECV_CMSG_SIZE];
+  char data[512];
+  struct iovec iov;
   struct msghdr h;
   ssize_t nread;
   uv_buf_t buf;
+
+  do {
+    iov.iov_base = data;
+    iov.iov_len = sizeof(data);
+    memset(&h, 0, sizeof(h));
+    memset(&peer, 0, sizeof(peer));
+    h.msg_name = &peer;
+    h.msg_namelen = sizeof(peer);
+    h.msg_iov = &iov;
+    h.msg_iovlen = 1;
+    h.msg_control = control;
+    h.msg_controllen = sizeof(control);
+
+    do
+      nread = recvmsg(handle->io_watcher.fd, &h, MSG_ERRQUEUE);
+    while (nread == -1 && errno == EINTR);
+
+    if (nread == -1)
+      return;
+
+    buf = uv_buf_init(data, nread);
+    uv__udp_recvmsg_errqueue(handle, &h, &buf, (void*) &peer, 0);
+  }
+  /* recv_cb callback may decide to pause or close the handle */
+  while (handle->io_watcher.fd != -1 && handle->recv_cb != NULL);
+}
+
+
+/* Goes back to epoll for good, when the kernel turns down the multishot
+ * recvmsg or the io_uring went away in uv_loop_fork(). The slots that
+ * aren't lent out are free again, the kernel no longer fills them.
+ */
+static void uv__udp_recv_fallback(uv_udp_t* handle) {
+  uv__udp_ring_t* r;
+  unsigned int i;
+  unsigned int n;
+
+  r = uv__udp_recv_ring(handle);
+  uv__iou_udp_pbuf_destroy(handle->loop, &r->pbuf);
+
+  /* Lowest slot on top, like uv_udp_set_recv_ring() does it. */
+  n = 0;
+  for (i = r->nslots; i-- > 0;)
+    if (!(r->lent[i / UV__UDP_LENT_BITS] & (1u << (i % UV__UDP_LENT_BITS))))
+      r->free_slots[n++] = i;
+  assert(n == r->nfree);
+
+  if (handle->recv_cb != NULL)
+    uv__io_start(handle->loop, &handle->io_watcher, POLLIN);
+}
+
+
+static void uv__udp_recvmsg_iou(uv_udp_t* handle) {
+  uv__udp_ring_t* r;
+  int err;
+
+  r = uv__udp_recv_ring(handle);
+  err = uv__iou_udp_recvmsg(handle->loop, handle->io_watcher.fd, &r->pbuf);
+  if (err != 0)
+    uv__udp_recv_fallback(handle);
+}
+
+
+/* Completion of the multishot recvmsg, `h` is NULL for errors. The datagram
+ * is in slot `bid`, which is lent to recv_cb like with epoll.
+ */
+void uv__udp_recvmsg_cqe(uv_udp_t* handle,
+                         ssize_t nread,
+                         struct msghdr* h,
+                         unsigned int bid,
+                         int more) {
+  uv_udp_recv_info_t info;
+  uv__udp_ring_t* r;
+  uv_buf_t buf;
+  int flags;
+
+  r = uv__udp_recv_ring(handle);
+
+  if (h != NULL) {
+    buf = uv_buf_init(r->slab + bid * r->stride + r->offset, r->slot_size);
+    r->nfree--;
+    uv__udp_ring_lend(r, bid);
+
+    if (handle->recv_cb == NULL) {
+      uv_udp_recv_ring_release(handle, &buf);
+    } else {
+      flags = UV_UDP_RING_BUF;
+      if (h->msg_flags & MSG_TRUNC)
+        flags |= UV_UDP_PARTIAL;
+      if (handle->flags & UV_HANDLE_UDP_GRO)
+        flags |= uv__udp_gro_flags(handle, h, nread);
+
+      uv__udp_stat_recv(handle, h, nread, flags);
+      uv__udp_recv_info(handle, h, &info);
+      handle->recv_cb(handle, nread, &buf, h->msg_name, flags);
+    }
+  } else if (nread == UV_ENOBUFS) {
+    /* All slots are lent out, uv_udp_recv_ring_release() rearms. */
+  } else if (nread < 0 && handle->recv_cb != NULL) {
+    if (nread == UV_EINVAL || nread == UV_ENOTSUP) {
+      uv__udp_recv_fallback(handle);
+      return;
+    }
+
+    buf = uv_buf_init(NULL, 0);
+    handle->recv_cb(handle, nread, &buf, NULL, 0);
+  }
+
+  /* recv_cb may have stopped or closed the handle, or replaced the ring. */
+  r = uv__udp_recv_ring(handle);
+  if (!more &&
+      r != NULL &&
+      r->pbuf.ring != NULL &&
+      !r->pbuf.armed &&
+      r->nfree > 0 &&
+      handle->recv_cb != NULL &&
+      handle->io_watcher.fd != -1 &&
+      !uv__is_closing(handle)) {
+    uv__udp_recvmsg_iou(handle);
+  }
+}
+#endif
+
+
+/* Called from uv_loop_fork(). The multishot recvmsgs stayed with the
+ * parent's io_uring, the child receives with epoll from here on.
+ */
+void uv__udp_fork(uv_loop_t* loop) {
+#if defined(__linux__)
+  struct uv__queue* q;
+  uv__udp_ring_t* r;
+  uv_handle_t* h;
+
+  uv__queue_foreach(q, &loop->handle_queue) {
+    h = uv__queue_data(q, uv_handle_t, handle_queue);
+    if (h->type != UV_UDP || uv__is_closing(h))
+      continue;
+
+    r = uv__udp_recv_ring((uv_udp_t*) h);
+    if (r == NULL || r->pbuf.ring == NULL)
+      continue;
+
+    r->pbuf.armed = 0;
+    uv__udp_recv_fallback((uv_udp_t*) h);
+  }
+#endif
+}
+
+
+/* Receives straight into the handle's slots, no alloc_cb. Slots are lent to
+ * recv_cb when it gets UV_UDP_RING_BUF and come back through
+ * uv_udp_recv_ring_release(). Stops polling when all of them are lent out.
+ */
+static void uv__udp_recvmsg_ring(uv_udp_t* handle, int flag) {
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__)
+  struct sockaddr_in6 peers_buf[20];
+  struct iovec iov_buf[ARRAY_SIZE(peers_buf)];
+  struct mmsghdr msgs_buf[ARRAY_SIZE(peers_buf)];
+  char control_buf[ARRAY_SIZE(peers_buf)][UV__UDP_RECV_CMSG_SIZE];
+  struct sockaddr_in6* peers;
+  struct iovec* iov;
+  struct mmsghdr* msgs;
+  char (*control)[UV__UDP_RECV_CMSG_SIZE];
+  uv__udp_mmsg_t* m;
+#else
+  struct sockaddr_in6 peers[1];
+  struct iovec iov[1];
+  char control[1][UV__UDP_RECV_CMSG_SIZE];
+  struct msghdr hdr;
+  ssize_t len;
+#endif
+  uv_udp_recv_info_t info;
+  struct msghdr* h;
+  uv__udp_ring_t* r;
+  uv_buf_t buf;
+  ssize_t nread;
+  size_t batch;
+  size_t n;
+  size_t k;
   int flags;
   int count;
+
+  r = uv__udp_recv_ring(handle);
 #if defined(__linux__)
-  char control[256];
+  /* The datagrams come in through io_uring, POLLIN is only on to rearm it
+   * once slots came back. Errors are read here.
+   */
+  if (r->pbuf.ring != NULL) {
+    if (flag & MSG_ERRQUEUE) {
+      uv__udp_recvmsg_errqueue_iou(handle);
+    } else if (!r->pbuf.armed) {
+      uv__io_stop(handle->loop, &handle->io_watcher, POLLIN);
+      uv__udp_recvmsg_iou(handle);
+    }
+    return;
+  }
+#endif
+
+  batch = 1;
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__)
+  m = uv__udp_mmsg(handle);
+  if (m != NULL) {
+    peers = m->recv_peers;
+    iov = m->recv_iov;
+    msgs = m->recv_msgs;
+    control = m->recv_control;
+  } else {
+    peers = peers_buf;
+    iov = iov_buf;
+    msgs = msgs_buf;
+    control = control_buf;
+  }
+
+  if (uv_udp_using_recvmmsg(handle))
+    batch = m != NULL ? m->recv_batch : ARRAY_SIZE(peers_buf);
+#endif
+
+  count = 32;
+
+  do {
+    if (r->nfree == 0) {
+      /* Everything is lent out, wait for uv_udp_recv_ring_release(). */
+      uv__io_stop(handle->loop, &handle->io_watcher, POLLIN);
+      return;
+    }
+
+    n = r->nfree < batch ? r->nfree : batch;
+    for (k = 0; k < n; k++) {
+      iov[k].iov_base = r->slab +
+                        r->free_slots[r->nfree - 1 - k] * r->stride +
+                        r->offset;
+      iov[k].iov_len = r->slot_size;
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__)
+      h = &msgs[k].msg_hdr;
+      msgs[k].msg_len = 0;
+#else
+      h = &hdr;
+#endif
+      memset(h, 0, sizeof(*h));
+      h->msg_iov = iov + k;
+      h->msg_iovlen = 1;
+      h->msg_name = peers + k;
+      h->msg_namelen = sizeof(peers[0]);
+      if (uv__udp_want_cmsg(handle, flag)) {
+        h->msg_control = control[k];
+        h->msg_controllen = sizeof(control[k]);
+      }
+    }
+
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__)
+    if (uv_udp_using_recvmmsg(handle)) {
+# if defined(__APPLE__)
+      do
+        nread = recvmsg_x(handle->io_watcher.fd, msgs, n, MSG_DONTWAIT);
+      while (nread == -1 && errno == EINTR);
+# else
+      do
+        nread = recvmmsg(handle->io_watcher.fd, msgs, n, flag, NULL);
+      while (nread == -1 && errno == EINTR);
+# endif
+      if (nread > 0) {
+        uv__udp_ext(handle)->stats.recvmmsg_calls++;
+        uv__udp_ext(handle)->stats.recvmmsg_packets += nread;
+      }
+    } else {
+      do
+        nread = recvmsg(handle->io_watcher.fd, &msgs[0].msg_hdr, flag);
+      while (nread == -1 && errno == EINTR);
+
+      if (nread != -1) {
+        msgs[0].msg_len = nread;
+        nread = 1;
+      }
+    }
+#else
+    do
+      len = recvmsg(handle->io_watcher.fd, &hdr, flag);
+    while (len == -1 && errno == EINTR);
+
+    nread = len == -1 ? -1 : 1;
 #endif
 
+    if (nread == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        uv__udp_ext(handle)->stats.recv_eagain++;
+      } else {
+        buf = uv_buf_init(NULL, 0);
+        handle->recv_cb(handle, UV__ERR(errno), &buf, NULL, 0);
+      }
+      return;
+    }
+
+    /* Take the slots off the stack first, recv_cb can release others. */
+    r->nfree -= nread;
+    for (k = 0; k < (size_t) nread; k++)
+      uv__udp_ring_lend(r, r->free_slots[r->nfree + nread - 1 - k]);
+
+    for (k = 0; k < (size_t) nread; k++) {
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__)
+      h = &msgs[k].msg_hdr;
+      n = msgs[k].msg_len;
+#else
+      h = &hdr;
+      n = len;
+#endif
+      buf = uv_buf_init(iov[k].iov_base, r->slot_size);
+
+      if (handle->recv_cb == NULL) {
+        uv_udp_recv_ring_release(handle, &buf);
+        continue;
+      }
+
+      flags = UV_UDP_RING_BUF;
+      if (h->msg_flags & MSG_TRUNC)
+        flags |= UV_UDP_PARTIAL;
+#if defined(__linux__)
+      if (handle->flags & UV_HANDLE_UDP_GRO)
+        flags |= uv__udp_gro_flags(handle, h, n);
+
+      /* Errors don't lend the slot, it goes back when recv_cb returns. */
+      if ((flag & MSG_ERRQUEUE) &&
+          uv__udp_recvmsg_errqueue(handle,
+                                   h,
+                                   &buf,
+                                   (const struct sockaddr*) &peers[k],
+                                   flags & ~UV_UDP_RING_BUF)) {
+        uv_udp_recv_ring_release(handle, &buf);
+        continue;
+      }
+#endif
+      uv__udp_stat_recv(handle, h, n, flags);
+      uv__udp_recv_info(handle, h, &info);
+      handle->recv_cb(handle, n, &buf, h->msg_name, flags);
+    }
+
+    count -= nread;
+  }
+  /* recv_cb callback may decide to pause or close the handle */
+  while (count > 0
+      && handle->io_watcher.fd != -1
+      && handle->recv_cb != NULL);
+}
+
+
+static void uv__udp_recvmsg(uv_udp_t* handle, int flag) {
+  struct sockaddr_storage peer;
+  uv_udp_recv_info_t info;
+  struct msghdr h;
+  ssize_t nread;
+  uv_buf_t buf;
+  size_t size;
+  int flags;
+  int count;
+  char control[256];
+
   assert(handle->recv_cb != NULL);
+  assert(uv__udp_ext(handle) != NULL);  /* See uv__udp_recv_start(). */
+
+  if (uv__udp_recv_ring(handle) != NULL) {
+    uv__udp_recvmsg_ring(handle, flag);
+    return;
+  }
+
   assert(handle->alloc_cb != NULL);
 
   /* Prevent loop starvation when the data comes in as fast as (or faster than)
@@ -310,8 +1189,16 @@ static void uv__udp_recvmsg(uv_udp_t* handle, int flag) {
   count = 32;
 
   do {
+    /* Ask for room for the whole batch when the user picked its size. */
+    size = UV__UDP_DGRAM_MAXSIZE;
+    if (uv__udp_mmsg(handle) != NULL && uv_udp_using_recvmmsg(handle)) {
+      size *= uv__udp_mmsg(handle)->recv_batch;
+      if (size > UV__UDP_RECV_SUGGESTED_MAX)
+        size = UV__UDP_RECV_SUGGESTED_MAX;
+    }
+
     buf = uv_buf_init(NULL, 0);
-    handle->alloc_cb((uv_handle_t*) handle, UV__UDP_DGRAM_MAXSIZE, &buf);
+    handle->alloc_cb((uv_handle_t*) handle, size, &buf);
     if (buf.base == NULL || buf.len == 0) {
       handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
       return;
@@ -334,21 +1221,24 @@ static void uv__udp_recvmsg(uv_udp_t* handle, int flag) {
     h.msg_namelen = sizeof(peer);
     h.msg_iov = (void*) &buf;
     h.msg_iovlen = 1;
-#if defined(__linux__)
-    if (flag & MSG_ERRQUEUE) {
+    if (uv__udp_want_cmsg(handle, flag)) {
       h.msg_control = control;
       h.msg_controllen = sizeof(control);
     }
-#endif
 
     do
       nread = recvmsg(handle->io_watcher.fd, &h, flag);
     while (nread == -1 && errno == EINTR);
 
     flags = 0;
-    if (nread != -1)
+    if (nread != -1) {
       if (h.msg_flags & MSG_TRUNC)
         flags |= UV_UDP_PARTIAL;
+#if defined(__linux__)
+      if (handle->flags & UV_HANDLE_UDP_GRO)
+        flags |= uv__udp_gro_flags(handle, &h, nread);
+#endif
+    }
 
 #if defined(__linux__)
     if ((flag & MSG_ERRQUEUE) &&
@@ -358,12 +1248,16 @@ static void uv__udp_recvmsg(uv_udp_t* handle, int flag) {
     }
 #endif
 
-    if (nread != -1)
+    if (nread != -1) {
+      uv__udp_stat_recv(handle, &h, nread, flags);
+      uv__udp_recv_info(handle, &h, &info);
       handle->recv_cb(handle, nread, &buf, (void*) &peer, flags);
-    else if (errno == EAGAIN || errno == EWOULDBLOCK)
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      uv__udp_ext(handle)->stats.recv_eagain++;
       handle->recv_cb(handle, 0, &buf, NULL, 0);
-    else
+    } else {
       handle->recv_cb(handle, UV__ERR(errno), &buf, NULL, 0);
+    }
     count--;
   }
   /* recv_cb callback may decide to pause or close the handle */
@@ -526,6 +1420,98 @@ int uv__udp_bind(uv_udp_t* handle,
 }
 
 
+#if defined(__linux__)
+/* Steer each datagram to socket `cpu % count` of the reuseport group, cpu
+ * being the one that received it. The program is shared by the group, it
+ * doesn't matter which socket it is attached through.
+ */
+static int uv__udp_reuseport_steer_cpu(int fd, unsigned int count) {
+  struct sock_fprog prog;
+  struct sock_filter code[] = {
+    BPF_STMT(BPF_LD | BPF_W | BPF_ABS, SKF_AD_OFF + SKF_AD_CPU),
+    BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, count),
+    BPF_STMT(BPF_RET | BPF_A, 0),
+  };
+
+  prog.len = ARRAY_SIZE(code);
+  prog.filter = code;
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)))
+    return UV__ERR(errno);
+
+  return 0;
+}
+
+
+/* Undoes the bind of a group member with a fresh, unbound socket. Best effort,
+ * without one the handle creates its socket lazily like after uv_udp_init().
+ */
+static void uv__udp_reuseport_unbind(uv_udp_t* handle, int domain) {
+  int fd;
+
+  uv__close(handle->io_watcher.fd);
+  handle->io_watcher.fd = -1;
+  handle->flags &= ~(UV_HANDLE_BOUND | UV_HANDLE_IPV6);
+
+  fd = uv__socket(domain, SOCK_DGRAM, 0);
+  if (fd >= 0)
+    handle->io_watcher.fd = fd;
+}
+#endif
+
+
+int uv_udp_bind_reuseport_group(uv_udp_t* handles[],
+                                unsigned int count,
+                                const struct sockaddr* addr,
+                                unsigned int flags) {
+#if defined(__linux__)
+  struct sockaddr_storage name;
+  unsigned int i;
+  int namelen;
+  int err;
+
+  if (count == 0)
+    return UV_EINVAL;
+
+  flags |= UV_UDP_REUSEPORT;
+
+  /* The rest join the group at the address the first socket got, which
+   * matters when the caller asked for an ephemeral port.
+   */
+  err = uv_udp_bind(handles[0], addr, flags);
+  if (err)
+    return err;
+
+  namelen = sizeof(name);
+  err = uv_udp_getsockname(handles[0], (struct sockaddr*) &name, &namelen);
+  if (err) {
+    uv__udp_reuseport_unbind(handles[0], addr->sa_family);
+    return err;
+  }
+
+  /* Sockets are numbered in the group in the order they are bound. */
+  for (i = 1; i < count; i++) {
+    err = uv_udp_bind(handles[i], (const struct sockaddr*) &name, flags);
+    if (err)
+      break;
+  }
+
+  if (err == 0)
+    err = uv__udp_reuseport_steer_cpu(handles[0]->io_watcher.fd, count);
+
+  /* A group without the program spreads the datagrams over its sockets by
+   * hash. Take the `i` sockets that did get bound out of it again.
+   */
+  if (err != 0)
+    while (i > 0)
+      uv__udp_reuseport_unbind(handles[--i], addr->sa_family);
+
+  return err;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
 static int uv__udp_maybe_deferred_bind(uv_udp_t* handle,
                                        int domain,
                                        unsigned int flags) {
@@ -659,13 +1645,110 @@ int uv__udp_disconnect(uv_udp_t* handle) {
     return 0;
 }
 
+#if defined(SO_TXTIME)
+/* struct sock_txtime from <linux/net_tstamp.h>. */
+struct uv__sock_txtime {
+  clockid_t clockid;
+  uint32_t flags;
+};
+#endif
+
+
+/* Turns on SO_TXTIME the first time uv_udp_send_at() is used. The departure
+ * times are on the CLOCK_MONOTONIC clock of uv_hrtime(), which is the one
+ * the fq qdisc paces with.
+ */
+static int uv__udp_enable_txtime(uv_udp_t* handle) {
+#if defined(SO_TXTIME)
+  struct uv__sock_txtime txtime;
+
+  if (handle->flags & UV_HANDLE_UDP_TXTIME)
+    return 0;
+
+  memset(&txtime, 0, sizeof(txtime));
+  txtime.clockid = CLOCK_MONOTONIC;
+
+  if (setsockopt(handle->io_watcher.fd,
+                 SOL_SOCKET,
+                 SO_TXTIME,
+                 &txtime,
+                 sizeof(txtime))) {
+    return UV__ERR(errno);
+  }
+
+  handle->flags |= UV_HANDLE_UDP_TXTIME;
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+/* Checks the extras of a send against what the platform supports and copies
+ * them into a new uv__udp_send_ext_t, which uv__udp_prep_cmsg() turns into
+ * control messages. The handle must be bound.
+ */
+static int uv__udp_send_ext_new(uv_udp_t* handle,
+                                const uv__udp_send_opts_t* opts,
+                                uv__udp_send_ext_t** psext) {
+  uv__udp_send_ext_t* sext;
+  int err;
+
+#if !defined(UDP_SEGMENT)
+  if (opts->segment_size != 0)
+    return UV_ENOTSUP;
+#endif
+
+  /* Fail now rather than in send_cb when the source can't be set. */
+  if (opts->src_addr != NULL) {
+    switch (opts->src_addr->sa_family) {
+    case AF_INET:
+#if !defined(IP_PKTINFO) && !defined(IP_SENDSRCADDR)
+      return UV_ENOTSUP;
+#endif
+      break;
+    case AF_INET6:
+#if !defined(IPV6_RECVPKTINFO)
+      return UV_ENOTSUP;
+#endif
+      break;
+    default:
+      return UV_EINVAL;
+    }
+  }
+
+  if (opts->txtime != 0) {
+    err = uv__udp_enable_txtime(handle);
+    if (err)
+      return err;
+  }
+
+  sext = uv__calloc(1, sizeof(*sext));
+  if (sext == NULL)
+    return UV_ENOMEM;
+
+  sext->segment_size = opts->segment_size;
+  sext->txtime = opts->txtime;
+  sext->src.sin6_family = AF_UNSPEC;
+  if (opts->src_addr != NULL && opts->src_addr->sa_family == AF_INET6)
+    memcpy(&sext->src, opts->src_addr, sizeof(struct sockaddr_in6));
+  else if (opts->src_addr != NULL)
+    memcpy(&sext->src, opts->src_addr, sizeof(struct sockaddr_in));
+
+  *psext = sext;
+  return 0;
+}
+
+
 int uv__udp_send(uv_udp_send_t* req,
                  uv_udp_t* handle,
                  const uv_buf_t bufs[],
                  unsigned int nbufs,
                  const struct sockaddr* addr,
                  unsigned int addrlen,
+                 const uv__udp_send_opts_t* opts,
                  uv_udp_send_cb send_cb) {
+  uv__udp_send_ext_t* sext;
   int err;
   int empty_queue;
 
@@ -677,6 +1760,16 @@ int uv__udp_send(uv_udp_send_t* req,
       return err;
   }
 
+  if (uv__udp_ext_get(handle) == NULL)
+    return UV_ENOMEM;
+
+  sext = NULL;
+  if (opts != NULL) {
+    err = uv__udp_send_ext_new(handle, opts, &sext);
+    if (err)
+      return err;
+  }
+
   /* It's legal for send_queue_count > 0 even when the write_queue is empty;
    * it means there are error-state requests in the write_completed_queue that
    * will touch up send_queue_size/count later.
@@ -692,6 +1785,7 @@ int uv__udp_send(uv_udp_send_t* req,
   req->send_cb = send_cb;
   req->handle = handle;
   req->nbufs = nbufs;
+  req->reserved[0] = sext;
 
   req->bufs = req->bufsml;
   if (nbufs > ARRAY_SIZE(req->bufsml))
@@ -699,11 +1793,77 @@ int uv__udp_send(uv_udp_send_t* req,
 
   if (req->bufs == NULL) {
     uv__req_unregister(handle->loop);
+    uv__free(sext);
+    req->reserved[0] = NULL;
     return UV_ENOMEM;
   }
 
   memcpy(req->bufs, bufs, nbufs * sizeof(bufs[0]));
-  handle->send_queue_size += uv__count_bufs(req->bufs, req->nbufs);
+  uv__udp_send_enqueue(handle, req, empty_queue);
+
+  return 0;
+}
+
+
+int uv__udp_send_batch(uv_udp_send_t* req,
+                       uv_udp_t* handle,
+                       uv_buf_t* bufs[/*count*/],
+                       unsigned int nbufs[/*count*/],
+                       struct sockaddr* addrs[/*count*/],
+                       unsigned int count,
+                       uv_udp_send_cb send_cb) {
+  uv__udp_send_ext_t* sext;
+  unsigned int i;
+  int empty_queue;
+  int err;
+
+  for (i = 0; i < count; i++) {
+    if (addrs[i] == NULL)
+      continue;
+
+    err = uv__udp_maybe_deferred_bind(handle, addrs[i]->sa_family, 0);
+    if (err)
+      return err;
+  }
+
+  if (uv__udp_ext_get(handle) == NULL)
+    return UV_ENOMEM;
+
+  sext = uv__calloc(1, sizeof(*sext));
+  if (sext == NULL)
+    return UV_ENOMEM;
+
+  sext->src.sin6_family = AF_UNSPEC;
+  sext->batch_bufs = bufs;
+  sext->batch_nbufs = nbufs;
+  sext->batch_addrs = addrs;
+  sext->batch_count = count;
+
+  empty_queue = (handle->send_queue_count == 0);
+
+  /* The arrays are used in place, the request only keeps track of how far
+   * along the batch it is.
+   */
+  uv__req_init(handle->loop, req, UV_UDP_SEND);
+  req->u.storage.ss_family = AF_UNSPEC;
+  req->send_cb = send_cb;
+  req->handle = handle;
+  req->nbufs = 0;
+  req->bufs = req->bufsml;
+  req->status = 0;  /* First error of the batch. */
+  req->reserved[0] = sext;
+
+  uv__udp_send_enqueue(handle, req, empty_queue);
+
+  return 0;
+}
+
+
+/* Queues `req` and tries to send it right away if it's the only one. */
+static void uv__udp_send_enqueue(uv_udp_t* handle,
+                                 uv_udp_send_t* req,
+                                 int empty_queue) {
+  handle->send_queue_size += uv__udp_send_size(req);
   handle->send_queue_count++;
   uv__queue_insert_tail(&handle->write_queue, &req->queue);
   uv__handle_start(handle);
@@ -720,8 +1880,6 @@ int uv__udp_send(uv_udp_send_t* req,
   } else {
     uv__io_start(handle->loop, &handle->io_watcher, POLLOUT);
   }
-
-  return 0;
 }
 
 
@@ -730,12 +1888,16 @@ int uv__udp_try_send(uv_udp_t* handle,
                      unsigned int nbufs,
                      const struct sockaddr* addr,
                      unsigned int addrlen) {
+  size_t size;
   int err;
 
   /* already sending a message */
   if (handle->send_queue_count != 0)
     return UV_EAGAIN;
 
+  if (uv__udp_ext_get(handle) == NULL)
+    return UV_ENOMEM;
+
   if (addr) {
     err = uv__udp_maybe_deferred_bind(handle, addr->sa_family, 0);
     if (err)
@@ -744,11 +1906,16 @@ int uv__udp_try_send(uv_udp_t* handle,
     assert(handle->flags & UV_HANDLE_UDP_CONNECTED);
   }
 
-  err = uv__udp_sendmsg1(handle->io_watcher.fd, bufs, nbufs, addr);
+  err = uv__udp_sendmsg1(handle->io_watcher.fd, bufs, nbufs, addr, NULL);
+  if (err == UV_EAGAIN)
+    uv__udp_ext(handle)->stats.send_eagain++;
   if (err)
     return err;
 
-  return uv__count_bufs(bufs, nbufs);
+  size = uv__count_bufs(bufs, nbufs);
+  uv__udp_stat_send(handle, size, 0);
+
+  return size;
 }
 
 
@@ -965,6 +2132,7 @@ int uv__udp_init_ex(uv_loop_t* loop,
   handle->recv_cb = NULL;
   handle->send_queue_size = 0;
   handle->send_queue_count = 0;
+  handle->u.reserved[0] = NULL;  /* See uv__udp_ext_get(). */
   uv__io_init(&handle->io_watcher, UV__UDP_IO, fd);
   uv__queue_init(&handle->write_queue);
   uv__queue_init(&handle->write_completed_queue);
@@ -982,6 +2150,287 @@ int uv_udp_using_recvmmsg(const uv_udp_t* handle) {
 }
 
 
+size_t uv_udp_get_gro_segment_size(const uv_udp_t* handle) {
+  uv__udp_ext_t* ext;
+
+  ext = uv__udp_ext(handle);
+  return ext != NULL ? ext->gro_segment_size : 0;
+}
+
+
+int uv_udp_set_mmsg_batch(uv_udp_t* handle,
+                          unsigned int recv_batch,
+                          unsigned int send_batch,
+                          int adaptive) {
+#if defined(UV__UDP_HAVE_MMSG)
+  uv__udp_ext_t* ext;
+  uv__udp_mmsg_t* m;
+
+  /* sendmmsg() takes at most UIO_MAXIOV (1024) messages. */
+  if (recv_batch > 1024 || send_batch > 1024)
+    return UV_EINVAL;
+
+  /* The batch arrays can be in use while receiving or sending. */
+  if (uv__is_active(handle))
+    return UV_EBUSY;
+
+  ext = uv__udp_ext_get(handle);
+  if (ext == NULL)
+    return UV_ENOMEM;
+
+  uv__udp_mmsg_free(ext->mmsg);
+  ext->mmsg = NULL;
+
+  if (recv_batch == 0 && send_batch == 0 && !adaptive)
+    return 0;
+
+  if (recv_batch == 0)
+    recv_batch = 20;
+
+  if (send_batch == 0)
+    send_batch = 20;
+
+  m = uv__calloc(1, sizeof(*m));
+  if (m == NULL)
+    return UV_ENOMEM;
+
+  /* Adaptive mode starts at the default and grows from there. */
+  m->recv_max = recv_batch;
+  m->recv_min = adaptive && recv_batch > 20 ? 20 : recv_batch;
+  m->recv_batch = m->recv_min;
+  m->send_max = send_batch;
+  m->adaptive = adaptive;
+
+  m->recv_msgs = uv__calloc(recv_batch, sizeof(*m->recv_msgs));
+  m->recv_iov = uv__calloc(recv_batch, sizeof(*m->recv_iov));
+  m->recv_peers = uv__calloc(recv_batch, sizeof(*m->recv_peers));
+  m->recv_control = uv__calloc(recv_batch, sizeof(*m->recv_control));
+  m->send_msgs = uv__calloc(send_batch, sizeof(*m->send_msgs));
+  m->send_cmsgs = uv__calloc(send_batch, sizeof(*m->send_cmsgs));
+  m->send_addrs = uv__calloc(send_batch, sizeof(*m->send_addrs));
+  m->send_nbufs = uv__calloc(send_batch, sizeof(*m->send_nbufs));
+  m->send_bufs = uv__calloc(send_batch, sizeof(*m->send_bufs));
+  m->send_reqs = uv__calloc(send_batch, sizeof(*m->send_reqs));
+
+  if (m->recv_msgs == NULL ||
+      m->recv_iov == NULL ||
+      m->recv_peers == NULL ||
+      m->recv_control == NULL ||
+      m->send_msgs == NULL ||
+      m->send_cmsgs == NULL ||
+      m->send_addrs == NULL ||
+      m->send_nbufs == NULL ||
+      m->send_bufs == NULL ||
+      m->send_reqs == NULL) {
+    uv__udp_mmsg_free(m);
+    return UV_ENOMEM;
+  }
+
+  ext->mmsg = m;
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+int uv_udp_get_stats(uv_udp_t* handle, uv_udp_stats_t* stats) {
+  uv__udp_ext_t* ext;
+#if defined(SO_RXQ_OVFL)
+  int on;
+
+  /* Have the kernel report drops from now on. The count covers the whole
+   * life of the socket and shows up with the next datagram.
+   */
+  if (!(handle->flags & UV_HANDLE_UDP_RXQ_OVFL) &&
+      handle->io_watcher.fd != -1) {
+    on = 1;
+    if (setsockopt(handle->io_watcher.fd,
+                   SOL_SOCKET,
+                   SO_RXQ_OVFL,
+                   &on,
+                   sizeof(on))) {
+      return UV__ERR(errno);
+    }
+    handle->flags |= UV_HANDLE_UDP_RXQ_OVFL;
+  }
+#endif
+
+  /* Nothing was sent or received yet. */
+  ext = uv__udp_ext(handle);
+  if (ext == NULL)
+    memset(stats, 0, sizeof(*stats));
+  else
+    memcpy(stats, &ext->stats, sizeof(*stats));
+
+  return 0;
+}
+
+
+int uv_udp_set_pacing_rate(uv_udp_t* handle, uint64_t rate) {
+#if defined(SO_MAX_PACING_RATE)
+  unsigned int rate32;
+  int r;
+
+  /* Kernels before 5.0 only take 32 bits, use that when it fits. ~0U means
+   * no limit.
+   */
+  if (rate > ~0U) {
+    r = setsockopt(handle->io_watcher.fd,
+                   SOL_SOCKET,
+                   SO_MAX_PACING_RATE,
+                   &rate,
+                   sizeof(rate));
+  } else {
+    rate32 = rate == 0 ? ~0U : (unsigned int) rate;
+    r = setsockopt(handle->io_watcher.fd,
+                   SOL_SOCKET,
+                   SO_MAX_PACING_RATE,
+                   &rate32,
+                   sizeof(rate32));
+  }
+
+  if (r)
+    return UV__ERR(errno);
+
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+int uv_udp_set_recv_ring(uv_udp_t* handle,
+                         unsigned int nslots,
+                         size_t slot_size) {
+  uv__udp_ext_t* ext;
+  uv__udp_ring_t* r;
+  unsigned int i;
+
+  if (slot_size == 0)
+    slot_size = UV__UDP_DGRAM_MAXSIZE;
+
+  if (slot_size > SIZE_MAX / 2)
+    return UV_EINVAL;
+
+  /* Can't swap the slots out from under recv_cb or the application. */
+  r = uv__udp_recv_ring(handle);
+  if (handle->recv_cb != NULL || (r != NULL && r->nfree != r->nslots))
+    return UV_EBUSY;
+
+  ext = uv__udp_ext_get(handle);
+  if (ext == NULL)
+    return UV_ENOMEM;
+
+  uv__udp_ring_free(handle->loop, r);
+  ext->recv_ring = NULL;
+
+  if (nslots == 0)
+    return 0;
+
+  r = uv__calloc(1, sizeof(*r));
+  if (r == NULL)
+    return UV_ENOMEM;
+
+#if defined(__linux__)
+  /* Best effort, reads go through epoll and recvmsg() without io_uring. */
+  if (uv__iou_udp_pbuf_init(handle->loop,
+                            &r->pbuf,
+                            nslots,
+                            UV__UDP_RECV_CMSG_SIZE) == 0) {
+    r->offset = r->pbuf.hdrlen;
+  }
+#endif
+
+  /* Keep the slots aligned for the control messages in front. */
+  r->stride = (r->offset + slot_size + 15) & ~(size_t) 15;
+  if (r->stride > SIZE_MAX / nslots) {
+    uv__udp_ring_free(handle->loop, r);
+    return UV_EINVAL;
+  }
+
+  r->slab = uv__malloc(nslots * r->stride);
+  r->free_slots = uv__malloc(nslots * sizeof(*r->free_slots));
+  r->lent = uv__calloc((nslots + UV__UDP_LENT_BITS - 1) / UV__UDP_LENT_BITS,
+                       sizeof(*r->lent));
+  if (r->slab == NULL || r->free_slots == NULL || r->lent == NULL) {
+    uv__udp_ring_free(handle->loop, r);
+    return UV_ENOMEM;
+  }
+
+  /* Hand out the low slots first. */
+  for (i = 0; i < nslots; i++)
+    r->free_slots[i] = nslots - 1 - i;
+
+  r->slot_size = slot_size;
+  r->nslots = nslots;
+  r->nfree = nslots;
+  ext->recv_ring = r;
+
+#if defined(__linux__)
+  if (r->pbuf.ring != NULL) {
+    r->pbuf.handle = handle;
+    r->pbuf.base = r->slab;
+    r->pbuf.stride = r->stride;
+    r->pbuf.size = r->offset + slot_size;
+    for (i = 0; i < nslots; i++)
+      uv__iou_udp_pbuf_put(&r->pbuf, i);
+  }
+#endif
+
+  return 0;
+}
+
+
+int uv_udp_recv_ring_release(uv_udp_t* handle, const uv_buf_t* buf) {
+  uv__udp_ring_t* r;
+  size_t offset;
+
+  r = uv__udp_recv_ring(handle);
+  if (r == NULL || buf->base < r->slab)
+    return UV_EINVAL;
+
+  offset = buf->base - r->slab;
+  if (offset % r->stride != r->offset || offset / r->stride >= r->nslots)
+    return UV_EINVAL;
+
+  /* Not lent out, or released twice. */
+  if (!uv__udp_ring_unlend(r, offset / r->stride))
+    return UV_EINVAL;
+
+#if defined(__linux__)
+  if (r->pbuf.ring != NULL) {
+    r->nfree++;
+    uv__iou_udp_pbuf_put(&r->pbuf, offset / r->stride);
+
+    /* The multishot recvmsg ran out of buffers. Rearm it from the next
+     * poll, not for every slot the application hands back.
+     */
+    if (!r->pbuf.armed &&
+        handle->recv_cb != NULL &&
+        handle->io_watcher.fd != -1 &&
+        !uv__is_closing(handle)) {
+      uv__io_start(handle->loop, &handle->io_watcher, POLLIN);
+    }
+
+    return 0;
+  }
+#endif
+
+  r->free_slots[r->nfree++] = offset / r->stride;
+
+  /* Resume reading if it stopped for want of a slot. */
+  if (r->nfree == 1 &&
+      handle->recv_cb != NULL &&
+      handle->io_watcher.fd != -1 &&
+      !uv__is_closing(handle)) {
+    uv__io_start(handle->loop, &handle->io_watcher, POLLIN);
+  }
+
+  return 0;
+}
+
+
 int uv_udp_open_ex(uv_udp_t* handle, uv_os_sock_t sock, unsigned int flags) {
   int err;
 
@@ -1315,19 +2764,48 @@ int uv__udp_recv_start(uv_udp_t* handle,
                        uv_udp_recv_cb recv_cb) {
   int err;
 
-  if (alloc_cb == NULL || recv_cb == NULL)
+  /* The receive ring replaces alloc_cb. */
+  if ((alloc_cb == NULL && uv__udp_recv_ring(handle) == NULL) ||
+      recv_cb == NULL) {
     return UV_EINVAL;
+  }
 
-  if (uv__io_active(&handle->io_watcher, POLLIN))
+  /* POLLIN is also off while a receive ring waits for a slot. */
+  if (uv__io_active(&handle->io_watcher, POLLIN) || handle->recv_cb != NULL)
     return UV_EALREADY;  /* FIXME(bnoordhuis) Should be UV_EBUSY. */
 
+  if (uv__udp_ext_get(handle) == NULL)
+    return UV_ENOMEM;
+
   err = uv__udp_maybe_deferred_bind(handle, AF_INET, 0);
   if (err)
     return err;
 
+#if defined(__linux__)
+  /* Best effort, without it the datagrams just don't get coalesced. */
+  if (handle->flags & UV_HANDLE_UDP_GRO) {
+    int on = 1;
+    setsockopt(handle->io_watcher.fd, IPPROTO_UDP, UDP_GRO, &on, sizeof(on));
+  }
+#endif
+
   handle->alloc_cb = alloc_cb;
   handle->recv_cb = recv_cb;
 
+#if defined(__linux__)
+  if (uv__udp_recv_ring(handle) != NULL &&
+      uv__udp_recv_ring(handle)->pbuf.ring != NULL) {
+    err = uv__iou_udp_recvmsg(handle->loop,
+                              handle->io_watcher.fd,
+                              &uv__udp_recv_ring(handle)->pbuf);
+    if (err != 0)
+      uv__udp_recv_fallback(handle);
+
+    uv__handle_start(handle);
+    return 0;
+  }
+#endif
+
   uv__io_start(handle->loop, &handle->io_watcher, POLLIN);
   uv__handle_start(handle);
 
@@ -1336,6 +2814,12 @@ int uv__udp_recv_start(uv_udp_t* handle,
 
 
 int uv__udp_recv_stop(uv_udp_t* handle) {
+  uv__udp_ext_t* ext;
+
+#if defined(__linux__)
+  if (uv__udp_recv_ring(handle) != NULL)
+    uv__iou_udp_cancel(handle->loop, &uv__udp_recv_ring(handle)->pbuf);
+#endif
   uv__io_stop(handle->loop, &handle->io_watcher, POLLIN);
 
   if (!uv__io_active(&handle->io_watcher, POLLOUT))
@@ -1344,6 +2828,215 @@ int uv__udp_recv_stop(uv_udp_t* handle) {
   handle->alloc_cb = NULL;
   handle->recv_cb = NULL;
 
+  ext = uv__udp_ext(handle);
+  if (ext != NULL) {
+    ext->recv_ex_cb = NULL;
+    ext->recv_info_flags = 0;
+  }
+
+  return 0;
+}
+
+
+int uv_udp_recv_start_ex(uv_udp_t* handle,
+                         uv_alloc_cb alloc_cb,
+                         uv_udp_recv_ex_cb recv_cb,
+                         unsigned int info_flags) {
+  uv__udp_ext_t* ext;
+  int on;
+  int err;
+
+  if (handle->type != UV_UDP || recv_cb == NULL)
+    return UV_EINVAL;
+
+  if (info_flags & ~(UV_UDP_INFO_LOCAL_ADDR |
+                     UV_UDP_INFO_TIMESTAMP |
+                     UV_UDP_INFO_TOS)) {
+    return UV_EINVAL;
+  }
+
+  if (uv__io_active(&handle->io_watcher, POLLIN) || handle->recv_cb != NULL)
+    return UV_EALREADY;
+
+  ext = uv__udp_ext_get(handle);
+  if (ext == NULL)
+    return UV_ENOMEM;
+
+  /* The options are per address family, so bind first. */
+  err = uv__udp_maybe_deferred_bind(handle, AF_INET, 0);
+  if (err)
+    return err;
+
+  on = 1;
+  if (info_flags & UV_UDP_INFO_LOCAL_ADDR) {
+#if defined(UV__IP_RECVDSTADDR) && defined(IPV6_RECVPKTINFO)
+    err = uv__setsockopt(handle,
+                         UV__IP_RECVDSTADDR,
+                         IPV6_RECVPKTINFO,
+                         &on,
+                         sizeof(on));
+#else
+    err = UV_ENOTSUP;
+#endif
+    if (err)
+      return err;
+  }
+
+  if (info_flags & UV_UDP_INFO_TIMESTAMP) {
+#if defined(SO_TIMESTAMPNS)
+    if (setsockopt(handle->io_watcher.fd,
+                   SOL_SOCKET,
+                   SO_TIMESTAMPNS,
+                   &on,
+                   sizeof(on))) {
+      return UV__ERR(errno);
+    }
+#elif defined(SO_TIMESTAMP)
+    if (setsockopt(handle->io_watcher.fd,
+                   SOL_SOCKET,
+                   SO_TIMESTAMP,
+                   &on,
+                   sizeof(on))) {
+      return UV__ERR(errno);
+    }
+#else
+    return UV_ENOTSUP;
+#endif
+  }
+
+  if (info_flags & UV_UDP_INFO_TOS) {
+#if defined(IP_RECVTOS) && defined(IPV6_RECVTCLASS)
+    err = uv__setsockopt(handle, IP_RECVTOS, IPV6_RECVTCLASS, &on, sizeof(on));
+#else
+    err = UV_ENOTSUP;
+#endif
+    if (err)
+      return err;
+  }
+
+  ext->recv_ex_cb = recv_cb;
+  ext->recv_info_flags = info_flags;
+
+  err = uv__udp_recv_start(handle, alloc_cb, uv__udp_recv_ex);
+  if (err) {
+    ext->recv_ex_cb = NULL;
+    ext->recv_info_flags = 0;
+  }
+
+  return err;
+}
+
+
+/* Appends a control message to the ones `h` already has. */
+static void uv__udp_cmsg_add(struct msghdr* h,
+                             int level,
+                             int type,
+                             const void* data,
+                             size_t len) {
+  struct cmsghdr* c;
+
+  assert(h->msg_controllen + CMSG_SPACE(len) <= sizeof(union uv__udp_cmsg));
+  c = (struct cmsghdr*) ((char*) h->msg_control + h->msg_controllen);
+  c->cmsg_level = level;
+  c->cmsg_type = type;
+  c->cmsg_len = CMSG_LEN(len);
+  memcpy(CMSG_DATA(c), data, len);
+  h->msg_controllen += CMSG_SPACE(len);
+}
+
+
+/* Sends the datagram from `src` instead of the address the routing table
+ * picks, the counterpart of UV_UDP_INFO_LOCAL_ADDR.
+ */
+static int uv__udp_cmsg_src(struct msghdr* h, const struct sockaddr* src) {
+  const struct sockaddr_in* src4;
+#if defined(IP_PKTINFO)
+  struct in_pktinfo pi;
+#endif
+#if defined(IPV6_RECVPKTINFO)
+  const struct sockaddr_in6* src6;
+  struct in6_pktinfo pi6;
+#endif
+
+  switch (src->sa_family) {
+  case AF_INET:
+    src4 = (const struct sockaddr_in*) src;
+#if defined(IP_PKTINFO)
+    memset(&pi, 0, sizeof(pi));
+    pi.ipi_spec_dst = src4->sin_addr;
+    uv__udp_cmsg_add(h, IPPROTO_IP, IP_PKTINFO, &pi, sizeof(pi));
+    return 0;
+#elif defined(IP_SENDSRCADDR)
+    uv__udp_cmsg_add(h,
+                     IPPROTO_IP,
+                     IP_SENDSRCADDR,
+                     &src4->sin_addr,
+                     sizeof(src4->sin_addr));
+    return 0;
+#else
+    (void) src4;
+    return UV_ENOTSUP;
+#endif
+  case AF_INET6:
+#if defined(IPV6_RECVPKTINFO)
+    src6 = (const struct sockaddr_in6*) src;
+    memset(&pi6, 0, sizeof(pi6));
+    pi6.ipi6_addr = src6->sin6_addr;
+    pi6.ipi6_ifindex = src6->sin6_scope_id;
+    uv__udp_cmsg_add(h, IPPROTO_IPV6, IPV6_PKTINFO, &pi6, sizeof(pi6));
+    return 0;
+#else
+    return UV_ENOTSUP;
+#endif
+  }
+
+  return UV_EINVAL;
+}
+
+
+/* Control messages for the extras of uv_udp_send_gso(), uv_udp_send_from()
+ * and uv_udp_send_at().
+ */
+static int uv__udp_prep_cmsg(struct msghdr* h,
+                             const uv_udp_send_t* req,
+                             union uv__udp_cmsg* cmsg) {
+  uv__udp_send_ext_t* sext;
+#if defined(UDP_SEGMENT)
+  uint16_t gso_size;
+#endif
+
+  sext = uv__udp_send_ext(req);
+  if (sext == NULL ||
+      (sext->segment_size == 0 &&
+       sext->txtime == 0 &&
+       sext->src.sin6_family == AF_UNSPEC)) {
+    return 0;
+  }
+
+  memset(cmsg, 0, sizeof(*cmsg));
+  h->msg_control = cmsg;
+
+#if defined(UDP_SEGMENT)
+  /* Let the kernel cut the payload into datagrams of segment_size bytes. */
+  if (sext->segment_size != 0) {
+    gso_size = sext->segment_size;
+    uv__udp_cmsg_add(h, IPPROTO_UDP, UDP_SEGMENT, &gso_size, sizeof(gso_size));
+  }
+#endif
+
+#if defined(SO_TXTIME)
+  /* Earliest departure time, the fq qdisc holds the packet until then. */
+  if (sext->txtime != 0)
+    uv__udp_cmsg_add(h,
+                     SOL_SOCKET,
+                     SCM_TXTIME,
+                     &sext->txtime,
+                     sizeof(sext->txtime));
+#endif
+
+  if (sext->src.sin6_family != AF_UNSPEC)
+    return uv__udp_cmsg_src(h, (const struct sockaddr*) &sext->src);
+
   return 0;
 }
 
@@ -1351,11 +3044,20 @@ int uv__udp_recv_stop(uv_udp_t* handle) {
 static int uv__udp_prep_pkt(struct msghdr* h,
                             const uv_buf_t* bufs,
                             const unsigned int nbufs,
-                            const struct sockaddr* addr) {
+                            const struct sockaddr* addr,
+                            const uv_udp_send_t* req,
+                            union uv__udp_cmsg* cmsg) {
+  int r;
+
   memset(h, 0, sizeof(*h));
   h->msg_name = (void*) addr;
   h->msg_iov = (void*) bufs;
   h->msg_iovlen = nbufs;
+
+  /* uv_udp_try_send() passes no request. */
+  if (req != NULL && (r = uv__udp_prep_cmsg(h, req, cmsg)))
+    return r;
+
   if (addr == NULL)
     return 0;
   switch (addr->sa_family) {
@@ -1379,11 +3081,13 @@ static int uv__udp_prep_pkt(struct msghdr* h,
 static int uv__udp_sendmsg1(int fd,
                             const uv_buf_t* bufs,
                             unsigned int nbufs,
-                            const struct sockaddr* addr) {
+                            const struct sockaddr* addr,
+                            const uv_udp_send_t* req) {
+  union uv__udp_cmsg cmsg;
   struct msghdr h;
   int r;
 
-  if ((r = uv__udp_prep_pkt(&h, bufs, nbufs, addr)))
+  if ((r = uv__udp_prep_pkt(&h, bufs, nbufs, addr, req, &cmsg)))
     return r;
 
   do
@@ -1408,7 +3112,9 @@ static int uv__udp_sendmsgv(int fd,
                             unsigned int count,
                             uv_buf_t* bufs[/*count*/],
                             unsigned int nbufs[/*count*/],
-                            struct sockaddr* addrs[/*count*/]) {
+                            struct sockaddr* addrs[/*count*/],
+                            uv_udp_send_t* reqs[/*count*/],
+                            uv__udp_mmsg_t* mmsg) {
   unsigned int i;
   int nsent;
   int r;
@@ -1416,15 +3122,32 @@ static int uv__udp_sendmsgv(int fd,
   r = 0;
   nsent = 0;
 
-#if defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__) || \
-  (defined(__sun__) && defined(MSG_WAITFORONE)) || defined(__QNX__)
+#if defined(UV__UDP_HAVE_MMSG)
   if (count > 1) {
-    for (i = 0; i < count; /*empty*/) {
-      struct mmsghdr m[20];
-      unsigned int n;
+    union uv__udp_cmsg cmsgs_buf[20];
+    struct mmsghdr m_buf[ARRAY_SIZE(cmsgs_buf)];
+    union uv__udp_cmsg* cmsgs;
+    struct mmsghdr* m;
+    unsigned int max;
+    unsigned int n;
+
+    cmsgs = cmsgs_buf;
+    m = m_buf;
+    max = ARRAY_SIZE(m_buf);
+    if (mmsg != NULL) {
+      cmsgs = mmsg->send_cmsgs;
+      m = mmsg->send_msgs;
+      max = mmsg->send_max;
+    }
 
-      for (n = 0; i < count && n < ARRAY_SIZE(m); i++, n++)
-        if ((r = uv__udp_prep_pkt(&m[n].msg_hdr, bufs[i], nbufs[i], addrs[i])))
+    for (i = 0; i < count; /*empty*/) {
+      for (n = 0; i < count && n < max; i++, n++)
+        if ((r = uv__udp_prep_pkt(&m[n].msg_hdr,
+                                  bufs[i],
+                                  nbufs[i],
+                                  addrs[i],
+                                  reqs ? reqs[i] : NULL,
+                                  &cmsgs[n])))
           goto exit;
 
       do
@@ -1438,18 +3161,22 @@ static int uv__udp_sendmsgv(int fd,
       if (r < 1)
         goto exit;
 
+      /* The loop above already moved past the whole batch. */
       nsent += r;
-      i += r;
+      if ((unsigned int) r < n)
+        goto exit;
     }
 
     goto exit;
   }
-#endif  /* defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__) ||
-	 * (defined(__sun__) && defined(MSG_WAITFORONE)) || defined(__QNX__)
-	 */
+#endif  /* defined(UV__UDP_HAVE_MMSG) */
 
   for (i = 0; i < count; i++, nsent++)
-    if ((r = uv__udp_sendmsg1(fd, bufs[i], nbufs[i], addrs[i])))
+    if ((r = uv__udp_sendmsg1(fd,
+                              bufs[i],
+                              nbufs[i],
+                              addrs[i],
+                              reqs ? reqs[i] : NULL)))
       goto exit;  /* goto to avoid unused label warning. */
 
 exit:
@@ -1469,36 +3196,101 @@ exit:
 
 static void uv__udp_sendmsg(uv_udp_t* handle) {
   enum { N = 20 };
-  struct sockaddr* addrs[N];
-  unsigned int nbufs[N];
-  uv_buf_t* bufs[N];
+  struct sockaddr* addrs_buf[N];
+  uv_udp_send_t* reqs_buf[N];
+  unsigned int nbufs_buf[N];
+  uv_buf_t* bufs_buf[N];
+  struct sockaddr** addrs;
+  uv_udp_send_t** reqs;
+  unsigned int* nbufs;
+  uv_buf_t** bufs;
+  uv__udp_send_ext_t* sext;
+  uv__udp_mmsg_t* mmsg;
   struct uv__queue* q;
   uv_udp_send_t* req;
+  unsigned int i;
+  int max;
   int n;
 
   if (uv__queue_empty(&handle->write_queue))
     return;
 
+  addrs = addrs_buf;
+  reqs = reqs_buf;
+  nbufs = nbufs_buf;
+  bufs = bufs_buf;
+  max = N;
+
+  mmsg = uv__udp_mmsg(handle);
+
+#if defined(UV__UDP_HAVE_MMSG)
+  if (mmsg != NULL) {
+    addrs = mmsg->send_addrs;
+    reqs = mmsg->send_reqs;
+    nbufs = mmsg->send_nbufs;
+    bufs = mmsg->send_bufs;
+    max = mmsg->send_max;
+  }
+#endif
+
 again:
   n = 0;
   q = uv__queue_head(&handle->write_queue);
   do {
     req = uv__queue_data(q, uv_udp_send_t, queue);
-    addrs[n] = &req->u.addr;
-    nbufs[n] = req->nbufs;
-    bufs[n] = req->bufs;
+    if (!uv__udp_send_is_batch(req)) {
+      addrs[n] = &req->u.addr;
+      nbufs[n] = req->nbufs;
+      bufs[n] = req->bufs;
+      reqs[n] = req;
+      n++;
+    } else {
+      /* Picks up where the previous round left off. */
+      sext = uv__udp_send_ext(req);
+      for (i = sext->batch_sent; i < sext->batch_count && n < max; i++, n++) {
+        addrs[n] = sext->batch_addrs[i];
+        nbufs[n] = sext->batch_nbufs[i];
+        bufs[n] = sext->batch_bufs[i];
+        reqs[n] = req;
+      }
+    }
     q = uv__queue_next(q);
-    n++;
-  } while (n < N && q != &handle->write_queue);
-
-  n = uv__udp_sendmsgv(handle->io_watcher.fd, n, bufs, nbufs, addrs);
+  } while (n < max && q != &handle->write_queue);
+
+  n = uv__udp_sendmsgv(handle->io_watcher.fd,
+                       n,
+                       bufs,
+                       nbufs,
+                       addrs,
+                       reqs,
+                       mmsg);
   while (n > 0) {
     q = uv__queue_head(&handle->write_queue);
     req = uv__queue_data(q, uv_udp_send_t, queue);
-    req->status = uv__count_bufs(req->bufs, req->nbufs);
+    sext = uv__udp_send_ext(req);
+
+    if (uv__udp_send_is_batch(req)) {
+      for (; n > 0 && sext->batch_sent < sext->batch_count; n--) {
+        i = sext->batch_sent++;
+        uv__udp_stat_send(handle,
+                          uv__count_bufs(sext->batch_bufs[i],
+                                         sext->batch_nbufs[i]),
+                          0);
+      }
+
+      /* Partially sent, the rest goes out in the next round. */
+      if (sext->batch_sent < sext->batch_count)
+        break;
+    } else {
+      req->status = uv__count_bufs(req->bufs, req->nbufs);
+      uv__udp_stat_send(handle,
+                        req->status,
+                        sext != NULL ? sext->segment_size : 0);
+      n--;
+    }
+
     uv__queue_remove(&req->queue);
     uv__queue_insert_tail(&handle->write_completed_queue, &req->queue);
-    n--;
   }
 
   if (n == 0) {
@@ -1507,8 +3299,10 @@ again:
     goto again;
   }
 
-  if (n == UV_EAGAIN)
+  if (n == UV_EAGAIN) {
+    uv__udp_ext(handle)->stats.send_eagain++;
     return;
+  }
 
   /* Register the error against first request in queue because that
    * is the request that uv__udp_sendmsgv tried but failed to send,
@@ -1516,7 +3310,18 @@ again:
    */
   q = uv__queue_head(&handle->write_queue);
   req = uv__queue_data(q, uv_udp_send_t, queue);
-  req->status = n;
+
+  /* A batch reports its first error but still sends the other datagrams. */
+  if (uv__udp_send_is_batch(req)) {
+    sext = uv__udp_send_ext(req);
+    if (req->status == 0)
+      req->status = n;
+    if (++sext->batch_sent < sext->batch_count)
+      goto again;
+  } else {
+    req->status = n;
+  }
+
   uv__queue_remove(&req->queue);
   uv__queue_insert_tail(&handle->write_completed_queue, &req->queue);
 feed:
@@ -1530,10 +3335,22 @@ int uv__udp_try_send2(uv_udp_t* handle,
                       unsigned int nbufs[/*count*/],
                       struct sockaddr* addrs[/*count*/]) {
   int fd;
+  int i;
+  int r;
 
   fd = handle->io_watcher.fd;
   if (fd == -1)
     return UV_EINVAL;
 
-  return uv__udp_sendmsgv(fd, count, bufs, nbufs, addrs);
+  if (uv__udp_ext_get(handle) == NULL)
+    return UV_ENOMEM;
+
+  r = uv__udp_sendmsgv(fd, count, bufs, nbufs, addrs, NULL, NULL);
+  if (r == UV_EAGAIN)
+    uv__udp_ext(handle)->stats.send_eagain++;
+
+  for (i = 0; i < r; i++)
+    uv__udp_stat_send(handle, uv__count_bufs(bufs[i], nbufs[i]), 0);
+
+  return r;
 }
@@ -358,14 +358,17 @@ int uv_udp_init_ex(uv_loop_t* loop, uv_udp_t* handle, unsigned flags) {
 
   /* Use the higher bits for extra flags. */
   extra_flags = flags & ~0xFF;
-  if (extra_flags & ~UV_UDP_RECVMMSG)
+  if (extra_flags & ~(UV_UDP_RECVMMSG | UV_UDP_GRO))
     return UV_EINVAL;
 
   rc = uv__udp_init_ex(loop, handle, flags, domain);
 
-  if (rc == 0)
+  if (rc == 0) {
     if (extra_flags & UV_UDP_RECVMMSG)
       handle->flags |= UV_HANDLE_UDP_RECVMMSG;
+    if (extra_flags & UV_UDP_GRO)
+      handle->flags |= UV_HANDLE_UDP_GRO;
+  }
 
   return rc;
 }
@@ -399,11 +402,23 @@ int uv_tcp_connect(uv_connect_t* req,
                    uv_tcp_t* handle,
                    const struct sockaddr* addr,
                    uv_connect_cb cb) {
+  return uv_tcp_connect2(req, handle, addr, 0, cb);
+}
+
+
+int uv_tcp_connect2(uv_connect_t* req,
+                    uv_tcp_t* handle,
+                    const struct sockaddr* addr,
+                    unsigned int flags,
+                    uv_connect_cb cb) {
   unsigned int addrlen;
 
   if (handle->type != UV_TCP)
     return UV_EINVAL;
 
+  if (flags & ~UV_TCP_FASTOPEN)
+    return UV_EINVAL;
+
   if (addr->sa_family == AF_INET)
     addrlen = sizeof(struct sockaddr_in);
   else if (addr->sa_family == AF_INET6)
@@ -411,7 +426,7 @@ int uv_tcp_connect(uv_connect_t* req,
   else
     return UV_EINVAL;
 
-  return uv__tcp_connect(req, handle, addr, addrlen, cb);
+  return uv__tcp_connect(req, handle, addr, addrlen, flags, cb);
 }
 
 
@@ -509,7 +524,111 @@ int uv_udp_send(uv_udp_send_t* req,
   if (addrlen < 0)
     return addrlen;
 
-  return uv__udp_send(req, handle, bufs, nbufs, addr, addrlen, send_cb);
+  return uv__udp_send(req, handle, bufs, nbufs, addr, addrlen, NULL, send_cb);
+}
+
+
+int uv_udp_send_gso(uv_udp_send_t* req,
+                    uv_udp_t* handle,
+                    const uv_buf_t bufs[],
+                    unsigned int nbufs,
+                    const struct sockaddr* addr,
+                    unsigned int segment_size,
+                    uv_udp_send_cb send_cb) {
+  uv__udp_send_opts_t opts;
+  int addrlen;
+
+  /* The kernel takes the segment size as a 16 bits value. */
+  if (segment_size == 0 || segment_size > 65535)
+    return UV_EINVAL;
+
+  addrlen = uv__udp_check_before_send(handle, bufs, nbufs, addr);
+  if (addrlen < 0)
+    return addrlen;
+
+  memset(&opts, 0, sizeof(opts));
+  opts.segment_size = segment_size;
+
+  return uv__udp_send(req, handle, bufs, nbufs, addr, addrlen, &opts, send_cb);
+}
+
+
+int uv_udp_send_from(uv_udp_send_t* req,
+                     uv_udp_t* handle,
+                     const uv_buf_t bufs[],
+                     unsigned int nbufs,
+                     const struct sockaddr* addr,
+                     const struct sockaddr* src_addr,
+                     uv_udp_send_cb send_cb) {
+  uv__udp_send_opts_t opts;
+  int addrlen;
+
+  if (src_addr == NULL)
+    return UV_EINVAL;
+
+  if (src_addr->sa_family != AF_INET && src_addr->sa_family != AF_INET6)
+    return UV_EINVAL;
+
+  addrlen = uv__udp_check_before_send(handle, bufs, nbufs, addr);
+  if (addrlen < 0)
+    return addrlen;
+
+  memset(&opts, 0, sizeof(opts));
+  opts.src_addr = src_addr;
+
+  return uv__udp_send(req, handle, bufs, nbufs, addr, addrlen, &opts, send_cb);
+}
+
+
+int uv_udp_send_at(uv_udp_send_t* req,
+                   uv_udp_t* handle,
+                   const uv_buf_t bufs[],
+                   unsigned int nbufs,
+                   const struct sockaddr* addr,
+                   uint64_t txtime,
+                   uv_udp_send_cb send_cb) {
+  uv__udp_send_opts_t opts;
+  int addrlen;
+
+  addrlen = uv__udp_check_before_send(handle, bufs, nbufs, addr);
+  if (addrlen < 0)
+    return addrlen;
+
+  /* 0 means now, which is what a plain send does. */
+  memset(&opts, 0, sizeof(opts));
+  opts.txtime = txtime;
+
+  return uv__udp_send(req,
+                      handle,
+                      bufs,
+                      nbufs,
+                      addr,
+                      addrlen,
+                      txtime != 0 ? &opts : NULL,
+                      send_cb);
+}
+
+
+int uv_udp_send_batch(uv_udp_send_t* req,
+                      uv_udp_t* handle,
+                      uv_buf_t* bufs[/*count*/],
+                      unsigned int nbufs[/*count*/],
+                      struct sockaddr* addrs[/*count*/],
+                      unsigned int count,
+                      uv_udp_send_cb send_cb) {
+  unsigned int i;
+  int addrlen;
+
+  if (count < 1)
+    return UV_EINVAL;
+
+  for (i = 0; i < count; i++) {
+    addrlen = uv__udp_check_before_send(handle, bufs[i], nbufs[i], addrs[i]);
+    if (addrlen < 0)
+      return addrlen;
+  }
+
+  return uv__udp_send_batch(req, handle, bufs, nbufs, addrs, count, send_cb);
 }
 
 
@@ -558,7 +677,8 @@ int uv_udp_try_send2(uv_udp_t* handle,
 int uv_udp_recv_start(uv_udp_t* handle,
                       uv_alloc_cb alloc_cb,
                       uv_udp_recv_cb recv_cb) {
-  if (handle->type != UV_UDP || alloc_cb == NULL || recv_cb == NULL)
+  /* alloc_cb is optional when the handle has a receive ring. */
+  if (handle->type != UV_UDP || recv_cb == NULL)
     return UV_EINVAL;
   else
     return uv__udp_recv_start(handle, alloc_cb, recv_cb);
@@ -69,9 +69,26 @@ extern int snprintf(char*, size_t, const char*, ...);
 #ifdef _MSC_VER
 #define uv__exchange_int_relaxed(p, v)                                        \
   InterlockedExchangeNoFence((LONG volatile*)(p), v)
+#define uv__load_int_relaxed(p)                                               \
+  InterlockedOrNoFence((LONG volatile*)(p), 0)
 #else
 #define uv__exchange_int_relaxed(p, v)                                        \
   atomic_exchange_explicit((_Atomic int*)(p), v, memory_order_relaxed)
+#define uv__load_int_relaxed(p)                                               \
+  atomic_load_explicit((_Atomic int*)(p), memory_order_relaxed)
+#endif
+
+#ifdef _MSC_VER
+# ifdef _WIN64
+#  define uv__fetch_add_size_relaxed(p, v)                                    \
+  ((size_t) InterlockedExchangeAdd64((LONG64 volatile*)(p), (LONG64)(v)))
+# else
+#  define uv__fetch_add_size_relaxed(p, v)                                    \
+  ((size_t) InterlockedExchangeAdd((LONG volatile*)(p), (LONG)(v)))
+# endif
+#else
+#define uv__fetch_add_size_relaxed(p, v)                                      \
+  atomic_fetch_add_explicit((_Atomic size_t*)(p), v, memory_order_relaxed)
 #endif
 
 #define UV__UDP_DGRAM_MAXSIZE (64 * 1024)
@@ -89,7 +106,9 @@ enum {
   /* Used by streams. */
   UV_HANDLE_LISTENING                   = 0x00000040,
   UV_HANDLE_CONNECTION                  = 0x00000080,
+  UV_HANDLE_CORKED                      = 0x00000100,
   UV_HANDLE_SHUT                        = 0x00000200,
+  UV_HANDLE_HIGH_WATERMARK              = 0x00000400,
   UV_HANDLE_READ_EOF                    = 0x00000800,
 
   /* Used by streams and UDP handles. */
@@ -107,17 +126,24 @@ enum {
   /* Used by uv_tcp_t and uv_udp_t handles */
   UV_HANDLE_IPV6                        = 0x00400000,
 
-  /* Only used by uv_tcp_t handles. */
+  /* Only used by uv_tcp_t handles. The per-type bits from 0x01000000 up are
+   * all taken, 0x00800000 isn't used by any other handle type. */
+  UV_HANDLE_TCP_FASTOPEN                = 0x00800000,
   UV_HANDLE_TCP_NODELAY                 = 0x01000000,
   UV_HANDLE_TCP_KEEPALIVE               = 0x02000000,
   UV_HANDLE_TCP_SINGLE_ACCEPT           = 0x04000000,
   UV_HANDLE_TCP_ACCEPT_STATE_CHANGING   = 0x08000000,
   UV_HANDLE_SHARED_TCP_SOCKET           = 0x10000000,
+  UV_HANDLE_TCP_ZEROCOPY                = 0x20000000,
+  UV_HANDLE_TCP_ZEROCOPY_COPIED         = 0x40000000,
 
   /* Only used by uv_udp_t handles. */
   UV_HANDLE_UDP_PROCESSING              = 0x01000000,
   UV_HANDLE_UDP_CONNECTED               = 0x02000000,
   UV_HANDLE_UDP_RECVMMSG                = 0x04000000,
+  UV_HANDLE_UDP_GRO                     = 0x08000000,
+  UV_HANDLE_UDP_TXTIME                  = 0x10000000,
+  UV_HANDLE_UDP_RXQ_OVFL                = 0x20000000,
 
   /* Only used by uv_pipe_t handles. */
   UV_HANDLE_NON_OVERLAPPED_PIPE         = 0x01000000,
@@ -162,6 +188,7 @@ int uv__tcp_connect(uv_connect_t* req,
                    uv_tcp_t* handle,
                    const struct sockaddr* addr,
                    unsigned int addrlen,
+                   unsigned int flags,
                    uv_connect_cb cb);
 
 int uv__udp_init_ex(uv_loop_t* loop,
@@ -182,14 +209,34 @@ int uv__udp_disconnect(uv_udp_t* handle);
 
 int uv__udp_is_connected(uv_udp_t* handle);
 
+/* Extras of uv_udp_send_gso(), uv_udp_send_from() and uv_udp_send_at(), the
+ * only way they reach uv__udp_send(). NULL for a plain uv_udp_send(). The
+ * unix port copies them into the request, the Windows port doesn't support
+ * them. uv_udp_send_batch() has uv__udp_send_batch() instead.
+ */
+typedef struct {
+  unsigned int segment_size;
+  const struct sockaddr* src_addr;
+  uint64_t txtime;
+} uv__udp_send_opts_t;
+
 int uv__udp_send(uv_udp_send_t* req,
                  uv_udp_t* handle,
                  const uv_buf_t bufs[],
                  unsigned int nbufs,
                  const struct sockaddr* addr,
                  unsigned int addrlen,
+                 const uv__udp_send_opts_t* opts,
                  uv_udp_send_cb send_cb);
 
+int uv__udp_send_batch(uv_udp_send_t* req,
+                       uv_udp_t* handle,
+                       uv_buf_t* bufs[/*count*/],
+                       unsigned int nbufs[/*count*/],
+                       struct sockaddr* addrs[/*count*/],
+                       unsigned int count,
+                       uv_udp_send_cb send_cb);
+
 int uv__udp_try_send(uv_udp_t* handle,
                      const uv_buf_t bufs[],
                      unsigned int nbufs,
@@ -212,9 +259,9 @@ void uv__fs_poll_close(uv_fs_poll_t* handle);
 int uv__getaddrinfo_translate_error(int sys_err);    /* EAI_* error. */
 
 enum uv__work_kind {
-  UV__WORK_CPU,
-  UV__WORK_FAST_IO,
-  UV__WORK_SLOW_IO
+  UV__WORK_CPU = UV_WORK_CPU,
+  UV__WORK_FAST_IO = UV_WORK_FAST_IO,
+  UV__WORK_SLOW_IO = UV_WORK_SLOW_IO
 };
 
 void uv__work_submit(uv_loop_t* loop,
@@ -225,6 +272,9 @@ void uv__work_submit(uv_loop_t* loop,
 
 void uv__work_done(uv_async_t* handle);
 
+/* Hint to the CPU that the caller is busy-waiting. */
+void uv__cpu_relax(void);
+
 size_t uv__count_bufs(const uv_buf_t bufs[], unsigned int nbufs);
 
 /* On some platforms, notably macOS, attempting a read or write > 2GB returns
@@ -413,6 +463,14 @@ struct uv__loop_metrics_s {
 void uv__metrics_update_idle_time(uv_loop_t* loop);
 void uv__metrics_set_provider_entry_time(uv_loop_t* loop);
 
+/* Per-loop view of the threadpool. `queued`, `submitted` and `cancelled` are
+ * protected by the threadpool's global mutex, everything else is updated by
+ * the worker when it hands the request back and is protected by wq_mutex.
+ */
+typedef struct {
+  uv_work_metrics_t work[UV_WORK_KIND_MAX];
+} uv__work_metrics_t;
+
 #ifdef __linux__
 struct uv__iou {
   uint32_t* sqhead;
@@ -437,10 +495,16 @@ struct uv__iou {
 struct uv__loop_internal_fields_s {
   unsigned int flags;
   uv__loop_metrics_t loop_metrics;
+  uv__work_metrics_t work_metrics;
   int current_timeout;
+#ifndef _WIN32
+  struct uv__queue corked_streams;  /* See uv__stream_flush_corked(). */
+#endif
 #ifdef __linux__
   struct uv__iou ctl;
   struct uv__iou iou;
+  struct uv__iou udp;  /* multishot UDP receives, see uv__iou_udp_recvmsg() */
+  uint16_t udp_bgid;  /* last buffer group id handed out on `udp` */
   void* inv;  /* used by uv__platform_invalidate_fd() */
 #endif  /* __linux__ */
 };
@@ -832,6 +832,10 @@ int uv_cpumask_size(void) {
   return (int)(sizeof(DWORD_PTR) * 8);
 }
 
+void uv__cpu_relax(void) {
+  YieldProcessor();
+}
+
 int uv__getsockpeername(const uv_handle_t* handle,
                         uv__peersockfunc func,
                         struct sockaddr* name,
@@ -282,3 +282,56 @@ int uv_stream_set_blocking(uv_stream_t* handle, int blocking) {
 
   return 0;
 }
+
+
+int uv_write_nocopy(uv_write_t* req,
+                    uv_stream_t* handle,
+                    uv_buf_t bufs[],
+                    unsigned int nbufs,
+                    uv_write_cb cb) {
+  return uv_write(req, handle, bufs, nbufs, cb);
+}
+
+
+int uv_stream_sendfile(uv_write_t* req,
+                       uv_stream_t* handle,
+                       uv_file file,
+                       int64_t offset,
+                       size_t length,
+                       uv_write_cb cb) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_read_start_v(uv_stream_t* handle,
+                    uv_alloc_cb alloc_cb,
+                    uv_read_v_cb read_cb) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_stream_set_watermarks(uv_stream_t* handle,
+                             size_t low,
+                             size_t high,
+                             uv_watermark_cb cb) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_stream_set_framing(uv_stream_t* handle,
+                          const uv_stream_framing_t* framing) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_stream_set_cork(uv_stream_t* handle, int enable, size_t threshold) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_stream_splice(uv_splice_t* req,
+                     uv_stream_t* src,
+                     uv_stream_t* dst,
+                     uv_splice_cb cb) {
+  return UV_ENOTSUP;
+}
@@ -364,7 +364,7 @@ static int uv__tcp_try_bind(uv_tcp_t* handle,
   /* There is no SO_REUSEPORT on Windows, Windows only knows SO_REUSEADDR.
    * so we just return an error directly when UV_TCP_REUSEPORT is requested
    * for binding the socket. */
-  if (flags & UV_TCP_REUSEPORT)
+  if (flags & (UV_TCP_REUSEPORT | UV_TCP_FASTOPEN))
     return ERROR_NOT_SUPPORTED;
 
   if (handle->socket == INVALID_SOCKET) {
@@ -1385,6 +1385,26 @@ int uv_tcp_nodelay(uv_tcp_t* handle, int enable) {
 }
 
 
+int uv_tcp_zerocopy(uv_tcp_t* handle, int enable, size_t threshold) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_tcp_fastopen_accepted(const uv_tcp_t* handle) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_tcp_notsent_lowat(uv_tcp_t* handle, unsigned int bytes) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_tcp_get_info(const uv_tcp_t* handle, uv_tcp_info_t* info) {
+  return UV_ENOTSUP;
+}
+
+
 int uv_tcp_keepalive(uv_tcp_t* handle, int on, unsigned int idle) {
   return uv_tcp_keepalive_ex(handle, on, idle, 1, 10);
 }
@@ -1611,9 +1631,13 @@ int uv__tcp_connect(uv_connect_t* req,
                     uv_tcp_t* handle,
                     const struct sockaddr* addr,
                     unsigned int addrlen,
+                    unsigned int flags,
                     uv_connect_cb cb) {
   int err;
 
+  if (flags & UV_TCP_FASTOPEN)
+    return UV_ENOTSUP;
+
   err = uv__tcp_try_connect(req, handle, addr, addrlen, cb);
   if (err)
     return uv_translate_sys_error(err);
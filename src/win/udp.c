@@ -185,6 +185,57 @@ int uv_udp_using_recvmmsg(const uv_udp_t* handle) {
 }
 
 
+size_t uv_udp_get_gro_segment_size(const uv_udp_t* handle) {
+  return 0;
+}
+
+
+int uv_udp_set_mmsg_batch(uv_udp_t* handle,
+                          unsigned int recv_batch,
+                          unsigned int send_batch,
+                          int adaptive) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_udp_bind_reuseport_group(uv_udp_t* handles[],
+                                unsigned int count,
+                                const struct sockaddr* addr,
+                                unsigned int flags) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_udp_set_recv_ring(uv_udp_t* handle,
+                         unsigned int nslots,
+                         size_t slot_size) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_udp_recv_ring_release(uv_udp_t* handle, const uv_buf_t* buf) {
+  return UV_EINVAL;
+}
+
+
+int uv_udp_get_stats(uv_udp_t* handle, uv_udp_stats_t* stats) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_udp_set_pacing_rate(uv_udp_t* handle, uint64_t rate) {
+  return UV_ENOTSUP;
+}
+
+
+int uv_udp_recv_start_ex(uv_udp_t* handle,
+                         uv_alloc_cb alloc_cb,
+                         uv_udp_recv_ex_cb recv_cb,
+                         unsigned int info_flags) {
+  return UV_ENOTSUP;
+}
+
+
 static int uv__udp_maybe_bind(uv_udp_t* handle,
                               const struct sockaddr* addr,
                               unsigned int addrlen,
@@ -312,6 +363,9 @@ int uv__udp_recv_start(uv_udp_t* handle, uv_alloc_cb alloc_cb,
   uv_loop_t* loop = handle->loop;
   int err;
 
+  if (alloc_cb == NULL)
+    return UV_EINVAL;
+
   if (handle->flags & UV_HANDLE_READING) {
     return UV_EALREADY;
   }
@@ -1091,10 +1145,14 @@ int uv__udp_send(uv_udp_send_t* req,
                  unsigned int nbufs,
                  const struct sockaddr* addr,
                  unsigned int addrlen,
+                 const uv__udp_send_opts_t* opts,
                  uv_udp_send_cb send_cb) {
   const struct sockaddr* bind_addr;
   int err;
 
+  if (opts != NULL)
+    return UV_ENOTSUP;
+
   if (!(handle->flags & UV_HANDLE_BOUND)) {
     if (addrlen == sizeof(uv_addr_ip4_any_))
       bind_addr = (const struct sockaddr*) &uv_addr_ip4_any_;
@@ -1166,6 +1224,17 @@ int uv__udp_try_send(uv_udp_t* handle,
 }
 
 
+int uv__udp_send_batch(uv_udp_send_t* req,
+                       uv_udp_t* handle,
+                       uv_buf_t* bufs[/*count*/],
+                       unsigned int nbufs[/*count*/],
+                       struct sockaddr* addrs[/*count*/],
+                       unsigned int count,
+                       uv_udp_send_cb send_cb) {
+  return UV_ENOTSUP;
+}
+
+
 int uv__udp_try_send2(uv_udp_t* handle,
                       unsigned int count,
                       uv_buf_t* bufs[/*count*/],
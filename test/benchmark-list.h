@@ -28,12 +28,18 @@ BENCHMARK_DECLARE (ping_udp1)
 BENCHMARK_DECLARE (ping_udp10)
 BENCHMARK_DECLARE (ping_udp100)
 BENCHMARK_DECLARE (tcp_write_batch)
+BENCHMARK_DECLARE (tcp_write_batch_small)
+BENCHMARK_DECLARE (tcp_write_batch_small_cork)
+BENCHMARK_DECLARE (tcp_write_iovecs)
+BENCHMARK_DECLARE (tcp_write_iovecs_nocopy)
 BENCHMARK_DECLARE (tcp4_pound_100)
 BENCHMARK_DECLARE (tcp4_pound_1000)
 BENCHMARK_DECLARE (pipe_pound_100)
 BENCHMARK_DECLARE (pipe_pound_1000)
 BENCHMARK_DECLARE (tcp_pump100_client)
 BENCHMARK_DECLARE (tcp_pump1_client)
+BENCHMARK_DECLARE (tcp_pump1_client_large)
+BENCHMARK_DECLARE (tcp_pump1_client_zerocopy)
 BENCHMARK_DECLARE (pipe_pump100_client)
 BENCHMARK_DECLARE (pipe_pump1_client)
 
@@ -64,6 +70,10 @@ BENCHMARK_DECLARE (udp_timed_pummel_10v1000)
 BENCHMARK_DECLARE (udp_timed_pummel_100v100)
 BENCHMARK_DECLARE (udp_timed_pummel_100v1000)
 BENCHMARK_DECLARE (udp_timed_pummel_1000v1000)
+BENCHMARK_DECLARE (udp_timed_pummel_bulk)
+BENCHMARK_DECLARE (udp_timed_pummel_bulk_gso)
+BENCHMARK_DECLARE (udp_timed_pummel_multi_loop)
+BENCHMARK_DECLARE (udp_timed_pummel_multi_loop_cpu)
 
 BENCHMARK_DECLARE (getaddrinfo)
 BENCHMARK_DECLARE (fs_stat)
@@ -76,6 +86,8 @@ BENCHMARK_DECLARE (async_pummel_2)
 BENCHMARK_DECLARE (async_pummel_4)
 BENCHMARK_DECLARE (async_pummel_8)
 BENCHMARK_DECLARE (queue_work)
+BENCHMARK_DECLARE (queue_work_bulk)
+BENCHMARK_DECLARE (queue_work_latency)
 BENCHMARK_DECLARE (spawn)
 BENCHMARK_DECLARE (thread_create)
 BENCHMARK_DECLARE (million_async)
@@ -102,12 +114,30 @@ TASK_LIST_START
   BENCHMARK_ENTRY  (tcp_write_batch)
   BENCHMARK_HELPER (tcp_write_batch, tcp4_blackhole_server)
 
+  BENCHMARK_ENTRY  (tcp_write_batch_small)
+  BENCHMARK_HELPER (tcp_write_batch_small, tcp4_blackhole_server)
+
+  BENCHMARK_ENTRY  (tcp_write_batch_small_cork)
+  BENCHMARK_HELPER (tcp_write_batch_small_cork, tcp4_blackhole_server)
+
+  BENCHMARK_ENTRY  (tcp_write_iovecs)
+  BENCHMARK_HELPER (tcp_write_iovecs, tcp4_blackhole_server)
+
+  BENCHMARK_ENTRY  (tcp_write_iovecs_nocopy)
+  BENCHMARK_HELPER (tcp_write_iovecs_nocopy, tcp4_blackhole_server)
+
   BENCHMARK_ENTRY  (tcp_pump100_client)
   BENCHMARK_HELPER (tcp_pump100_client, tcp_pump_server)
 
   BENCHMARK_ENTRY  (tcp_pump1_client)
   BENCHMARK_HELPER (tcp_pump1_client, tcp_pump_server)
 
+  BENCHMARK_ENTRY  (tcp_pump1_client_large)
+  BENCHMARK_HELPER (tcp_pump1_client_large, tcp_pump_server)
+
+  BENCHMARK_ENTRY  (tcp_pump1_client_zerocopy)
+  BENCHMARK_HELPER (tcp_pump1_client_zerocopy, tcp_pump_server)
+
   BENCHMARK_ENTRY  (tcp4_pound_100)
   BENCHMARK_HELPER (tcp4_pound_100, tcp4_echo_server)
 
@@ -151,6 +181,10 @@ TASK_LIST_START
   BENCHMARK_ENTRY  (udp_timed_pummel_100v100)
   BENCHMARK_ENTRY  (udp_timed_pummel_100v1000)
   BENCHMARK_ENTRY  (udp_timed_pummel_1000v1000)
+  BENCHMARK_ENTRY  (udp_timed_pummel_bulk)
+  BENCHMARK_ENTRY  (udp_timed_pummel_bulk_gso)
+  BENCHMARK_ENTRY  (udp_timed_pummel_multi_loop)
+  BENCHMARK_ENTRY  (udp_timed_pummel_multi_loop_cpu)
 
   BENCHMARK_ENTRY  (getaddrinfo)
 
@@ -165,6 +199,8 @@ TASK_LIST_START
   BENCHMARK_ENTRY  (async_pummel_4)
   BENCHMARK_ENTRY  (async_pummel_8)
   BENCHMARK_ENTRY  (queue_work)
+  BENCHMARK_ENTRY  (queue_work_bulk)
+  BENCHMARK_ENTRY  (queue_work_latency)
 
   BENCHMARK_ENTRY  (spawn)
   BENCHMARK_ENTRY  (thread_create)
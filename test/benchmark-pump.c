@@ -28,6 +28,7 @@
 
 static int TARGET_CONNECTIONS;
 #define WRITE_BUFFER_SIZE           8192
+#define LARGE_WRITE_BUFFER_SIZE     (1024 * 1024)
 #define MAX_SIMULTANEOUS_CONNECTS   100
 
 #define PRINT_STATS                 0
@@ -66,7 +67,10 @@ static int64_t nsent_total = 0;
 
 static int stats_left = 0;
 
-static char write_buffer[WRITE_BUFFER_SIZE];
+static char write_buffer[LARGE_WRITE_BUFFER_SIZE];
+static size_t write_size = WRITE_BUFFER_SIZE;
+static int zerocopy;
+static const char* variant = "";
 
 /* Make this as large as you need. */
 #define MAX_WRITE_HANDLES 1000
@@ -102,9 +106,10 @@ static void show_stats(uv_timer_t* handle) {
     uv_update_time(loop);
     diff = uv_now(loop) - start_time;
 
-    fprintf(stderr, "%s_pump%d_client: %.1f gbit/s\n",
+    fprintf(stderr, "%s_pump%d_client%s: %.1f gbit/s\n",
             type == TCP ? "tcp" : "pipe",
             write_sockets,
+            variant,
             gbit(nsent_total, diff));
     fflush(stderr);
 
@@ -192,8 +197,8 @@ static void write_cb(uv_write_t* req, int status) {
 
   req_free((uv_req_t*) req);
 
-  nsent += sizeof write_buffer;
-  nsent_total += sizeof write_buffer;
+  nsent += write_size;
+  nsent_total += write_size;
 
   do_write((uv_stream_t*) req->handle);
 }
@@ -205,7 +210,7 @@ static void do_write(uv_stream_t* stream) {
   int r;
 
   buf.base = (char*) &write_buffer;
-  buf.len = sizeof write_buffer;
+  buf.len = write_size;
 
   req = (uv_write_t*) req_alloc();
   r = uv_write(req, stream, &buf, 1, write_cb);
@@ -255,6 +260,11 @@ static void maybe_connect_some(void) {
       r = uv_tcp_init(loop, tcp);
       ASSERT_OK(r);
 
+      if (zerocopy) {
+        r = uv_tcp_zerocopy(tcp, 1, 0);
+        ASSERT_OK(r);
+      }
+
       req = (uv_connect_t*) req_alloc();
       r = uv_tcp_connect(req,
                          tcp,
@@ -466,6 +476,27 @@ BENCHMARK_IMPL(tcp_pump1_client) {
 }
 
 
+/* 1 MB writes, the size where avoiding the copy into the kernel pays off. */
+BENCHMARK_IMPL(tcp_pump1_client_large) {
+  write_size = LARGE_WRITE_BUFFER_SIZE;
+  variant = "_large";
+  tcp_pump(1);
+  return 0;
+}
+
+
+BENCHMARK_IMPL(tcp_pump1_client_zerocopy) {
+#if !defined(__linux__)
+  RETURN_SKIP("Zero-copy transmit is only supported on Linux");
+#endif
+  write_size = LARGE_WRITE_BUFFER_SIZE;
+  zerocopy = 1;
+  variant = "_zerocopy";
+  tcp_pump(1);
+  return 0;
+}
+
+
 BENCHMARK_IMPL(pipe_pump100_client) {
   pipe_pump(100);
   return 0;
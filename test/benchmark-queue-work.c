@@ -69,3 +69,151 @@ BENCHMARK_IMPL(queue_work) {
   MAKE_VALGRIND_HAPPY(loop);
   return 0;
 }
+
+
+#define BULK_ITEMS 10000
+
+static uv_work_t bulk_reqs[BULK_ITEMS];
+static unsigned bulk_results[BULK_ITEMS];
+static unsigned bulk_pending;
+static unsigned bulk_items;
+
+static void item_work_cb(uv_work_t* req) {
+  bulk_results[req - bulk_reqs] = fastrand();
+}
+
+static void item_after_work_cb(uv_work_t* req, int status);
+
+static void submit_items(uv_loop_t* loop) {
+  unsigned i;
+
+  bulk_pending = BULK_ITEMS;
+  for (i = 0; i < BULK_ITEMS; i++)
+    ASSERT_OK(uv_queue_work(loop,
+                            bulk_reqs + i,
+                            item_work_cb,
+                            item_after_work_cb));
+}
+
+static void item_after_work_cb(uv_work_t* req, int status) {
+  bulk_items++;
+  if (--bulk_pending == 0 && !done)
+    submit_items(req->loop);
+}
+
+static void bulk_work_cb(uv_work_bulk_t* req, size_t start, size_t end) {
+  for (; start < end; start++)
+    bulk_results[start] = fastrand();
+}
+
+static void bulk_after_work_cb(uv_work_bulk_t* req, int status) {
+  bulk_items += req->count;
+  if (!done)
+    ASSERT_OK(uv_queue_work_bulk(req->loop,
+                                 req,
+                                 BULK_ITEMS,
+                                 0,
+                                 bulk_work_cb,
+                                 bulk_after_work_cb));
+}
+
+BENCHMARK_IMPL(queue_work_bulk) {
+  char fmtbuf[2][32];
+  uv_timer_t timer_handle;
+  uv_work_bulk_t bulk;
+  uv_loop_t* loop;
+  int timeout;
+
+  loop = uv_default_loop();
+  timeout = 5000;
+
+  done = 0;
+  bulk_items = 0;
+  ASSERT_OK(uv_timer_init(loop, &timer_handle));
+  ASSERT_OK(uv_timer_start(&timer_handle, timer_cb, timeout, 0));
+  submit_items(loop);
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  printf("uv_queue_work: %s items in %.1f seconds (%s/s)\n",
+         fmt(&fmtbuf[0], bulk_items),
+         timeout / 1000.,
+         fmt(&fmtbuf[1], bulk_items / (timeout / 1000.)));
+
+  done = 0;
+  bulk_items = 0;
+  ASSERT_OK(uv_timer_start(&timer_handle, timer_cb, timeout, 0));
+  ASSERT_OK(uv_queue_work_bulk(loop,
+                               &bulk,
+                               BULK_ITEMS,
+                               0,
+                               bulk_work_cb,
+                               bulk_after_work_cb));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  printf("uv_queue_work_bulk: %s items in %.1f seconds (%s/s)\n",
+         fmt(&fmtbuf[0], bulk_items),
+         timeout / 1000.,
+         fmt(&fmtbuf[1], bulk_items / (timeout / 1000.)));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+static void latency_work_cb(uv_work_t* req) {
+}
+
+static void latency_after_work_cb(uv_work_t* req, int status) {
+  events++;
+  if (!done)
+    ASSERT_OK(uv_queue_work(req->loop,
+                            req,
+                            latency_work_cb,
+                            latency_after_work_cb));
+}
+
+/* Submits small jobs one at a time and reports how long each of them waited
+ * for a worker to pick it up.
+ */
+BENCHMARK_IMPL(queue_work_latency) {
+  uv_work_metrics_t m;
+  uv_timer_t timer_handle;
+  uv_work_t work;
+  uv_loop_t* loop;
+  uint64_t p50;
+  uint64_t n;
+  int timeout;
+  int i;
+
+  loop = uv_default_loop();
+  timeout = 5000;
+
+  done = 0;
+  events = 0;
+  ASSERT_OK(uv_timer_init(loop, &timer_handle));
+  ASSERT_OK(uv_timer_start(&timer_handle, timer_cb, timeout, 0));
+  ASSERT_OK(uv_queue_work(loop, &work, latency_work_cb, latency_after_work_cb));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_OK(uv_threadpool_work_metrics(loop, UV_WORK_CPU, &m));
+  ASSERT_EQ(m.completed, events);
+
+  /* Upper bound of the bucket that contains the median, in microseconds. */
+  p50 = 0;
+  n = 0;
+  for (i = 0; i < UV_WORK_HISTOGRAM_SIZE; i++) {
+    n += m.wait_histogram[i];
+    if (2 * n >= m.completed) {
+      p50 = (uint64_t) 1 << i;
+      break;
+    }
+  }
+
+  printf("%u jobs, submit to start: mean %.1f us, p50 < %llu us\n",
+         events,
+         m.wait_time / 1e3 / m.completed,
+         (unsigned long long) p50);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
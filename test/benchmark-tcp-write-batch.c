@@ -142,3 +142,234 @@ BENCHMARK_IMPL(tcp_write_batch) {
   MAKE_VALGRIND_HAPPY(loop);
   return 0;
 }
+
+
+/* Protocol-style writes: a header, a body and a trailer per response, and the
+ * next response is sent when the previous one has been written.
+ */
+#define NUM_RESPONSES   (100 * 1000)
+
+static uv_write_t response_reqs[3];
+static uv_buf_t response_bufs[3];
+static int responses_left;
+
+
+static void response_write_cb(uv_write_t* req, int status);
+
+
+static void write_response(uv_stream_t* stream) {
+  int i;
+
+  for (i = 0; i < 3; i++) {
+    ASSERT_OK(uv_write(&response_reqs[i],
+                       stream,
+                       &response_bufs[i],
+                       1,
+                       response_write_cb));
+  }
+}
+
+
+static void response_write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  write_cb_called++;
+
+  if (req != &response_reqs[2])
+    return;
+
+  if (--responses_left > 0)
+    write_response(req->handle);
+  else
+    ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, shutdown_cb));
+}
+
+
+static void response_connect_cb(uv_connect_t* req, int status) {
+  ASSERT_OK(status);
+  connect_cb_called++;
+  write_response(req->handle);
+}
+
+
+static int tcp_write_batch_small(int cork) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uint64_t start;
+  uint64_t stop;
+
+  /* shutdown_cb() frees it. */
+  write_reqs = NULL;
+  responses_left = NUM_RESPONSES;
+  response_bufs[0] = uv_buf_init("HTTP/1.1 200 OK\r\n\r\n", 19);
+  response_bufs[1] = uv_buf_init(WRITE_REQ_DATA, sizeof(WRITE_REQ_DATA) - 1);
+  response_bufs[2] = uv_buf_init("\r\n", 2);
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &tcp_client));
+  if (cork)
+    ASSERT_OK(uv_stream_set_cork((uv_stream_t*) &tcp_client, 1, 0));
+
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &tcp_client,
+                           (const struct sockaddr*) &addr,
+                           response_connect_cb));
+
+  start = uv_hrtime();
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  stop = uv_hrtime();
+
+  ASSERT_EQ(1, connect_cb_called);
+  ASSERT_EQ(write_cb_called, 3 * NUM_RESPONSES);
+  ASSERT_EQ(1, shutdown_cb_called);
+  ASSERT_EQ(1, close_cb_called);
+
+  printf("%ld responses of 3 writes%s in %.2fs.\n",
+         (long)NUM_RESPONSES,
+         cork ? " (corked)" : "",
+         (stop - start) / 1e9);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+BENCHMARK_IMPL(tcp_write_batch_small) {
+  return tcp_write_batch_small(0);
+}
+
+
+BENCHMARK_IMPL(tcp_write_batch_small_cork) {
+  return tcp_write_batch_small(1);
+}
+
+
+/* Responses of many small buffers in a single write, the way an encoder
+ * that emits one buffer per field sends them. The allocations made while
+ * the loop runs are counted to show what copying the uv_buf_t array costs.
+ */
+#define NUM_IOVECS      16
+
+static uv_write_t iovec_req;
+static uv_buf_t iovec_bufs[NUM_IOVECS];
+static int iovec_nocopy;
+static uint64_t allocations;
+
+
+static void* counting_malloc(size_t size) {
+  allocations++;
+  return malloc(size);
+}
+
+
+static void* counting_realloc(void* ptr, size_t size) {
+  allocations++;
+  return realloc(ptr, size);
+}
+
+
+static void* counting_calloc(size_t count, size_t size) {
+  allocations++;
+  return calloc(count, size);
+}
+
+
+static void iovec_write_cb(uv_write_t* req, int status);
+
+
+static void write_iovecs(uv_stream_t* stream) {
+  int i;
+
+  /* uv_write_nocopy() consumes the array, fill it in again every time. */
+  for (i = 0; i < NUM_IOVECS; i++)
+    iovec_bufs[i] = uv_buf_init(WRITE_REQ_DATA, sizeof(WRITE_REQ_DATA) - 1);
+
+  if (iovec_nocopy)
+    ASSERT_OK(uv_write_nocopy(&iovec_req,
+                              stream,
+                              iovec_bufs,
+                              NUM_IOVECS,
+                              iovec_write_cb));
+  else
+    ASSERT_OK(uv_write(&iovec_req,
+                       stream,
+                       iovec_bufs,
+                       NUM_IOVECS,
+                       iovec_write_cb));
+}
+
+
+static void iovec_write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  write_cb_called++;
+
+  if (--responses_left > 0)
+    write_iovecs(req->handle);
+  else
+    ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, shutdown_cb));
+}
+
+
+static void iovec_connect_cb(uv_connect_t* req, int status) {
+  ASSERT_OK(status);
+  connect_cb_called++;
+  write_iovecs(req->handle);
+}
+
+
+static int tcp_write_iovecs(int nocopy) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uint64_t start;
+  uint64_t stop;
+
+  ASSERT_OK(uv_replace_allocator(counting_malloc,
+                                 counting_realloc,
+                                 counting_calloc,
+                                 free));
+
+  /* shutdown_cb() frees it. */
+  write_reqs = NULL;
+  responses_left = NUM_RESPONSES;
+  iovec_nocopy = nocopy;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &tcp_client));
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &tcp_client,
+                           (const struct sockaddr*) &addr,
+                           iovec_connect_cb));
+
+  allocations = 0;
+  start = uv_hrtime();
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  stop = uv_hrtime();
+
+  ASSERT_EQ(1, connect_cb_called);
+  ASSERT_EQ(write_cb_called, NUM_RESPONSES);
+  ASSERT_EQ(1, shutdown_cb_called);
+  ASSERT_EQ(1, close_cb_called);
+
+  printf("%ld writes of %d buffers%s in %.2fs, %.2f allocations/write.\n",
+         (long)NUM_RESPONSES,
+         NUM_IOVECS,
+         nocopy ? " (nocopy)" : "",
+         (stop - start) / 1e9,
+         (double) allocations / NUM_RESPONSES);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+BENCHMARK_IMPL(tcp_write_iovecs) {
+  return tcp_write_iovecs(0);
+}
+
+
+BENCHMARK_IMPL(tcp_write_iovecs_nocopy) {
+  return tcp_write_iovecs(1);
+}
@@ -220,6 +220,384 @@ static int pummel(unsigned int n_senders,
 }
 
 
+/* Bulk sends of same-size packets to one peer, the way a QUIC sender flushes
+ * its congestion window: BULK_SEGMENTS packets per batch, either as that many
+ * send requests or as a single UDP_SEGMENT send.
+ */
+#define BULK_SEGMENT_SIZE 1200
+#define BULK_SEGMENTS 45
+
+static char bulk_payload[BULK_SEGMENT_SIZE * BULK_SEGMENTS];
+static uv_udp_send_t bulk_reqs[BULK_SEGMENTS];
+static unsigned int bulk_pending;
+static int bulk_gso;
+
+
+static void bulk_send_cb(uv_udp_send_t* req, int status);
+
+
+static void bulk_send(uv_udp_t* handle, const struct sockaddr* addr) {
+  uv_buf_t buf;
+  unsigned int i;
+
+  if (bulk_gso) {
+    buf = uv_buf_init(bulk_payload, sizeof(bulk_payload));
+    ASSERT_OK(uv_udp_send_gso(&bulk_reqs[0],
+                              handle,
+                              &buf,
+                              1,
+                              addr,
+                              BULK_SEGMENT_SIZE,
+                              bulk_send_cb));
+    bulk_pending = 1;
+    return;
+  }
+
+  for (i = 0; i < BULK_SEGMENTS; i++) {
+    buf = uv_buf_init(bulk_payload + i * BULK_SEGMENT_SIZE, BULK_SEGMENT_SIZE);
+    ASSERT_OK(uv_udp_send(&bulk_reqs[i],
+                          handle,
+                          &buf,
+                          1,
+                          addr,
+                          bulk_send_cb));
+  }
+  bulk_pending = BULK_SEGMENTS;
+}
+
+
+static void bulk_send_cb(uv_udp_send_t* req, int status) {
+  if (status != 0) {
+    ASSERT_EQ(status, UV_ECANCELED);
+    return;
+  }
+
+  if (exiting || --bulk_pending > 0)
+    return;
+
+  send_cb_called += BULK_SEGMENTS;
+  bulk_send(req->handle, (const struct sockaddr*) &senders[0].addr);
+}
+
+
+static void bulk_recv_cb(uv_udp_t* handle,
+                         ssize_t nread,
+                         const uv_buf_t* buf,
+                         const struct sockaddr* addr,
+                         unsigned flags) {
+  if (nread == 0)
+    return;
+
+  if (nread < 0) {
+    ASSERT_EQ(nread, UV_ECANCELED);
+    return;
+  }
+
+  ASSERT_EQ(nread, BULK_SEGMENT_SIZE);
+  recv_cb_called++;
+}
+
+
+static int pummel_bulk(int gso) {
+  uv_timer_t timer_handle;
+  uint64_t duration;
+  uv_loop_t* loop;
+
+#if !defined(__linux__)
+  if (gso)
+    RETURN_SKIP("UDP segmentation offload is Linux-only");
+#endif
+
+  loop = uv_default_loop();
+  n_senders_ = 1;
+  n_receivers_ = 1;
+  bulk_gso = gso;
+  memset(bulk_payload, 'x', sizeof(bulk_payload));
+
+  ASSERT_OK(uv_timer_init(loop, &timer_handle));
+  ASSERT_OK(uv_timer_start(&timer_handle, timeout_cb, TEST_DURATION, 0));
+  uv_unref((uv_handle_t*) &timer_handle);
+  timed = 1;
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", BASE_PORT, &receivers[0].addr));
+  ASSERT_OK(uv_udp_init(loop, &receivers[0].udp_handle));
+  ASSERT_OK(uv_udp_bind(&receivers[0].udp_handle,
+                        (const struct sockaddr*) &receivers[0].addr,
+                        0));
+  ASSERT_OK(uv_udp_recv_start(&receivers[0].udp_handle,
+                              alloc_cb,
+                              bulk_recv_cb));
+  uv_unref((uv_handle_t*) &receivers[0].udp_handle);
+
+  senders[0].addr = receivers[0].addr;
+  ASSERT_OK(uv_udp_init(loop, &senders[0].udp_handle));
+  bulk_send(&senders[0].udp_handle,
+            (const struct sockaddr*) &senders[0].addr);
+
+  duration = uv_hrtime();
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  duration = uv_hrtime() - duration;
+  duration = duration / (uint64_t) 1e6;
+
+  printf("udp_pummel_bulk%s: %.0f packets/s received, %.0f packets/s sent. "
+         "%u received, %u sent in %.1f seconds.\n",
+         gso ? "_gso" : "",
+         recv_cb_called / (duration / 1000.0),
+         send_cb_called / (duration / 1000.0),
+         recv_cb_called,
+         send_cb_called,
+         duration / 1000.0);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+BENCHMARK_IMPL(udp_timed_pummel_bulk) {
+  return pummel_bulk(0);
+}
+
+
+BENCHMARK_IMPL(udp_timed_pummel_bulk_gso) {
+  return pummel_bulk(1);
+}
+
+
+/* One loop per CPU, each sending to and receiving from the same port through
+ * its own socket of a reuseport group. The datagrams carry the index of the
+ * sending loop so the receiver can tell whether they stayed on their CPU:
+ * with plain SO_REUSEPORT the kernel hashes them over the group, with
+ * uv_udp_bind_reuseport_group() the loop on the receiving CPU gets them.
+ */
+#define MULTI_LOOPS_MAX 16
+#define MULTI_INFLIGHT 16
+
+struct multi_loop_state {
+  uv_loop_t loop;
+  uv_thread_t thread;
+  uv_timer_t timer;
+  uv_udp_t receiver;
+  uv_udp_t sender;
+  uv_udp_send_t send_reqs[MULTI_INFLIGHT];
+  struct sockaddr_in addr;
+  char payload[64];
+  char slab[65536];
+  unsigned int index;
+  unsigned int sent;
+  unsigned int received;
+  unsigned int received_local;
+  int exiting;
+};
+
+static struct multi_loop_state multi_loops[MULTI_LOOPS_MAX];
+
+
+static void multi_alloc_cb(uv_handle_t* handle,
+                           size_t suggested_size,
+                           uv_buf_t* buf) {
+  struct multi_loop_state* s;
+
+  s = container_of(handle, struct multi_loop_state, receiver);
+  buf->base = s->slab;
+  buf->len = sizeof(s->slab);
+}
+
+
+static void multi_send_cb(uv_udp_send_t* req, int status);
+
+
+static void multi_send(struct multi_loop_state* s, uv_udp_send_t* req) {
+  uv_buf_t buf;
+
+  buf = uv_buf_init(s->payload, sizeof(s->payload));
+  ASSERT_OK(uv_udp_send(req,
+                        &s->sender,
+                        &buf,
+                        1,
+                        (const struct sockaddr*) &s->addr,
+                        multi_send_cb));
+}
+
+
+static void multi_send_cb(uv_udp_send_t* req, int status) {
+  struct multi_loop_state* s;
+
+  s = container_of(req->handle, struct multi_loop_state, sender);
+
+  if (status != 0) {
+    ASSERT_EQ(status, UV_ECANCELED);
+    return;
+  }
+
+  if (s->exiting)
+    return;
+
+  s->sent++;
+  multi_send(s, req);
+}
+
+
+static void multi_recv_cb(uv_udp_t* handle,
+                          ssize_t nread,
+                          const uv_buf_t* buf,
+                          const struct sockaddr* addr,
+                          unsigned flags) {
+  struct multi_loop_state* s;
+
+  if (nread == 0)
+    return;
+
+  if (nread < 0) {
+    ASSERT_EQ(nread, UV_ECANCELED);
+    return;
+  }
+
+  s = container_of(handle, struct multi_loop_state, receiver);
+  ASSERT_EQ(nread, sizeof(s->payload));
+
+  s->received++;
+  if ((unsigned char) buf->base[0] == s->index)
+    s->received_local++;
+}
+
+
+static void multi_timeout_cb(uv_timer_t* timer) {
+  struct multi_loop_state* s;
+
+  s = container_of(timer, struct multi_loop_state, timer);
+  s->exiting = 1;
+  uv_close((uv_handle_t*) &s->sender, NULL);
+  uv_close((uv_handle_t*) &s->receiver, NULL);
+  uv_close((uv_handle_t*) &s->timer, NULL);
+}
+
+
+static void multi_loop_run(void* arg) {
+  struct multi_loop_state* s;
+  uv_thread_t self;
+  char* cpumask;
+  int cpumasksize;
+  unsigned int i;
+
+  s = arg;
+
+  /* Loop i runs on CPU i, the one whose datagrams the group steers to it. */
+  cpumasksize = uv_cpumask_size();
+  ASSERT_GT(cpumasksize, 0);
+  ASSERT_LT(s->index, (unsigned int) cpumasksize);
+  cpumask = calloc(cpumasksize, 1);
+  ASSERT_NOT_NULL(cpumask);
+  cpumask[s->index] = 1;
+  self = uv_thread_self();
+  ASSERT_OK(uv_thread_setaffinity(&self, cpumask, NULL, cpumasksize));
+  free(cpumask);
+
+  ASSERT_OK(uv_udp_recv_start(&s->receiver, multi_alloc_cb, multi_recv_cb));
+
+  ASSERT_OK(uv_udp_init(&s->loop, &s->sender));
+  for (i = 0; i < MULTI_INFLIGHT; i++)
+    multi_send(s, &s->send_reqs[i]);
+
+  ASSERT_OK(uv_timer_init(&s->loop, &s->timer));
+  ASSERT_OK(uv_timer_start(&s->timer, multi_timeout_cb, TEST_DURATION, 0));
+
+  ASSERT_OK(uv_run(&s->loop, UV_RUN_DEFAULT));
+}
+
+
+static int pummel_multi_loop(int steer) {
+  uv_udp_t* group[MULTI_LOOPS_MAX];
+  struct multi_loop_state* s;
+  struct sockaddr_in addr;
+  unsigned int received_local;
+  unsigned int received;
+  unsigned int sent;
+  unsigned int n;
+  unsigned int i;
+  uint64_t duration;
+
+#if !defined(__linux__)
+  if (steer)
+    RETURN_SKIP("Reuseport CPU steering is Linux-only");
+#endif
+
+  n = uv_available_parallelism();
+  if (n > MULTI_LOOPS_MAX)
+    n = MULTI_LOOPS_MAX;
+
+  for (i = 0; i < n; i++) {
+    s = multi_loops + i;
+    s->index = i;
+    memset(s->payload, 'x', sizeof(s->payload));
+    s->payload[0] = (char) i;
+    ASSERT_OK(uv_loop_init(&s->loop));
+    ASSERT_OK(uv_udp_init(&s->loop, &s->receiver));
+    group[i] = &s->receiver;
+  }
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", BASE_PORT, &addr));
+  if (steer) {
+    ASSERT_OK(uv_udp_bind_reuseport_group(group,
+                                          n,
+                                          (const struct sockaddr*) &addr,
+                                          0));
+  } else {
+    for (i = 0; i < n; i++)
+      ASSERT_OK(uv_udp_bind(group[i],
+                            (const struct sockaddr*) &addr,
+                            UV_UDP_REUSEPORT));
+  }
+
+  duration = uv_hrtime();
+
+  for (i = 0; i < n; i++) {
+    s = multi_loops + i;
+    s->addr = addr;
+    ASSERT_OK(uv_thread_create(&s->thread, multi_loop_run, s));
+  }
+
+  sent = 0;
+  received = 0;
+  received_local = 0;
+  for (i = 0; i < n; i++) {
+    s = multi_loops + i;
+    ASSERT_OK(uv_thread_join(&s->thread));
+    sent += s->sent;
+    received += s->received;
+    received_local += s->received_local;
+    ASSERT_OK(uv_loop_close(&s->loop));
+  }
+
+  duration = uv_hrtime() - duration;
+  duration = duration / (uint64_t) 1e6;
+
+  printf("udp_pummel_multi_loop%s (%u loops): %.0f/s received, "
+         "%.0f/s sent, %.1f%% received on the sending loop. "
+         "%u received, %u sent in %.1f seconds.\n",
+         steer ? "_cpu" : "",
+         n,
+         received / (duration / 1000.0),
+         sent / (duration / 1000.0),
+         received ? 100.0 * received_local / received : 0.0,
+         received,
+         sent,
+         duration / 1000.0);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
+
+
+BENCHMARK_IMPL(udp_timed_pummel_multi_loop) {
+  return pummel_multi_loop(0);
+}
+
+
+BENCHMARK_IMPL(udp_timed_pummel_multi_loop_cpu) {
+  return pummel_multi_loop(1);
+}
+
+
 #define X(a, b)                                                               \
   BENCHMARK_IMPL(udp_pummel_##a##v##b) {                                      \
     return pummel(a, b, 0);                                                   \
@@ -234,6 +234,99 @@ TEST_IMPL(fork_socketpair_started) {
 }
 
 
+
+static uv_udp_t fork_udp_recver;
+static uv_udp_t fork_udp_sender;
+static uv_buf_t fork_udp_held;
+static int fork_udp_recv_cb_called;
+
+
+static void fork_udp_recv_cb(uv_udp_t* handle,
+                             ssize_t nread,
+                             const uv_buf_t* buf,
+                             const struct sockaddr* addr,
+                             unsigned flags) {
+  ASSERT_EQ(4, nread);
+  ASSERT(flags & UV_UDP_RING_BUF);
+  fork_udp_recv_cb_called++;
+
+  /* Keep the first slot lent out across the fork. */
+  if (fork_udp_recv_cb_called == 1) {
+    fork_udp_held = *buf;
+    uv_stop(handle->loop);
+    return;
+  }
+
+  ASSERT_OK(uv_udp_recv_ring_release(handle, buf));
+  uv_close((uv_handle_t*) &fork_udp_recver, NULL);
+  uv_close((uv_handle_t*) &fork_udp_sender, NULL);
+}
+
+
+TEST_IMPL(fork_udp_recv_ring) {
+  /* A receive ring keeps working in the child, with io_uring in the parent
+     and epoll in the child. */
+  struct sockaddr_in addr;
+  pid_t child_pid;
+  int sync_pipe[2];
+  char sync_buf[1];
+  uv_buf_t buf;
+
+#if defined(__linux__)
+  ASSERT_OK(setenv("UV_USE_IO_URING", "1", 1));
+#endif
+
+  ASSERT_OK(pipe(sync_pipe));
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &fork_udp_recver));
+  ASSERT_OK(uv_udp_bind(&fork_udp_recver, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_set_recv_ring(&fork_udp_recver, 4, 2048));
+  ASSERT_OK(uv_udp_recv_start(&fork_udp_recver, NULL, fork_udp_recv_cb));
+
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &fork_udp_sender));
+  buf = uv_buf_init("PING", 4);
+  ASSERT_EQ(4, uv_udp_try_send(&fork_udp_sender,
+                               &buf,
+                               1,
+                               (const struct sockaddr*) &addr));
+  ASSERT_EQ(1, uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT_EQ(1, fork_udp_recv_cb_called);
+
+#if defined(__APPLE__) && (TARGET_OS_TV || TARGET_OS_WATCH)
+  child_pid = -1;
+#else
+  child_pid = fork();
+#endif
+  ASSERT_NE(child_pid, -1);
+
+  if (child_pid != 0) {
+    /* parent */
+    ASSERT_OK(uv_udp_recv_stop(&fork_udp_recver));
+    ASSERT_OK(uv_udp_recv_ring_release(&fork_udp_recver, &fork_udp_held));
+    uv_close((uv_handle_t*) &fork_udp_recver, NULL);
+    uv_close((uv_handle_t*) &fork_udp_sender, NULL);
+    ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+    ASSERT_EQ(1, write(sync_pipe[1], "1", 1)); /* alert child */
+    assert_wait_child(child_pid);
+  } else {
+    /* child */
+    ASSERT_EQ(1, read(sync_pipe[0], sync_buf, 1)); /* wait for parent */
+    ASSERT_OK(uv_loop_fork(uv_default_loop()));
+    ASSERT_OK(uv_udp_recv_ring_release(&fork_udp_recver, &fork_udp_held));
+    ASSERT_EQ(4, uv_udp_try_send(&fork_udp_sender,
+                                 &buf,
+                                 1,
+                                 (const struct sockaddr*) &addr));
+    ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+    ASSERT_EQ(2, fork_udp_recv_cb_called);
+  }
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
+
+
 static int fork_signal_cb_called;
 
 void fork_signal_to_child_cb(uv_signal_t* handle, int signum)
@@ -107,6 +107,20 @@ TEST_DECLARE   (multiple_listen)
 TEST_DECLARE   (tcp_write_after_connect)
 #endif
 TEST_DECLARE   (tcp_writealot)
+TEST_DECLARE   (tcp_zerocopy)
+TEST_DECLARE   (tcp_zerocopy_close)
+TEST_DECLARE   (tcp_zerocopy_oob)
+TEST_DECLARE   (tcp_zerocopy_close_reset)
+TEST_DECLARE   (tcp_write_cork)
+TEST_DECLARE   (tcp_splice)
+TEST_DECLARE   (tcp_sendfile)
+TEST_DECLARE   (tcp_fastopen)
+TEST_DECLARE   (tcp_write_watermarks)
+TEST_DECLARE   (tcp_info)
+TEST_DECLARE   (tcp_read_start_v)
+TEST_DECLARE   (tcp_framing_prefix)
+TEST_DECLARE   (tcp_framing_delimiter)
+TEST_DECLARE   (tcp_write_nocopy)
 TEST_DECLARE   (tcp_write_fail)
 TEST_DECLARE   (tcp_try_write)
 TEST_DECLARE   (tcp_write_in_a_row)
@@ -183,6 +197,15 @@ TEST_DECLARE   (udp_send_pollerr_no_recv)
 TEST_DECLARE   (udp_mmsg)
 TEST_DECLARE   (udp_mmsg_single_drain_cb)
 TEST_DECLARE   (udp_mmsg_small_buf)
+TEST_DECLARE   (udp_mmsg_batch)
+TEST_DECLARE   (udp_recv_ring)
+TEST_DECLARE   (udp_recv_ring_mmsg)
+TEST_DECLARE   (udp_recv_info)
+TEST_DECLARE   (udp_pacing)
+TEST_DECLARE   (udp_stats)
+TEST_DECLARE   (udp_recv_ring_restart)
+TEST_DECLARE   (udp_send_batch)
+TEST_DECLARE   (udp_reuseport_group)
 TEST_DECLARE   (udp_multicast_join)
 TEST_DECLARE   (udp_multicast_join6)
 TEST_DECLARE   (udp_multicast_ttl)
@@ -206,6 +229,8 @@ TEST_DECLARE   (udp_send_unix)
 TEST_DECLARE   (udp_send_fail_nbufs)
 TEST_DECLARE   (udp_sendmmsg_error)
 TEST_DECLARE   (udp_try_send)
+TEST_DECLARE   (udp_gso)
+TEST_DECLARE   (udp_gro)
 TEST_DECLARE   (pipe_bind_error_addrinuse)
 TEST_DECLARE   (pipe_bind_error_addrnotavail)
 TEST_DECLARE   (pipe_bind_error_inval)
@@ -475,6 +500,9 @@ TEST_DECLARE   (strscpy)
 TEST_DECLARE   (strtok)
 TEST_DECLARE   (threadpool_queue_work_simple)
 TEST_DECLARE   (threadpool_queue_work_einval)
+TEST_DECLARE   (threadpool_queue_work_bulk)
+TEST_DECLARE   (threadpool_cpus)
+TEST_DECLARE   (threadpool_work_limit)
 TEST_DECLARE   (threadpool_multiple_event_loops)
 TEST_DECLARE   (threadpool_cancel_getaddrinfo)
 TEST_DECLARE   (threadpool_cancel_getnameinfo)
@@ -483,6 +511,7 @@ TEST_DECLARE   (threadpool_cancel_work)
 TEST_FS_DECLARE   (threadpool_cancel_fs)
 TEST_DECLARE   (threadpool_cancel_single)
 TEST_DECLARE   (threadpool_cancel_when_busy)
+TEST_DECLARE   (threadpool_cancel_work_bulk)
 TEST_DECLARE   (thread_detach)
 TEST_DECLARE   (thread_local_storage)
 TEST_DECLARE   (thread_stack_size)
@@ -576,6 +605,7 @@ TEST_DECLARE   (readable_on_eof)
 TEST_DECLARE  (fork_timer)
 TEST_DECLARE  (fork_socketpair)
 TEST_DECLARE  (fork_socketpair_started)
+TEST_DECLARE  (fork_udp_recv_ring)
 TEST_DECLARE  (fork_signal_to_child)
 TEST_DECLARE  (fork_signal_to_child_closed)
 TEST_DECLARE  (fork_close_signal_in_child)
@@ -605,6 +635,7 @@ TEST_DECLARE  (metrics_pool_events)
 TEST_DECLARE  (metrics_idle_time)
 TEST_DECLARE  (metrics_idle_time_thread)
 TEST_DECLARE  (metrics_idle_time_zero)
+TEST_DECLARE  (metrics_threadpool)
 
 TASK_LIST_START
   TEST_ENTRY_CUSTOM (platform_output, 0, 1, 5000)
@@ -729,6 +760,21 @@ TASK_LIST_START
 #endif
   TEST_HELPER (tcp_writealot, tcp4_echo_server)
 
+  TEST_ENTRY  (tcp_zerocopy)
+  TEST_ENTRY  (tcp_zerocopy_close)
+  TEST_ENTRY  (tcp_zerocopy_oob)
+  TEST_ENTRY  (tcp_zerocopy_close_reset)
+  TEST_ENTRY  (tcp_write_cork)
+  TEST_ENTRY  (tcp_splice)
+  TEST_ENTRY  (tcp_sendfile)
+  TEST_ENTRY  (tcp_fastopen)
+  TEST_ENTRY  (tcp_write_watermarks)
+  TEST_ENTRY  (tcp_info)
+  TEST_ENTRY  (tcp_read_start_v)
+  TEST_ENTRY  (tcp_framing_prefix)
+  TEST_ENTRY  (tcp_framing_delimiter)
+  TEST_ENTRY  (tcp_write_nocopy)
+
   TEST_ENTRY  (tcp_write_fail)
   TEST_HELPER (tcp_write_fail, tcp4_echo_server)
 
@@ -834,6 +880,15 @@ TASK_LIST_START
   TEST_ENTRY  (udp_mmsg)
   TEST_ENTRY  (udp_mmsg_single_drain_cb)
   TEST_ENTRY  (udp_mmsg_small_buf)
+  TEST_ENTRY  (udp_mmsg_batch)
+  TEST_ENTRY  (udp_recv_ring)
+  TEST_ENTRY  (udp_recv_ring_mmsg)
+  TEST_ENTRY  (udp_recv_info)
+  TEST_ENTRY  (udp_pacing)
+  TEST_ENTRY  (udp_stats)
+  TEST_ENTRY  (udp_recv_ring_restart)
+  TEST_ENTRY  (udp_send_batch)
+  TEST_ENTRY  (udp_reuseport_group)
   TEST_ENTRY  (udp_multicast_interface)
   TEST_ENTRY  (udp_multicast_interface6)
   TEST_ENTRY  (udp_multicast_join)
@@ -842,6 +897,8 @@ TASK_LIST_START
   TEST_ENTRY  (udp_send_fail_nbufs)
   TEST_ENTRY  (udp_sendmmsg_error)
   TEST_ENTRY  (udp_try_send)
+  TEST_ENTRY  (udp_gso)
+  TEST_ENTRY  (udp_gro)
   TEST_ENTRY  (udp_recv_in_a_row)
   TEST_ENTRY  (udp_reuseport)
 
@@ -1212,6 +1269,9 @@ TASK_LIST_START
   TEST_ENTRY  (strtok)
   TEST_ENTRY  (threadpool_queue_work_simple)
   TEST_ENTRY  (threadpool_queue_work_einval)
+  TEST_ENTRY  (threadpool_queue_work_bulk)
+  TEST_ENTRY  (threadpool_cpus)
+  TEST_ENTRY  (threadpool_work_limit)
   TEST_ENTRY_CUSTOM (threadpool_multiple_event_loops, 0, 0, 60000)
   TEST_ENTRY  (threadpool_cancel_getaddrinfo)
   TEST_ENTRY  (threadpool_cancel_getnameinfo)
@@ -1220,6 +1280,7 @@ TASK_LIST_START
   TEST_FS_ENTRY  (threadpool_cancel_fs)
   TEST_ENTRY  (threadpool_cancel_single)
   TEST_ENTRY  (threadpool_cancel_when_busy)
+  TEST_ENTRY  (threadpool_cancel_work_bulk)
   TEST_ENTRY  (thread_detach)
   TEST_ENTRY  (thread_local_storage)
   TEST_ENTRY  (thread_stack_size)
@@ -1252,6 +1313,7 @@ TASK_LIST_START
   TEST_ENTRY  (fork_timer)
   TEST_ENTRY  (fork_socketpair)
   TEST_ENTRY  (fork_socketpair_started)
+  TEST_ENTRY  (fork_udp_recv_ring)
   TEST_ENTRY  (fork_signal_to_child)
   TEST_ENTRY  (fork_signal_to_child_closed)
   TEST_ENTRY  (fork_close_signal_in_child)
@@ -1290,6 +1352,7 @@ TASK_LIST_START
   TEST_ENTRY  (metrics_idle_time)
   TEST_ENTRY  (metrics_idle_time_thread)
   TEST_ENTRY  (metrics_idle_time_zero)
+  TEST_ENTRY  (metrics_threadpool)
 
 #if 0
   /* These are for testing the test runner. */
@@ -388,3 +388,90 @@ TEST_IMPL(metrics_pool_events) {
   MAKE_VALGRIND_HAPPY(uv_default_loop());
   return 0;
 }
+
+
+static int threadpool_work_count;
+
+
+static void threadpool_work_cb(uv_work_t* req) {
+  uv_sleep(1);
+}
+
+
+static void threadpool_after_work_cb(uv_work_t* req, int status) {
+  uv_work_metrics_t m;
+
+  ASSERT_OK(status);
+  ASSERT_OK(uv_threadpool_work_metrics(req->loop, UV_WORK_CPU, &m));
+  ASSERT_GE(m.completed, 1);
+  ASSERT_LE(m.completed, 8);
+  ASSERT_EQ(8, m.submitted);
+  threadpool_work_count++;
+}
+
+
+TEST_IMPL(metrics_threadpool) {
+  uv_threadpool_metrics_t metrics;
+  uv_work_metrics_t m;
+  uv_work_t reqs[8];
+  uv_loop_t loop;
+  uint64_t nwait;
+  uint64_t nrun;
+  unsigned int i;
+
+  ASSERT_OK(uv_loop_init(&loop));
+
+  ASSERT_OK(uv_threadpool_metrics(&metrics));
+  ASSERT_GT(metrics.nthreads, 0);
+  for (i = 0; i < UV_WORK_KIND_MAX; i++) {
+    ASSERT_OK(uv_threadpool_work_metrics(&loop, (uv_work_kind) i, &m));
+    ASSERT_OK(m.submitted);
+  }
+
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    ASSERT_OK(uv_queue_work(&loop,
+                            &reqs[i],
+                            threadpool_work_cb,
+                            threadpool_after_work_cb));
+
+  ASSERT_OK(uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(8, threadpool_work_count);
+
+  ASSERT_OK(uv_threadpool_work_metrics(&loop, UV_WORK_CPU, &m));
+  ASSERT_EQ(8, m.submitted);
+  ASSERT_EQ(8, m.completed);
+  ASSERT_OK(m.queued);
+  ASSERT_OK(m.running);
+  ASSERT_OK(m.cancelled);
+  ASSERT_GE(m.run_time, 8 * 1000 * 1000);
+
+  nwait = 0;
+  nrun = 0;
+  for (i = 0; i < UV_WORK_HISTOGRAM_SIZE; i++) {
+    nwait += m.wait_histogram[i];
+    nrun += m.run_histogram[i];
+  }
+  ASSERT_EQ(8, nwait);
+  ASSERT_EQ(8, nrun);
+
+  ASSERT_OK(uv_threadpool_work_metrics(&loop, UV_WORK_FAST_IO, &m));
+  ASSERT_OK(m.submitted);
+  ASSERT_OK(uv_threadpool_work_metrics(&loop, UV_WORK_SLOW_IO, &m));
+  ASSERT_OK(m.submitted);
+
+  /* The pool-wide view includes this loop's work. Its completion counters
+   * are updated after the request has been handed back to the loop, so they
+   * may still lag behind.
+   */
+  ASSERT_OK(uv_threadpool_work_metrics(NULL, UV_WORK_CPU, &m));
+  ASSERT_GE(m.submitted, 8);
+  ASSERT_OK(uv_threadpool_metrics(&metrics));
+  ASSERT_LE(metrics.busy_threads, metrics.nthreads);
+
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_metrics(NULL));
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_work_metrics(&loop, UV_WORK_CPU, NULL));
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_work_metrics(&loop, UV_WORK_KIND_MAX, &m));
+
+  MAKE_VALGRIND_HAPPY(&loop);
+  return 0;
+}
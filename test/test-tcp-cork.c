@@ -0,0 +1,158 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_WRITES 4
+
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t incoming;
+static uv_check_t check_handle;
+static uv_connect_t connect_req;
+static uv_shutdown_t shutdown_req;
+static uv_write_t write_reqs[NUM_WRITES];
+static char received[64];
+static size_t bytes_received;
+static int write_cb_called;
+static int check_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = received + bytes_received;
+  buf->len = sizeof(received) - bytes_received;
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  if (nread == UV_EOF) {
+    uv_close((uv_handle_t*) stream, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    return;
+  }
+
+  ASSERT_GE(nread, 0);
+  bytes_received += nread;
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &incoming, alloc_cb, read_cb));
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  ASSERT_PTR_EQ(req, &write_reqs[write_cb_called]);
+  write_cb_called++;
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  ASSERT_EQ(NUM_WRITES, write_cb_called);
+  uv_close((uv_handle_t*) req->handle, close_cb);
+}
+
+
+static void check_cb(uv_check_t* handle) {
+  /* The corked data went out before the check handles ran. */
+  ASSERT_OK(uv_stream_get_write_queue_size((uv_stream_t*) &client));
+  check_cb_called++;
+  uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+static void do_write(uv_stream_t* stream, int i, const char* data) {
+  uv_buf_t buf;
+
+  buf = uv_buf_init((char*) data, strlen(data));
+  ASSERT_OK(uv_write(&write_reqs[i], stream, &buf, 1, write_cb));
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_stream_t* stream;
+
+  ASSERT_OK(status);
+  stream = req->handle;
+
+  /* Held back until the check phase of this loop iteration. */
+  do_write(stream, 0, "abc");
+  do_write(stream, 1, "def");
+  ASSERT_EQ(6, uv_stream_get_write_queue_size(stream));
+  ASSERT_OK(write_cb_called);
+
+  /* Crossing the threshold flushes right away. */
+  do_write(stream, 2, "ghi");
+  ASSERT_OK(uv_stream_get_write_queue_size(stream));
+
+  do_write(stream, 3, "jkl");
+  ASSERT_EQ(3, uv_stream_get_write_queue_size(stream));
+
+  ASSERT_OK(uv_shutdown(&shutdown_req, stream, shutdown_cb));
+
+  ASSERT_OK(uv_check_init(stream->loop, &check_handle));
+  ASSERT_OK(uv_check_start(&check_handle, check_cb));
+}
+
+
+TEST_IMPL(tcp_write_cork) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_OK(uv_stream_set_cork((uv_stream_t*) &client, 1, 8));
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(NUM_WRITES, write_cb_called);
+  ASSERT_EQ(1, check_cb_called);
+  ASSERT_EQ(4, close_cb_called);
+  ASSERT_EQ(12, bytes_received);
+  ASSERT_MEM_EQ(received, "abcdefghijkl", 12);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
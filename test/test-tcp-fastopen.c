@@ -0,0 +1,205 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_ROUNDS 2
+
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t incoming;
+static uv_connect_t connect_req;
+static uv_write_t client_write_req;
+static uv_write_t server_write_req;
+static struct sockaddr_in addr;
+static int server_accepted[NUM_ROUNDS];
+static int client_accepted[NUM_ROUNDS];
+static int round_num;
+static int connect_cb_called;
+static int pong_received;
+static int close_cb_called;
+static char buffer[16];
+
+
+static void start_round(uv_loop_t* loop);
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+
+  if (handle != (uv_handle_t*) &client)
+    return;
+
+  if (++round_num < NUM_ROUNDS)
+    start_round(handle->loop);
+  else
+    uv_close((uv_handle_t*) &server, close_cb);
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = buffer;
+  buf->len = sizeof(buffer);
+}
+
+
+static void server_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  uv_buf_t reply;
+
+  if (nread == UV_EOF) {
+    uv_close((uv_handle_t*) stream, close_cb);
+    return;
+  }
+
+  ASSERT_EQ(4, nread);
+  ASSERT_MEM_EQ(buf->base, "ping", 4);
+
+  reply = uv_buf_init("pong", 4);
+  ASSERT_OK(uv_write(&server_write_req, stream, &reply, 1, NULL));
+}
+
+
+static void client_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  ASSERT_EQ(4, nread);
+  ASSERT_MEM_EQ(buf->base, "pong", 4);
+  pong_received++;
+
+  /* The handshake has completed by now. */
+  client_accepted[round_num] = uv_tcp_fastopen_accepted((uv_tcp_t*) stream);
+  ASSERT_GE(client_accepted[round_num], 0);
+
+  uv_close((uv_handle_t*) stream, close_cb);
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+
+  server_accepted[round_num] = uv_tcp_fastopen_accepted(&incoming);
+  ASSERT_GE(server_accepted[round_num], 0);
+
+  ASSERT_OK(uv_read_start((uv_stream_t*) &incoming,
+                          alloc_cb,
+                          server_read_cb));
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  ASSERT_OK(status);
+  connect_cb_called++;
+  ASSERT_OK(uv_read_start(req->handle, alloc_cb, client_read_cb));
+}
+
+
+static void start_round(uv_loop_t* loop) {
+  uv_buf_t buf;
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_OK(uv_tcp_connect2(&connect_req,
+                            &client,
+                            (const struct sockaddr*) &addr,
+                            UV_TCP_FASTOPEN,
+                            connect_cb));
+
+  /* Queued until the connection is set up, then sent with the SYN. */
+  buf = uv_buf_init("ping", 4);
+  ASSERT_OK(uv_write(&client_write_req,
+                     (uv_stream_t*) &client,
+                     &buf,
+                     1,
+                     NULL));
+}
+
+
+static int fastopen_enabled(void) {
+  FILE* fp;
+  int val;
+
+  /* Client (1) and server (2) support. */
+  fp = fopen("/proc/sys/net/ipv4/tcp_fastopen", "r");
+  if (fp == NULL)
+    return 0;
+
+  if (fscanf(fp, "%d", &val) != 1)
+    val = 0;
+
+  fclose(fp);
+  return (val & 3) == 3;
+}
+
+
+TEST_IMPL(tcp_fastopen) {
+#if !defined(__linux__)
+  RETURN_SKIP("TCP Fast Open is only supported on Linux");
+#else
+  uv_connect_t req;
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_EQ(UV_EINVAL, uv_tcp_connect2(&req,
+                                       &client,
+                                       (const struct sockaddr*) &addr,
+                                       UV_TCP_REUSEPORT,
+                                       connect_cb));
+  uv_close((uv_handle_t*) &client, NULL);
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server,
+                        (const struct sockaddr*) &addr,
+                        UV_TCP_FASTOPEN));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 16, connection_cb));
+
+  start_round(loop);
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(NUM_ROUNDS, connect_cb_called);
+  ASSERT_EQ(NUM_ROUNDS, pong_received);
+  ASSERT_EQ(2 * NUM_ROUNDS + 1, close_cb_called);
+
+  /* The first round fetched a cookie, unless an earlier run left one in the
+   * kernel's cache. The second round must have used it.
+   */
+  if (fastopen_enabled()) {
+    ASSERT_EQ(1, client_accepted[1]);
+    ASSERT_EQ(1, server_accepted[1]);
+  } else {
+    ASSERT_OK(client_accepted[1]);
+    ASSERT_OK(server_accepted[1]);
+  }
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+#endif
+}
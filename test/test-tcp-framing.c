@@ -0,0 +1,243 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+static uv_tcp_t server;
+static uv_tcp_t conn;
+static uv_tcp_t client;
+static uv_connect_t connect_req;
+static uv_write_t write_req;
+static uv_timer_t timer;
+static uv_stream_framing_t framing;
+
+static const char* data;
+static const size_t* pieces;
+static const char* const* frames;
+static const size_t* frame_sizes;
+static size_t npieces;
+static size_t nframes;
+static size_t piece;
+static size_t offset;
+static size_t frames_read;
+static int error_read;
+static int expect_error;
+static int client_eof;
+
+
+static void close_cb(uv_handle_t* handle) {
+}
+
+
+static void fail_alloc_cb(uv_handle_t* handle,
+                          size_t suggested_size,
+                          uv_buf_t* buf) {
+  /* Framed streams read into their own buffer. */
+  ASSERT(0 && "alloc_cb called");
+}
+
+
+static void client_alloc_cb(uv_handle_t* handle,
+                            size_t suggested_size,
+                            uv_buf_t* buf) {
+  static char slab[64];
+  *buf = uv_buf_init(slab, sizeof(slab));
+}
+
+
+static void client_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  ASSERT_EQ(nread, UV_EOF);
+  client_eof++;
+  uv_close((uv_handle_t*) stream, close_cb);
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  if (piece == npieces)
+    return;
+
+  /* One piece per write so that the frames trickle in. */
+  buf = uv_buf_init((char*) data + offset, pieces[piece]);
+  offset += pieces[piece++];
+  ASSERT_OK(uv_write(&write_req, (uv_stream_t*) &client, &buf, 1, write_cb));
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_read_start((uv_stream_t*) &client,
+                          client_alloc_cb,
+                          client_read_cb));
+  write_cb(&write_req, 0);
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf);
+
+
+static void timer_cb(uv_timer_t* handle) {
+  ASSERT_OK(uv_read_start((uv_stream_t*) &conn, fail_alloc_cb, read_cb));
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  if (nread < 0) {
+    ASSERT_EQ(nread, UV_EMSGSIZE);
+    error_read++;
+  } else {
+    ASSERT_LT(frames_read, nframes);
+    ASSERT_EQ(nread, frame_sizes[frames_read]);
+    ASSERT_OK(memcmp(buf->base, frames[frames_read], nread));
+    frames_read++;
+
+    if (frames_read == 1) {
+      /* The rest of the frames must survive a read stop. */
+      ASSERT_OK(uv_read_stop(stream));
+      ASSERT_OK(uv_timer_start(&timer, timer_cb, 0, 0));
+      return;
+    }
+
+    if (frames_read < nframes || expect_error)
+      return;
+  }
+
+  uv_close((uv_handle_t*) stream, close_cb);
+  uv_close((uv_handle_t*) &server, close_cb);
+  uv_close((uv_handle_t*) &timer, close_cb);
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  uv_stream_framing_t bad;
+
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &conn));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &conn));
+
+  bad = framing;
+  bad.type = UV_FRAMING_PREFIX;
+  bad.prefix_size = 3;
+  ASSERT_EQ(UV_EINVAL, uv_stream_set_framing((uv_stream_t*) &conn, &bad));
+
+  ASSERT_OK(uv_stream_set_framing((uv_stream_t*) &conn, &framing));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &conn, fail_alloc_cb, read_cb));
+  ASSERT_EQ(UV_EBUSY, uv_stream_set_framing((uv_stream_t*) &conn, NULL));
+}
+
+
+static void run_framing_test(void) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 128, connection_cb));
+  ASSERT_OK(uv_timer_init(loop, &timer));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(frames_read, nframes);
+  ASSERT_EQ(1, client_eof);
+
+  MAKE_VALGRIND_HAPPY(loop);
+}
+
+
+TEST_IMPL(tcp_framing_prefix) {
+  static const char prefix_data[] =
+      "\x00\x05hello" "\x00\x00" "\x00\x06world!" "\x01\x00";
+  static const size_t prefix_pieces[] = { 1, 4, 5, 7, 2 };
+  static const char* const prefix_frames[] = {
+    "\x00\x05hello", "\x00\x00", "\x00\x06world!"
+  };
+  static const size_t prefix_frame_sizes[] = { 7, 2, 8 };
+
+#ifdef _WIN32
+  RETURN_SKIP("Stream framing is not supported on Windows");
+#endif
+
+  memset(&framing, 0, sizeof(framing));
+  framing.type = UV_FRAMING_PREFIX;
+  framing.flags = UV_FRAMING_BIG_ENDIAN;
+  framing.prefix_size = 2;
+  framing.max_frame_size = 64;
+
+  data = prefix_data;
+  pieces = prefix_pieces;
+  npieces = ARRAY_SIZE(prefix_pieces);
+  frames = prefix_frames;
+  frame_sizes = prefix_frame_sizes;
+  nframes = ARRAY_SIZE(prefix_frames);
+  expect_error = 1;
+
+  run_framing_test();
+
+  /* The last prefix announces a frame over max_frame_size. */
+  ASSERT_EQ(1, error_read);
+
+  return 0;
+}
+
+
+TEST_IMPL(tcp_framing_delimiter) {
+  static const char* const delimiter_frames[] = { "a\n", "bb\n", "ccc\n" };
+  static const size_t delimiter_frame_sizes[] = { 2, 3, 4 };
+  static const size_t delimiter_pieces[] = { 1, 6, 2 };
+
+#ifdef _WIN32
+  RETURN_SKIP("Stream framing is not supported on Windows");
+#endif
+
+  memset(&framing, 0, sizeof(framing));
+  framing.type = UV_FRAMING_DELIMITER;
+  framing.delimiter = '\n';
+
+  data = "a\nbb\nccc\n";
+  pieces = delimiter_pieces;
+  npieces = ARRAY_SIZE(delimiter_pieces);
+  frames = delimiter_frames;
+  frame_sizes = delimiter_frame_sizes;
+  nframes = ARRAY_SIZE(delimiter_frames);
+
+  run_framing_test();
+
+  ASSERT_OK(error_read);
+
+  return 0;
+}
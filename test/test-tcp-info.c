@@ -0,0 +1,147 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define DATA_SIZE (256 * 1024)
+
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t incoming;
+static uv_connect_t connect_req;
+static uv_write_t write_req;
+static uv_shutdown_t shutdown_req;
+static char data[DATA_SIZE];
+static char read_buf[64 * 1024];
+static size_t bytes_received;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = read_buf;
+  buf->len = sizeof(read_buf);
+}
+
+
+static void server_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  uv_tcp_info_t info;
+
+  if (nread != UV_EOF) {
+    ASSERT_GT(nread, 0);
+    bytes_received += nread;
+    return;
+  }
+
+  ASSERT_EQ(DATA_SIZE, bytes_received);
+  ASSERT_OK(uv_tcp_get_info((uv_tcp_t*) stream, &info));
+  ASSERT_GE(info.bytes_received, DATA_SIZE);
+  ASSERT_GT(info.mss, 0);
+
+  uv_close((uv_handle_t*) stream, close_cb);
+  uv_close((uv_handle_t*) &server, close_cb);
+}
+
+
+static void client_read_cb(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf) {
+  uv_tcp_info_t info;
+
+  ASSERT_EQ(nread, UV_EOF);
+
+  /* The peer has read everything so all of it has been acknowledged. */
+  ASSERT_OK(uv_tcp_get_info((uv_tcp_t*) stream, &info));
+  ASSERT_GE(info.bytes_sent, DATA_SIZE);
+  ASSERT_GE(info.bytes_acked, DATA_SIZE);
+  ASSERT_GT(info.rtt, 0);
+  ASSERT_GT(info.cwnd, 0);
+  ASSERT_GT(info.mss, 0);
+  ASSERT_OK(info.notsent_bytes);
+
+  uv_close((uv_handle_t*) stream, close_cb);
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &incoming,
+                          alloc_cb,
+                          server_read_cb));
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  buf = uv_buf_init(data, sizeof(data));
+  ASSERT_OK(uv_write(&write_req, req->handle, &buf, 1, NULL));
+  ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, NULL));
+  ASSERT_OK(uv_read_start(req->handle, alloc_cb, client_read_cb));
+}
+
+
+TEST_IMPL(tcp_info) {
+  struct sockaddr_in addr;
+  uv_tcp_info_t info;
+  uv_loop_t* loop;
+  int r;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  r = uv_tcp_get_info(&client, &info);
+  if (r == UV_ENOTSUP)
+    RETURN_SKIP("uv_tcp_get_info() is not supported on this platform");
+
+  /* No socket yet. */
+  ASSERT_EQ(r, UV_EBADF);
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(3, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -0,0 +1,170 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DATA_SIZE (1024 * 1024)
+#define BUF_SIZE 4096
+
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t incoming;
+static uv_connect_t connect_req;
+static uv_write_t write_req;
+static uv_shutdown_t shutdown_req;
+static char send_data[DATA_SIZE];
+static char recv_data[DATA_SIZE];
+static size_t bytes_received;
+static unsigned int max_nbufs;
+static int alloc_cb_called;
+static int bufs_released;
+static int read_cb_called;
+static int eof_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = malloc(BUF_SIZE);
+  buf->len = BUF_SIZE;
+  ASSERT_NOT_NULL(buf->base);
+  alloc_cb_called++;
+}
+
+
+static void read_cb(uv_stream_t* stream,
+                    ssize_t nread,
+                    const uv_buf_t bufs[],
+                    unsigned int nbufs) {
+  unsigned int i;
+  size_t total;
+
+  read_cb_called++;
+
+  total = 0;
+  for (i = 0; i < nbufs; i++) {
+    if (nread > 0) {
+      ASSERT_LE(bytes_received + total + bufs[i].len, DATA_SIZE);
+      memcpy(recv_data + bytes_received + total, bufs[i].base, bufs[i].len);
+      total += bufs[i].len;
+    }
+
+    if (bufs[i].base != NULL) {
+      free(bufs[i].base);
+      bufs_released++;
+    }
+  }
+
+  if (nread == UV_EOF) {
+    eof_cb_called++;
+    uv_close((uv_handle_t*) stream, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    return;
+  }
+
+  ASSERT_GE(nread, 0);
+  ASSERT_EQ(nread, total);
+  bytes_received += total;
+
+  if (nbufs > max_nbufs)
+    max_nbufs = nbufs;
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+  ASSERT_OK(uv_read_start_v((uv_stream_t*) &incoming, alloc_cb, read_cb));
+  ASSERT_EQ(UV_EALREADY,
+            uv_read_start_v((uv_stream_t*) &incoming, alloc_cb, read_cb));
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  uv_close((uv_handle_t*) req->handle, close_cb);
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  buf = uv_buf_init(send_data, sizeof(send_data));
+  ASSERT_OK(uv_write(&write_req, req->handle, &buf, 1, NULL));
+  ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, shutdown_cb));
+}
+
+
+TEST_IMPL(tcp_read_start_v) {
+#ifdef _WIN32
+  RETURN_SKIP("Not supported on Windows");
+#else
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  size_t i;
+
+  for (i = 0; i < sizeof(send_data); i++)
+    send_data[i] = (char) (i * 13 + (i >> 12));
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_EQ(UV_ENOTCONN,
+            uv_read_start_v((uv_stream_t*) &client, alloc_cb, read_cb));
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, eof_cb_called);
+  ASSERT_EQ(3, close_cb_called);
+  ASSERT_EQ(DATA_SIZE, bytes_received);
+  ASSERT_OK(memcmp(send_data, recv_data, DATA_SIZE));
+
+  /* Several reads were handed over per callback, and every buffer came back
+   * to be released.
+   */
+  ASSERT_GT(max_nbufs, 1);
+  ASSERT_LT(read_cb_called, DATA_SIZE / BUF_SIZE);
+  ASSERT_EQ(alloc_cb_called, bufs_released);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+#endif
+}
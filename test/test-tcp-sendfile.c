@@ -0,0 +1,177 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define FILE_NAME "test_file_sendfile"
+#define FILE_SIZE (512 * 1024)
+#define SEND_OFFSET 100
+#define SEND_SIZE (300 * 1000)
+
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t incoming;
+static uv_connect_t connect_req;
+static uv_shutdown_t shutdown_req;
+static uv_write_t write_reqs[3];
+static uv_file file;
+static char file_data[FILE_SIZE];
+static char received[SEND_SIZE + 9];
+static size_t bytes_received;
+static int write_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = received + bytes_received;
+  buf->len = sizeof(received) - bytes_received;
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  if (nread == UV_EOF) {
+    uv_close((uv_handle_t*) stream, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    return;
+  }
+
+  ASSERT_GT(nread, 0);
+  bytes_received += nread;
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &incoming, alloc_cb, read_cb));
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  /* Completes in order with the surrounding writes. */
+  ASSERT_PTR_EQ(req, &write_reqs[write_cb_called]);
+  write_cb_called++;
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  ASSERT_EQ(3, write_cb_called);
+  uv_close((uv_handle_t*) req->handle, close_cb);
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_stream_t* stream;
+  uv_write_t invalid_req;
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+  stream = req->handle;
+
+  ASSERT_EQ(UV_EINVAL, uv_stream_sendfile(&invalid_req,
+                                          stream,
+                                          file,
+                                          -1,
+                                          SEND_SIZE,
+                                          write_cb));
+
+  buf = uv_buf_init("HEAD", 4);
+  ASSERT_OK(uv_write(&write_reqs[0], stream, &buf, 1, write_cb));
+  ASSERT_OK(uv_stream_sendfile(&write_reqs[1],
+                               stream,
+                               file,
+                               SEND_OFFSET,
+                               SEND_SIZE,
+                               write_cb));
+  buf = uv_buf_init("TAIL", 4);
+  ASSERT_OK(uv_write(&write_reqs[2], stream, &buf, 1, write_cb));
+  ASSERT_OK(uv_shutdown(&shutdown_req, stream, shutdown_cb));
+}
+
+
+TEST_IMPL(tcp_sendfile) {
+#if !defined(__linux__)
+  RETURN_SKIP("uv_stream_sendfile() is only supported on Linux");
+#else
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uv_fs_t req;
+  uv_buf_t buf;
+  size_t i;
+
+  loop = uv_default_loop();
+
+  for (i = 0; i < sizeof(file_data); i++)
+    file_data[i] = (char) (i * 7 + (i >> 10));
+
+  uv_fs_unlink(NULL, &req, FILE_NAME, NULL);
+  uv_fs_req_cleanup(&req);
+
+  file = uv_fs_open(NULL, &req, FILE_NAME, UV_FS_O_RDWR | UV_FS_O_CREAT,
+                    S_IWUSR | S_IRUSR, NULL);
+  ASSERT_GE(file, 0);
+  uv_fs_req_cleanup(&req);
+
+  buf = uv_buf_init(file_data, sizeof(file_data));
+  ASSERT_EQ(sizeof(file_data), uv_fs_write(NULL, &req, file, &buf, 1, 0, NULL));
+  uv_fs_req_cleanup(&req);
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(3, write_cb_called);
+  ASSERT_EQ(3, close_cb_called);
+  ASSERT_EQ(SEND_SIZE + 8, bytes_received);
+  ASSERT_MEM_EQ(received, "HEAD", 4);
+  ASSERT_OK(memcmp(received + 4, file_data + SEND_OFFSET, SEND_SIZE));
+  ASSERT_MEM_EQ(received + 4 + SEND_SIZE, "TAIL", 4);
+
+  ASSERT_OK(uv_fs_close(NULL, &req, file, NULL));
+  uv_fs_req_cleanup(&req);
+  ASSERT_OK(uv_fs_unlink(NULL, &req, FILE_NAME, NULL));
+  uv_fs_req_cleanup(&req);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+#endif
+}
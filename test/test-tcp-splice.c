@@ -0,0 +1,201 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define DATA_SIZE (256 * 1024)
+
+/* Data written to client1 is spliced from incoming1 into incoming2 and read
+ * back from client2.
+ */
+static uv_tcp_t server;
+static uv_tcp_t client1;
+static uv_tcp_t client2;
+static uv_tcp_t incoming1;
+static uv_tcp_t incoming2;
+static uv_connect_t connect_req1;
+static uv_connect_t connect_req2;
+static uv_write_t write_req;
+static uv_shutdown_t shutdown_req1;
+static uv_shutdown_t shutdown_req2;
+static uv_splice_t splice_req;
+static char send_data[DATA_SIZE];
+static char recv_data[DATA_SIZE + 1];
+static size_t bytes_received;
+static int connection_cb_called;
+static int write_cb_called;
+static int splice_cb_called;
+static int shutdown_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = recv_data + bytes_received;
+  buf->len = sizeof(recv_data) - bytes_received;
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  if (nread == UV_EOF) {
+    uv_close((uv_handle_t*) stream, close_cb);
+    return;
+  }
+
+  ASSERT_GT(nread, 0);
+  bytes_received += nread;
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  shutdown_cb_called++;
+
+  if (req == &shutdown_req2)
+    uv_close((uv_handle_t*) req->handle, close_cb);
+}
+
+
+static void splice_cb(uv_splice_t* req, int status) {
+  ASSERT_PTR_EQ(req, &splice_req);
+  ASSERT_OK(status);
+  ASSERT_EQ(DATA_SIZE, req->nbytes);
+  splice_cb_called++;
+
+  ASSERT_OK(uv_shutdown(&shutdown_req2, req->dst, shutdown_cb));
+  uv_close((uv_handle_t*) req->src, close_cb);
+  uv_close((uv_handle_t*) &client1, close_cb);
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  write_cb_called++;
+}
+
+
+static void connect1_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+  buf = uv_buf_init(send_data, sizeof(send_data));
+  ASSERT_OK(uv_write(&write_req, req->handle, &buf, 1, write_cb));
+  ASSERT_OK(uv_shutdown(&shutdown_req1, req->handle, shutdown_cb));
+}
+
+
+static void connect2_cb(uv_connect_t* req, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_read_start(req->handle, alloc_cb, read_cb));
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  struct sockaddr_in addr;
+  uv_write_t req;
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  if (connection_cb_called++ == 0) {
+    ASSERT_OK(uv_tcp_init(stream->loop, &incoming1));
+    ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming1));
+
+    /* Connect the second client only now so the accept order is known. */
+    ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+    ASSERT_OK(uv_tcp_connect(&connect_req2,
+                             &client2,
+                             (const struct sockaddr*) &addr,
+                             connect2_cb));
+    return;
+  }
+
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming2));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming2));
+  uv_close((uv_handle_t*) stream, close_cb);
+
+  ASSERT_EQ(UV_EINVAL, uv_stream_splice(&splice_req,
+                                        (uv_stream_t*) &incoming1,
+                                        (uv_stream_t*) &incoming1,
+                                        splice_cb));
+  ASSERT_OK(uv_stream_splice(&splice_req,
+                             (uv_stream_t*) &incoming1,
+                             (uv_stream_t*) &incoming2,
+                             splice_cb));
+
+  /* Both streams belong to the splice until it completes. */
+  ASSERT_EQ(UV_EBUSY, uv_read_start((uv_stream_t*) &incoming1,
+                                    alloc_cb,
+                                    read_cb));
+  buf = uv_buf_init("x", 1);
+  ASSERT_EQ(UV_EBUSY, uv_write(&req, (uv_stream_t*) &incoming2, &buf, 1, NULL));
+  ASSERT_EQ(UV_EBUSY, uv_shutdown(&shutdown_req2,
+                                  (uv_stream_t*) &incoming2,
+                                  shutdown_cb));
+}
+
+
+TEST_IMPL(tcp_splice) {
+#if !defined(__linux__)
+  RETURN_SKIP("splice(2) is only available on Linux");
+#else
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  size_t i;
+
+  for (i = 0; i < sizeof(send_data); i++)
+    send_data[i] = (char) (i * 31 + (i >> 8));
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 2, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client1));
+  ASSERT_OK(uv_tcp_init(loop, &client2));
+  ASSERT_OK(uv_tcp_connect(&connect_req1,
+                           &client1,
+                           (const struct sockaddr*) &addr,
+                           connect1_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(2, connection_cb_called);
+  ASSERT_EQ(1, write_cb_called);
+  ASSERT_EQ(1, splice_cb_called);
+  ASSERT_EQ(2, shutdown_cb_called);
+  ASSERT_EQ(5, close_cb_called);
+  ASSERT_EQ(DATA_SIZE, bytes_received);
+  ASSERT_OK(memcmp(send_data, recv_data, DATA_SIZE));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+#endif
+}
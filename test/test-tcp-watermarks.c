@@ -0,0 +1,179 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_SIZE (64 * 1024)
+#define MAX_WRITES 4096
+#define LOW_WATERMARK (128 * 1024)
+#define HIGH_WATERMARK (512 * 1024)
+
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t incoming;
+static uv_connect_t connect_req;
+static uv_shutdown_t shutdown_req;
+static char chunk[CHUNK_SIZE];
+static char read_buf[CHUNK_SIZE];
+static int writes_started;
+static int write_cb_called;
+static int above_cb_called;
+static int below_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  buf->base = read_buf;
+  buf->len = sizeof(read_buf);
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  if (nread == UV_EOF) {
+    uv_close((uv_handle_t*) stream, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    return;
+  }
+
+  ASSERT_GE(nread, 0);
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  /* Don't read yet so that the client's write queue fills up. */
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  write_cb_called++;
+  free(req);
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+  uv_close((uv_handle_t*) req->handle, close_cb);
+}
+
+
+static void watermark_cb(uv_stream_t* stream, int above) {
+  size_t size;
+
+  size = uv_stream_get_write_queue_size(stream);
+
+  if (above) {
+    ASSERT_OK(above_cb_called);
+    ASSERT_GE(size, HIGH_WATERMARK);
+    above_cb_called++;
+
+    ASSERT_OK(uv_read_start((uv_stream_t*) &incoming, alloc_cb, read_cb));
+    return;
+  }
+
+  ASSERT_EQ(1, above_cb_called);
+  ASSERT_OK(below_cb_called);
+  ASSERT_LE(size, LOW_WATERMARK);
+  below_cb_called++;
+
+  ASSERT_OK(uv_shutdown(&shutdown_req, stream, shutdown_cb));
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_write_t* write_req;
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  /* Fill the write queue past the high watermark. The callback is made on
+   * the next loop iteration, not from within uv_write(). Leave some slack
+   * for what the kernel still takes until then.
+   */
+  buf = uv_buf_init(chunk, sizeof(chunk));
+  while (uv_stream_get_write_queue_size(req->handle) <
+         HIGH_WATERMARK + 4 * CHUNK_SIZE) {
+    ASSERT_LT(writes_started, MAX_WRITES);
+    write_req = malloc(sizeof(*write_req));
+    ASSERT_NOT_NULL(write_req);
+    ASSERT_OK(uv_write(write_req, req->handle, &buf, 1, write_cb));
+    writes_started++;
+    ASSERT_OK(above_cb_called);
+  }
+}
+
+
+TEST_IMPL(tcp_write_watermarks) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  int r;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_EQ(UV_EINVAL, uv_stream_set_watermarks((uv_stream_t*) &client,
+                                                HIGH_WATERMARK,
+                                                LOW_WATERMARK,
+                                                watermark_cb));
+  r = uv_stream_set_watermarks((uv_stream_t*) &client,
+                               LOW_WATERMARK,
+                               HIGH_WATERMARK,
+                               watermark_cb);
+  if (r == UV_ENOTSUP)
+    RETURN_SKIP("Write queue watermarks are not supported on this platform");
+  ASSERT_OK(r);
+
+  /* Keep most of the data in the write queue rather than in the kernel. */
+  r = uv_tcp_notsent_lowat(&client, 16 * 1024);
+  ASSERT(r == 0 || r == UV_ENOTSUP);
+
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, above_cb_called);
+  ASSERT_EQ(1, below_cb_called);
+  ASSERT_EQ(writes_started, write_cb_called);
+  ASSERT_EQ(3, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
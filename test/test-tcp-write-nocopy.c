@@ -0,0 +1,139 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_BUFS  32
+#define BUF_SIZE  (64 * 1024)
+
+static uv_tcp_t server;
+static uv_tcp_t conn;
+static uv_tcp_t client;
+static uv_connect_t connect_req;
+static uv_write_t write_req;
+static uv_buf_t bufs[NUM_BUFS];
+static char data[NUM_BUFS][BUF_SIZE];
+static char slab[BUF_SIZE];
+static size_t bytes_read;
+static int write_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  *buf = uv_buf_init(slab, sizeof(slab));
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  ssize_t i;
+
+  if (nread == UV_EOF) {
+    ASSERT_EQ(bytes_read, NUM_BUFS * BUF_SIZE);
+    uv_close((uv_handle_t*) stream, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    return;
+  }
+
+  ASSERT_GE(nread, 0);
+
+  /* Buffer i is filled with the byte i, check that nothing got reordered. */
+  for (i = 0; i < nread; i++, bytes_read++)
+    ASSERT_EQ(buf->base[i], (char) (bytes_read / BUF_SIZE));
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &conn));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &conn));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &conn, alloc_cb, read_cb));
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  write_cb_called++;
+  uv_close((uv_handle_t*) req->handle, close_cb);
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  unsigned int i;
+  int size;
+
+  ASSERT_OK(status);
+
+  size = 16 * 1024;
+  ASSERT_OK(uv_send_buffer_size((uv_handle_t*) req->handle, &size));
+
+  for (i = 0; i < NUM_BUFS; i++) {
+    memset(data[i], i, BUF_SIZE);
+    bufs[i] = uv_buf_init(data[i], BUF_SIZE);
+  }
+
+  /* Much more than fits in the send buffer, so the array is worked through
+   * over several partial writes.
+   */
+  ASSERT_OK(uv_write_nocopy(&write_req,
+                            req->handle,
+                            bufs,
+                            NUM_BUFS,
+                            write_cb));
+  ASSERT_GT(req->handle->write_queue_size, 0);
+}
+
+
+TEST_IMPL(tcp_write_nocopy) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 128, connection_cb));
+
+  ASSERT_OK(uv_tcp_init(loop, &client));
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, write_cb_called);
+  ASSERT_EQ(3, close_cb_called);
+  ASSERT_EQ(bytes_read, NUM_BUFS * BUF_SIZE);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -0,0 +1,509 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+# include <sys/socket.h>
+#endif
+
+#define LARGE_WRITE (1024 * 1024)
+#define SMALL_WRITE 64
+#define NUM_WRITES 3
+
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t incoming;
+static uv_connect_t connect_req;
+static uv_shutdown_t shutdown_req;
+static uv_write_t write_reqs[NUM_WRITES];
+static char* send_buffer;
+static size_t bytes_expected;
+static size_t bytes_received;
+static int write_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void alloc_cb(uv_handle_t* handle, size_t size, uv_buf_t* buf) {
+  static char slab[65536];
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  ssize_t i;
+
+  if (nread == UV_EOF) {
+    uv_close((uv_handle_t*) stream, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    return;
+  }
+
+  ASSERT_GE(nread, 0);
+
+  /* Every write sends a prefix of the same pattern. */
+  for (i = 0; i < nread; i++, bytes_received++) {
+    if (bytes_received < LARGE_WRITE)
+      ASSERT_EQ(buf->base[i], send_buffer[bytes_received]);
+    else if (bytes_received < LARGE_WRITE + SMALL_WRITE)
+      ASSERT_EQ(buf->base[i], send_buffer[bytes_received - LARGE_WRITE]);
+    else
+      ASSERT_EQ(buf->base[i],
+                send_buffer[bytes_received - LARGE_WRITE - SMALL_WRITE]);
+  }
+}
+
+
+static void connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &incoming, alloc_cb, read_cb));
+}
+
+
+static void write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+
+  /* Zero-copy writes must not overtake each other or regular writes. */
+  ASSERT_PTR_EQ(req, &write_reqs[write_cb_called]);
+  write_cb_called++;
+}
+
+
+static void shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT_OK(status);
+
+  /* Closing now would cancel writes that are still in flight. */
+  ASSERT_EQ(NUM_WRITES, write_cb_called);
+  uv_close((uv_handle_t*) req->handle, close_cb);
+}
+
+
+static void connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+  size_t sizes[NUM_WRITES] = { LARGE_WRITE, SMALL_WRITE, LARGE_WRITE };
+  int i;
+
+  ASSERT_OK(status);
+
+  for (i = 0; i < NUM_WRITES; i++) {
+    buf = uv_buf_init(send_buffer, sizes[i]);
+    bytes_expected += sizes[i];
+    ASSERT_OK(uv_write(&write_reqs[i],
+                       req->handle,
+                       &buf,
+                       1,
+                       write_cb));
+  }
+
+  ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, shutdown_cb));
+}
+
+
+TEST_IMPL(tcp_zerocopy) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  size_t i;
+  int r;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init_ex(loop, &client, AF_INET));
+  r = uv_tcp_zerocopy(&client, 1, 0);
+  if (r == UV_ENOTSUP || r == UV_ENOPROTOOPT) {
+    uv_close((uv_handle_t*) &client, NULL);
+    MAKE_VALGRIND_HAPPY(loop);
+    RETURN_SKIP("Zero-copy transmit is not supported");
+  }
+  ASSERT_OK(r);
+
+  send_buffer = malloc(LARGE_WRITE);
+  ASSERT_NOT_NULL(send_buffer);
+  for (i = 0; i < LARGE_WRITE; i++)
+    send_buffer[i] = (char) (i % 251);
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, connection_cb));
+
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(NUM_WRITES, write_cb_called);
+  ASSERT_EQ(3, close_cb_called);
+  ASSERT_EQ(bytes_expected, bytes_received);
+
+  free(send_buffer);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+static void close_write_cb(uv_write_t* req, int status) {
+  /* Sent in full, or in part and the rest was canceled by uv_close(). */
+  ASSERT(status == 0 || status == UV_ECANCELED);
+  ASSERT_OK(close_cb_called);
+  write_cb_called++;
+
+  /* The kernel is done with the buffer, scribbling over it must not change
+   * what the peer receives.
+   */
+  memset(send_buffer, 0, LARGE_WRITE);
+}
+
+
+static void close_read_cb(uv_stream_t* stream,
+                          ssize_t nread,
+                          const uv_buf_t* buf) {
+  ssize_t i;
+
+  if (nread < 0) {
+    ASSERT(nread == UV_EOF || nread == UV_ECONNRESET);
+    uv_close((uv_handle_t*) stream, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    return;
+  }
+
+  for (i = 0; i < nread; i++, bytes_received++)
+    ASSERT_EQ(buf->base[i], (char) (bytes_received % 251));
+}
+
+
+static void close_connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+  ASSERT_OK(uv_read_start((uv_stream_t*) &incoming, alloc_cb, close_read_cb));
+}
+
+
+static void close_connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  buf = uv_buf_init(send_buffer, LARGE_WRITE);
+  ASSERT_OK(uv_write(&write_reqs[0], req->handle, &buf, 1, close_write_cb));
+
+  /* The write callback waits until the kernel has released the buffer. */
+  uv_close((uv_handle_t*) req->handle, close_cb);
+  ASSERT_OK(write_cb_called);
+}
+
+
+TEST_IMPL(tcp_zerocopy_close) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  size_t i;
+  int r;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init_ex(loop, &client, AF_INET));
+  r = uv_tcp_zerocopy(&client, 1, 0);
+  if (r == UV_ENOTSUP || r == UV_ENOPROTOOPT) {
+    uv_close((uv_handle_t*) &client, NULL);
+    MAKE_VALGRIND_HAPPY(loop);
+    RETURN_SKIP("Zero-copy transmit is not supported");
+  }
+  ASSERT_OK(r);
+
+  send_buffer = malloc(LARGE_WRITE);
+  ASSERT_NOT_NULL(send_buffer);
+  for (i = 0; i < LARGE_WRITE; i++)
+    send_buffer[i] = (char) (i % 251);
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, close_connection_cb));
+
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           close_connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, write_cb_called);
+  ASSERT_EQ(3, close_cb_called);
+  ASSERT_LE(bytes_received, LARGE_WRITE);
+
+  free(send_buffer);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+#ifndef _WIN32
+static uv_timer_t oob_timer;
+static uv_check_t oob_check;
+static unsigned int oob_check_called;
+
+
+static void oob_check_cb(uv_check_t* handle) {
+  oob_check_called++;
+}
+
+
+static void oob_write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  write_cb_called++;
+
+  /* Closing would reset the connection, the urgent byte is still unread. */
+  ASSERT_OK(uv_shutdown(&shutdown_req, req->handle, NULL));
+}
+
+
+static void oob_read_cb(uv_stream_t* stream,
+                        ssize_t nread,
+                        const uv_buf_t* buf) {
+  if (nread == UV_EOF) {
+    uv_close((uv_handle_t*) stream, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+    return;
+  }
+
+  ASSERT_GE(nread, 0);
+  bytes_received += nread;
+}
+
+
+static void oob_drain_cb(uv_timer_t* handle) {
+  /* The loop slept while the zero-copy write waited, it didn't spin on the
+   * urgent data.
+   */
+  ASSERT_LT(oob_check_called, 50);
+  ASSERT_OK(write_cb_called);
+
+  uv_close((uv_handle_t*) &oob_check, close_cb);
+  uv_close((uv_handle_t*) handle, close_cb);
+  ASSERT_OK(uv_read_start((uv_stream_t*) &incoming, alloc_cb, oob_read_cb));
+}
+
+
+static void oob_send_cb(uv_timer_t* handle) {
+  uv_os_fd_t fd;
+
+  /* The peer's receive window is full, so the zero-copy write is still
+   * waiting for its completion notification.
+   */
+  ASSERT_OK(write_cb_called);
+  ASSERT_OK(uv_fileno((uv_handle_t*) &incoming, &fd));
+  ASSERT_EQ(1, send(fd, "!", 1, MSG_OOB));
+
+  ASSERT_OK(uv_check_start(&oob_check, oob_check_cb));
+  ASSERT_OK(uv_timer_start(handle, oob_drain_cb, 100, 0));
+}
+
+
+static void oob_connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+  ASSERT_OK(uv_timer_start(&oob_timer, oob_send_cb, 50, 0));
+}
+
+
+static void reset_close_cb(uv_handle_t* handle) {
+  /* The write callback ran first, the kernel dropped the unsent data. */
+  ASSERT_EQ(1, write_cb_called);
+  close_cb_called++;
+
+  uv_close((uv_handle_t*) &incoming, close_cb);
+  uv_close((uv_handle_t*) &server, close_cb);
+}
+
+
+static void reset_write_cb(uv_write_t* req, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(close_cb_called);
+  write_cb_called++;
+}
+
+
+static void reset_timer_cb(uv_timer_t* handle) {
+  /* The peer doesn't read, the write waits for its notification. Without
+   * the reset uv_close() would wait for as long as the peer keeps the
+   * window closed.
+   */
+  ASSERT_OK(write_cb_called);
+  ASSERT_OK(uv_tcp_close_reset(&client, reset_close_cb));
+  uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+static void reset_connection_cb(uv_stream_t* stream, int status) {
+  ASSERT_OK(status);
+  ASSERT_OK(uv_tcp_init(stream->loop, &incoming));
+  ASSERT_OK(uv_accept(stream, (uv_stream_t*) &incoming));
+  ASSERT_OK(uv_timer_start(&oob_timer, reset_timer_cb, 50, 0));
+}
+
+
+static void reset_connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  buf = uv_buf_init(send_buffer, LARGE_WRITE);
+  ASSERT_OK(uv_write(&write_reqs[0], req->handle, &buf, 1, reset_write_cb));
+}
+
+
+static void oob_connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT_OK(status);
+
+  buf = uv_buf_init(send_buffer, LARGE_WRITE);
+  ASSERT_OK(uv_write(&write_reqs[0], req->handle, &buf, 1, oob_write_cb));
+}
+#endif
+
+
+TEST_IMPL(tcp_zerocopy_oob) {
+#ifdef _WIN32
+  RETURN_SKIP("Zero-copy transmit is not supported");
+#else
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  int value;
+  int r;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init_ex(loop, &client, AF_INET));
+  r = uv_tcp_zerocopy(&client, 1, 0);
+  if (r == UV_ENOTSUP || r == UV_ENOPROTOOPT) {
+    uv_close((uv_handle_t*) &client, NULL);
+    MAKE_VALGRIND_HAPPY(loop);
+    RETURN_SKIP("Zero-copy transmit is not supported");
+  }
+  ASSERT_OK(r);
+
+  /* Room for the whole write on the sending side. */
+  value = 4 * LARGE_WRITE;
+  ASSERT_OK(uv_send_buffer_size((uv_handle_t*) &client, &value));
+
+  send_buffer = calloc(1, LARGE_WRITE);
+  ASSERT_NOT_NULL(send_buffer);
+
+  /* A small window on the receiving side, inherited by `incoming`. */
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  value = 4096;
+  ASSERT_OK(uv_recv_buffer_size((uv_handle_t*) &server, &value));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, oob_connection_cb));
+
+  ASSERT_OK(uv_timer_init(loop, &oob_timer));
+  ASSERT_OK(uv_check_init(loop, &oob_check));
+
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           oob_connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, write_cb_called);
+  ASSERT_EQ(5, close_cb_called);
+  ASSERT_EQ(LARGE_WRITE, bytes_received);
+
+  free(send_buffer);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+#endif
+}
+
+
+TEST_IMPL(tcp_zerocopy_close_reset) {
+#ifdef _WIN32
+  RETURN_SKIP("Zero-copy transmit is not supported");
+#else
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  int value;
+  int r;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_tcp_init_ex(loop, &client, AF_INET));
+  r = uv_tcp_zerocopy(&client, 1, 0);
+  if (r == UV_ENOTSUP || r == UV_ENOPROTOOPT) {
+    uv_close((uv_handle_t*) &client, NULL);
+    MAKE_VALGRIND_HAPPY(loop);
+    RETURN_SKIP("Zero-copy transmit is not supported");
+  }
+  ASSERT_OK(r);
+
+  value = 4 * LARGE_WRITE;
+  ASSERT_OK(uv_send_buffer_size((uv_handle_t*) &client, &value));
+
+  send_buffer = calloc(1, LARGE_WRITE);
+  ASSERT_NOT_NULL(send_buffer);
+
+  ASSERT_OK(uv_tcp_init(loop, &server));
+  ASSERT_OK(uv_tcp_bind(&server, (const struct sockaddr*) &addr, 0));
+  value = 4096;
+  ASSERT_OK(uv_recv_buffer_size((uv_handle_t*) &server, &value));
+  ASSERT_OK(uv_listen((uv_stream_t*) &server, 1, reset_connection_cb));
+
+  ASSERT_OK(uv_timer_init(loop, &oob_timer));
+
+  ASSERT_OK(uv_tcp_connect(&connect_req,
+                           &client,
+                           (const struct sockaddr*) &addr,
+                           reset_connect_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, write_cb_called);
+  ASSERT_EQ(4, close_cb_called);
+
+  free(send_buffer);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+#endif
+}
@@ -173,6 +173,8 @@ TEST_IMPL(thread_name_threadpool) {
   RETURN_SKIP("API not available on this platform");
 #endif
   uv_work_t req;
+  /* The default size depends on the number of available CPUs. */
+  ASSERT_OK(uv_os_setenv("UV_THREADPOOL_SIZE", "4"));
   loop = uv_default_loop();
   // Just to make sure all workers will be executed
   // with the correct thread name
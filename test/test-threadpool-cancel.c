@@ -388,6 +388,37 @@ TEST_IMPL(threadpool_cancel_single) {
 }
 
 
+static void bulk_work_cb(uv_work_bulk_t* req, size_t start, size_t end) {
+  ASSERT(0 && "bulk_work_cb called");
+}
+
+
+static void bulk_done_cb(uv_work_bulk_t* req, int status) {
+  ASSERT_EQ(status, UV_ECANCELED);
+  done_cb_called++;
+}
+
+
+TEST_IMPL(threadpool_cancel_work_bulk) {
+  uv_work_bulk_t req;
+  uv_loop_t* loop;
+
+  saturate_threadpool();
+  loop = uv_default_loop();
+  ASSERT_OK(uv_queue_work_bulk(loop, &req, 1000, 0, bulk_work_cb,
+                               bulk_done_cb));
+  ASSERT_OK(uv_cancel((uv_req_t*) &req));
+  ASSERT_EQ(UV_EBUSY, uv_cancel((uv_req_t*) &req));
+  ASSERT_OK(done_cb_called);
+  unblock_threadpool();
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(1, done_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
 static void after_busy_cb(uv_work_t* req, int status) {
   ASSERT_OK(status);
   done_cb_called++;
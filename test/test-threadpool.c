@@ -22,6 +22,8 @@
 #include "uv.h"
 #include "task.h"
 
+#include <string.h>
+
 static int work_cb_count;
 static int after_work_cb_count;
 static uv_work_t work_req;
@@ -74,3 +76,222 @@ TEST_IMPL(threadpool_queue_work_einval) {
   MAKE_VALGRIND_HAPPY(uv_default_loop());
   return 0;
 }
+
+
+#define BULK_COUNT 10007
+
+static unsigned char bulk_seen[BULK_COUNT];
+static int bulk_after_cb_count;
+
+
+static void bulk_work_cb(uv_work_bulk_t* req, size_t start, size_t end) {
+  ASSERT_LT(start, end);
+  ASSERT_LE(end, BULK_COUNT);
+  ASSERT_LE(end - start, req->chunk_size);
+  ASSERT_PTR_EQ(req->data, &data);
+
+  for (; start < end; start++)
+    bulk_seen[start]++;
+}
+
+
+static void bulk_after_cb(uv_work_bulk_t* req, int status) {
+  size_t i;
+
+  ASSERT_OK(status);
+  ASSERT_PTR_EQ(req->data, &data);
+  ASSERT_EQ(BULK_COUNT, req->count);
+
+  for (i = 0; i < BULK_COUNT; i++)
+    ASSERT_EQ(1, bulk_seen[i]);
+
+  bulk_after_cb_count++;
+}
+
+
+TEST_IMPL(threadpool_queue_work_bulk) {
+  uv_work_bulk_t req;
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  req.data = &data;
+
+  /* Default chunk size. */
+  ASSERT_OK(uv_queue_work_bulk(loop, &req, BULK_COUNT, 0,
+                               bulk_work_cb, bulk_after_cb));
+  ASSERT_EQ(UV_WORK_BULK, req.type);
+  ASSERT_GT(req.chunk_size, 0);
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(1, bulk_after_cb_count);
+
+  /* Chunk size that doesn't divide the count. */
+  memset(bulk_seen, 0, sizeof(bulk_seen));
+  ASSERT_OK(uv_queue_work_bulk(loop, &req, BULK_COUNT, 64,
+                               bulk_work_cb, bulk_after_cb));
+  ASSERT_EQ(64, req.chunk_size);
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(2, bulk_after_cb_count);
+
+  /* A single chunk covering everything. */
+  memset(bulk_seen, 0, sizeof(bulk_seen));
+  ASSERT_OK(uv_queue_work_bulk(loop, &req, BULK_COUNT, BULK_COUNT * 2,
+                               bulk_work_cb, bulk_after_cb));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT_EQ(3, bulk_after_cb_count);
+
+  ASSERT_EQ(UV_EINVAL, uv_queue_work_bulk(loop, &req, 0, 0,
+                                          bulk_work_cb, bulk_after_cb));
+  ASSERT_EQ(UV_EINVAL, uv_queue_work_bulk(loop, &req, BULK_COUNT, 0,
+                                          NULL, bulk_after_cb));
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
+
+
+static int affinity_cpu;
+
+
+static void affinity_work_cb(uv_work_t* req) {
+  uv_thread_t tid;
+  char* mask;
+  int size;
+  int i;
+
+  size = uv_cpumask_size();
+  mask = calloc(size, 1);
+  ASSERT_NOT_NULL(mask);
+
+  tid = uv_thread_self();
+  ASSERT_OK(uv_thread_getaffinity(&tid, mask, size));
+  for (i = 0; i < size; i++)
+    ASSERT_EQ(i == affinity_cpu, mask[i]);
+
+  free(mask);
+  work_cb_count++;
+}
+
+
+TEST_IMPL(threadpool_cpus) {
+  char buf[16];
+
+  if (uv_cpumask_size() < 0)
+    RETURN_SKIP("CPU affinity not supported");
+
+  affinity_cpu = uv_thread_getcpu();
+  if (affinity_cpu < 0)
+    RETURN_SKIP("uv_thread_getcpu() not supported");
+
+  /* Must be set before the threadpool starts. */
+  snprintf(buf, sizeof(buf), "%d", affinity_cpu);
+  ASSERT_OK(uv_os_setenv("UV_THREADPOOL_CPUS", buf));
+
+  ASSERT_OK(uv_queue_work(uv_default_loop(),
+                          &work_req,
+                          affinity_work_cb,
+                          NULL));
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT_EQ(1, work_cb_count);
+
+  ASSERT_OK(uv_os_unsetenv("UV_THREADPOOL_CPUS"));
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
+
+
+static uv_mutex_t limit_mutex;
+static unsigned int limit_running;
+static unsigned int limit_max_running;
+static unsigned int limit_done;
+
+
+static void limit_work_cb(uv_work_t* req) {
+  uv_mutex_lock(&limit_mutex);
+  limit_running++;
+  if (limit_running > limit_max_running)
+    limit_max_running = limit_running;
+  uv_mutex_unlock(&limit_mutex);
+
+  uv_sleep(5);
+
+  uv_mutex_lock(&limit_mutex);
+  limit_running--;
+  uv_mutex_unlock(&limit_mutex);
+}
+
+
+static void limit_after_work_cb(uv_work_t* req, int status) {
+  ASSERT_OK(status);
+  limit_done++;
+}
+
+
+TEST_IMPL(threadpool_work_limit) {
+  uv_work_metrics_t m;
+  uv_work_t reqs[8];
+  unsigned int limit;
+  unsigned int i;
+
+  ASSERT_OK(uv_os_setenv("UV_THREADPOOL_SIZE", "4"));
+  ASSERT_OK(uv_mutex_init(&limit_mutex));
+
+  /* Slow I/O is limited to half of the threads by default, also before the
+   * threadpool starts. */
+  ASSERT_OK(uv_threadpool_get_limit(UV_WORK_SLOW_IO, &limit));
+  ASSERT_EQ(2, limit);
+  ASSERT_OK(uv_threadpool_get_limit(UV_WORK_CPU, &limit));
+  ASSERT_OK(limit);
+
+  ASSERT_OK(uv_threadpool_set_limit(UV_WORK_USER + 1, 1));
+  ASSERT_OK(uv_threadpool_get_limit(UV_WORK_USER + 1, &limit));
+  ASSERT_EQ(1, limit);
+
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    ASSERT_OK(uv_queue_work_ex(uv_default_loop(),
+                               reqs + i,
+                               UV_WORK_USER + 1,
+                               limit_work_cb,
+                               limit_after_work_cb));
+
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT_EQ(ARRAY_SIZE(reqs), limit_done);
+  ASSERT_EQ(1, limit_max_running);
+
+  ASSERT_OK(uv_threadpool_work_metrics(uv_default_loop(),
+                                       UV_WORK_USER + 1,
+                                       &m));
+  ASSERT_EQ(ARRAY_SIZE(reqs), m.completed);
+  ASSERT_OK(uv_threadpool_work_metrics(uv_default_loop(), UV_WORK_CPU, &m));
+  ASSERT_OK(m.submitted);
+  ASSERT_OK(uv_threadpool_get_limit(UV_WORK_SLOW_IO, &limit));
+  ASSERT_EQ(2, limit);
+
+  /* Raising the limit lets more work run concurrently. */
+  ASSERT_OK(uv_threadpool_set_limit(UV_WORK_USER + 1, 2));
+  limit_done = 0;
+  limit_max_running = 0;
+  for (i = 0; i < ARRAY_SIZE(reqs); i++)
+    ASSERT_OK(uv_queue_work_ex(uv_default_loop(),
+                               reqs + i,
+                               UV_WORK_USER + 1,
+                               limit_work_cb,
+                               limit_after_work_cb));
+
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+  ASSERT_EQ(ARRAY_SIZE(reqs), limit_done);
+  ASSERT_LE(limit_max_running, 2);
+
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_set_limit(UV_WORK_KIND_MAX, 1));
+  ASSERT_EQ(UV_EINVAL, uv_threadpool_get_limit(UV_WORK_CPU, NULL));
+  ASSERT_EQ(UV_EINVAL, uv_queue_work_ex(uv_default_loop(),
+                                        reqs,
+                                        UV_WORK_KIND_MAX,
+                                        limit_work_cb,
+                                        limit_after_work_cb));
+
+  uv_mutex_destroy(&limit_mutex);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
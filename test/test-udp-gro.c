@@ -0,0 +1,131 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define SEGMENT_SIZE  1000
+#define PAYLOAD_SIZE  9500
+
+static uv_udp_t recver;
+static uv_udp_t sender;
+static uv_udp_send_t send_req;
+static char payload[PAYLOAD_SIZE];
+static size_t bytes_received;
+static int send_cb_called;
+static int gro_recv_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  static char slab[65536];
+  *buf = uv_buf_init(slab, sizeof(slab));
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_OK(status);
+  send_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  size_t segment_size;
+
+  if (nread == 0)
+    return;
+
+  ASSERT_GT(nread, 0);
+  ASSERT_OK(flags & UV_UDP_PARTIAL);
+
+  if (flags & UV_UDP_GRO) {
+    segment_size = uv_udp_get_gro_segment_size(handle);
+    ASSERT_EQ(segment_size, SEGMENT_SIZE);
+    ASSERT_GT(nread, segment_size);
+    gro_recv_cb_called++;
+  }
+
+  ASSERT_LE(bytes_received + nread, PAYLOAD_SIZE);
+  ASSERT_OK(memcmp(buf->base, payload + bytes_received, nread));
+  bytes_received += nread;
+
+  if (bytes_received == PAYLOAD_SIZE) {
+    uv_close((uv_handle_t*) &recver, close_cb);
+    uv_close((uv_handle_t*) &sender, close_cb);
+  }
+}
+
+
+TEST_IMPL(udp_gro) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uv_buf_t buf;
+  int i;
+
+#if !defined(__linux__)
+  RETURN_SKIP("UDP_GRO is Linux-only");
+#endif
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_EQ(UV_EINVAL, uv_udp_init_ex(loop, &recver, AF_INET | 1024));
+  ASSERT_OK(uv_udp_init_ex(loop, &recver, AF_INET | UV_UDP_GRO));
+  ASSERT_OK(uv_udp_bind(&recver, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_recv_start(&recver, alloc_cb, recv_cb));
+  ASSERT_OK(uv_udp_init(loop, &sender));
+
+  for (i = 0; i < PAYLOAD_SIZE; i++)
+    payload[i] = 'a' + i / SEGMENT_SIZE;
+
+  /* A GSO send over loopback reaches a GRO socket in one piece. */
+  buf = uv_buf_init(payload, sizeof(payload));
+  ASSERT_OK(uv_udp_send_gso(&send_req,
+                            &sender,
+                            &buf,
+                            1,
+                            (const struct sockaddr*) &addr,
+                            SEGMENT_SIZE,
+                            send_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, send_cb_called);
+  ASSERT_EQ(1, gro_recv_cb_called);
+  ASSERT_EQ(bytes_received, PAYLOAD_SIZE);
+  ASSERT_EQ(2, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -0,0 +1,140 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define SEGMENT_SIZE  1000
+#define PAYLOAD_SIZE  9500
+#define NUM_SEGMENTS  ((PAYLOAD_SIZE + SEGMENT_SIZE - 1) / SEGMENT_SIZE)
+
+static uv_udp_t recver;
+static uv_udp_t sender;
+static uv_udp_send_t send_req;
+static char payload[PAYLOAD_SIZE];
+static int send_cb_called;
+static int recv_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  static char slab[65536];
+  *buf = uv_buf_init(slab, sizeof(slab));
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_PTR_EQ(req, &send_req);
+  ASSERT_OK(status);
+  send_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  size_t size;
+
+  if (nread == 0)
+    return;
+
+  ASSERT_GT(nread, 0);
+  ASSERT_NOT_NULL(addr);
+  ASSERT_LT(recv_cb_called, NUM_SEGMENTS);
+
+  /* One datagram per segment, the last one gets what's left over. */
+  size = PAYLOAD_SIZE - recv_cb_called * SEGMENT_SIZE;
+  if (size > SEGMENT_SIZE)
+    size = SEGMENT_SIZE;
+
+  ASSERT_EQ(nread, size);
+  ASSERT_OK(memcmp(buf->base, payload + recv_cb_called * SEGMENT_SIZE, size));
+
+  if (++recv_cb_called == NUM_SEGMENTS) {
+    uv_close((uv_handle_t*) &recver, close_cb);
+    uv_close((uv_handle_t*) &sender, close_cb);
+  }
+}
+
+
+TEST_IMPL(udp_gso) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uv_buf_t buf;
+  int err;
+  int i;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init(loop, &recver));
+  ASSERT_OK(uv_udp_bind(&recver, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_recv_start(&recver, alloc_cb, recv_cb));
+  ASSERT_OK(uv_udp_init(loop, &sender));
+
+  for (i = 0; i < PAYLOAD_SIZE; i++)
+    payload[i] = 'a' + i / SEGMENT_SIZE;
+
+  buf = uv_buf_init(payload, sizeof(payload));
+  ASSERT_EQ(UV_EINVAL, uv_udp_send_gso(&send_req,
+                                       &sender,
+                                       &buf,
+                                       1,
+                                       (const struct sockaddr*) &addr,
+                                       0,
+                                       send_cb));
+
+  err = uv_udp_send_gso(&send_req,
+                        &sender,
+                        &buf,
+                        1,
+                        (const struct sockaddr*) &addr,
+                        SEGMENT_SIZE,
+                        send_cb);
+  if (err == UV_ENOTSUP) {
+    uv_close((uv_handle_t*) &recver, NULL);
+    uv_close((uv_handle_t*) &sender, NULL);
+    uv_run(loop, UV_RUN_DEFAULT);
+    MAKE_VALGRIND_HAPPY(loop);
+    RETURN_SKIP("UDP segmentation offload is not supported");
+  }
+  ASSERT_OK(err);
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, send_cb_called);
+  ASSERT_EQ(NUM_SEGMENTS, recv_cb_called);
+  ASSERT_EQ(2, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
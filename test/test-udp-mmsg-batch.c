@@ -0,0 +1,141 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+
+#define NUM_SENDS     100
+#define RECV_BATCH    64
+#define SEND_BATCH    64
+#define DGRAM_SIZE    (64 * 1024)
+#define MAX_SUGGESTED (32 * DGRAM_SIZE)
+
+static uv_udp_t recver;
+static uv_udp_t sender;
+static uv_udp_send_t send_reqs[NUM_SENDS];
+static size_t max_suggested_size;
+static int send_cb_called;
+static int datagrams_received;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  ASSERT_OK(suggested_size % DGRAM_SIZE);
+  ASSERT_LE(suggested_size, MAX_SUGGESTED);
+
+  if (suggested_size > max_suggested_size)
+    max_suggested_size = suggested_size;
+
+  buf->base = malloc(suggested_size);
+  ASSERT_NOT_NULL(buf->base);
+  buf->len = suggested_size;
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  ASSERT_GE(nread, 0);
+
+  if (flags & UV_UDP_MMSG_CHUNK) {
+    ASSERT_EQ(4, nread);
+    datagrams_received++;
+    return;
+  }
+
+  free(buf->base);
+
+  if (datagrams_received == NUM_SENDS) {
+    uv_close((uv_handle_t*) &recver, close_cb);
+    uv_close((uv_handle_t*) &sender, close_cb);
+  }
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_OK(status);
+
+  /* Start reading once everything is queued up in the socket so that the
+   * kernel fills the batches.
+   */
+  if (++send_cb_called == NUM_SENDS)
+    ASSERT_OK(uv_udp_recv_start(&recver, alloc_cb, recv_cb));
+}
+
+
+TEST_IMPL(udp_mmsg_batch) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uv_buf_t buf;
+  int i;
+
+#if !defined(__linux__) && !defined(__FreeBSD__) && !defined(__APPLE__)
+  RETURN_SKIP("recvmmsg batches are not supported on this platform");
+#endif
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init_ex(loop, &recver, AF_INET | UV_UDP_RECVMMSG));
+  ASSERT_OK(uv_udp_bind(&recver, (const struct sockaddr*) &addr, 0));
+  ASSERT_EQ(UV_EINVAL, uv_udp_set_mmsg_batch(&recver, 1025, 0, 0));
+  ASSERT_OK(uv_udp_set_mmsg_batch(&recver, RECV_BATCH, 0, 1));
+
+  ASSERT_OK(uv_udp_init(loop, &sender));
+  ASSERT_OK(uv_udp_set_mmsg_batch(&sender, 0, SEND_BATCH, 0));
+
+  buf = uv_buf_init("PING", 4);
+  for (i = 0; i < NUM_SENDS; i++)
+    ASSERT_OK(uv_udp_send(&send_reqs[i],
+                          &sender,
+                          &buf,
+                          1,
+                          (const struct sockaddr*) &addr,
+                          send_cb));
+
+  /* The arrays are in use while there are sends in flight. */
+  ASSERT_EQ(UV_EBUSY, uv_udp_set_mmsg_batch(&sender, 0, 0, 0));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(NUM_SENDS, send_cb_called);
+  ASSERT_EQ(NUM_SENDS, datagrams_received);
+  ASSERT_EQ(2, close_cb_called);
+
+  /* Full batches made the receive batch grow from 20 until the suggested
+   * size hit its cap.
+   */
+  ASSERT_EQ(max_suggested_size, MAX_SUGGESTED);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -0,0 +1,126 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_SENDS 4
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_t send_reqs[NUM_SENDS];
+static char slab[64];
+static int send_cb_called;
+static int recv_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_OK(status);
+  send_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  if (nread == 0)
+    return;
+
+  ASSERT_EQ(4, nread);
+  ASSERT_OK(memcmp(buf->base, "PING", 4));
+
+  if (++recv_cb_called == NUM_SENDS) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+TEST_IMPL(udp_pacing) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uv_buf_t buf;
+  uint64_t txtime;
+  int r;
+  int i;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init(loop, &server));
+  ASSERT_OK(uv_udp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_recv_start(&server, alloc_cb, recv_cb));
+
+  ASSERT_OK(uv_udp_init_ex(loop, &client, AF_INET));
+  r = uv_udp_set_pacing_rate(&client, 1024 * 1024);
+  if (r == UV_ENOTSUP) {
+    uv_close((uv_handle_t*) &server, NULL);
+    uv_close((uv_handle_t*) &client, NULL);
+    uv_run(loop, UV_RUN_DEFAULT);
+    RETURN_SKIP("SO_MAX_PACING_RATE is not supported on this platform");
+  }
+  ASSERT_OK(r);
+
+  /* More than 32 bits, and 0 to lift the limit again. */
+  ASSERT_OK(uv_udp_set_pacing_rate(&client, (uint64_t) 1 << 33));
+  ASSERT_OK(uv_udp_set_pacing_rate(&client, 0));
+
+  /* Without a qdisc that honors SO_TXTIME the kernel sends the datagrams
+   * right away, they just have to arrive.
+   */
+  buf = uv_buf_init("PING", 4);
+  txtime = uv_hrtime();
+  for (i = 0; i < NUM_SENDS; i++)
+    ASSERT_OK(uv_udp_send_at(&send_reqs[i],
+                             &client,
+                             &buf,
+                             1,
+                             (const struct sockaddr*) &addr,
+                             i == 0 ? 0 : txtime + i * 1000000,
+                             send_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(NUM_SENDS, send_cb_called);
+  ASSERT_EQ(NUM_SENDS, recv_cb_called);
+  ASSERT_EQ(2, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
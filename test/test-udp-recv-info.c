@@ -0,0 +1,192 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+# include <netinet/in.h>
+# include <netinet/ip.h>
+#endif
+
+#define TOS 0x12  /* DSCP 4, ECT(0). */
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_t send_req;
+static uv_udp_send_t reply_req;
+static char slab[64];
+static int server_recv_cb_called;
+static int client_recv_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_OK(status);
+}
+
+
+static void client_recv_cb(uv_udp_t* handle,
+                           ssize_t nread,
+                           const uv_buf_t* buf,
+                           const struct sockaddr* addr,
+                           unsigned flags) {
+  char ip[INET_ADDRSTRLEN];
+
+  if (nread == 0)
+    return;
+
+  ASSERT_EQ(4, nread);
+  ASSERT_OK(memcmp(buf->base, "PONG", 4));
+
+  /* The reply comes from the address the request was sent to, not from the
+   * one the routing table would pick for 127.0.0.1.
+   */
+  ASSERT_EQ(AF_INET, addr->sa_family);
+  ASSERT_OK(uv_ip4_name((const struct sockaddr_in*) addr, ip, sizeof(ip)));
+  ASSERT_STR_EQ("127.0.0.2", ip);
+  ASSERT_EQ(TEST_PORT, ntohs(((const struct sockaddr_in*) addr)->sin_port));
+
+  client_recv_cb_called++;
+  uv_close((uv_handle_t*) &server, close_cb);
+  uv_close((uv_handle_t*) &client, close_cb);
+}
+
+
+static void server_recv_cb(uv_udp_t* handle,
+                           ssize_t nread,
+                           const uv_buf_t* buf,
+                           const struct sockaddr* addr,
+                           const uv_udp_recv_info_t* info,
+                           unsigned flags) {
+  const struct sockaddr_in* local;
+  uv_timespec64_t now;
+  char ip[INET_ADDRSTRLEN];
+  uv_buf_t reply;
+
+  if (nread == 0) {
+    ASSERT_NULL(info);
+    return;
+  }
+
+  ASSERT_EQ(4, nread);
+  ASSERT_OK(memcmp(buf->base, "PING", 4));
+  ASSERT_NOT_NULL(info);
+  ASSERT_EQ(UV_UDP_INFO_LOCAL_ADDR | UV_UDP_INFO_TIMESTAMP | UV_UDP_INFO_TOS,
+            info->flags);
+
+  local = (const struct sockaddr_in*) &info->local_addr;
+  ASSERT_EQ(AF_INET, local->sin_family);
+  ASSERT_OK(uv_ip4_name(local, ip, sizeof(ip)));
+  ASSERT_STR_EQ("127.0.0.2", ip);
+  ASSERT_GT(info->ifindex, 0);
+
+  ASSERT_OK(uv_clock_gettime(UV_CLOCK_REALTIME, &now));
+  ASSERT_LE(info->timestamp.tv_sec, now.tv_sec);
+  ASSERT_GE(info->timestamp.tv_sec, now.tv_sec - 5);
+
+  ASSERT_EQ(TOS, info->tos);
+
+  server_recv_cb_called++;
+
+  reply = uv_buf_init("PONG", 4);
+  ASSERT_OK(uv_udp_send_from(&reply_req,
+                             handle,
+                             &reply,
+                             1,
+                             addr,
+                             (const struct sockaddr*) &info->local_addr,
+                             send_cb));
+}
+
+
+TEST_IMPL(udp_recv_info) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uv_buf_t buf;
+#ifndef _WIN32
+  uv_os_fd_t fd;
+  int tos;
+#endif
+
+#if !defined(__linux__)
+  /* Needs 127.0.0.2 to be a local address. */
+  RETURN_SKIP("Test needs the whole of 127.0.0.0/8 on the loopback");
+#endif
+
+  loop = uv_default_loop();
+
+  ASSERT_OK(uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+  ASSERT_OK(uv_udp_init(loop, &server));
+  ASSERT_OK(uv_udp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_EQ(UV_EINVAL, uv_udp_recv_start_ex(&server, alloc_cb, NULL, 0));
+  ASSERT_EQ(UV_EINVAL,
+            uv_udp_recv_start_ex(&server, alloc_cb, server_recv_cb, 8));
+  ASSERT_OK(uv_udp_recv_start_ex(&server,
+                                 alloc_cb,
+                                 server_recv_cb,
+                                 UV_UDP_INFO_LOCAL_ADDR |
+                                 UV_UDP_INFO_TIMESTAMP |
+                                 UV_UDP_INFO_TOS));
+  ASSERT_EQ(UV_EALREADY,
+            uv_udp_recv_start_ex(&server, alloc_cb, server_recv_cb, 0));
+
+  ASSERT_OK(uv_udp_init(loop, &client));
+  ASSERT_OK(uv_udp_recv_start(&client, alloc_cb, client_recv_cb));
+#ifndef _WIN32
+  ASSERT_OK(uv_fileno((uv_handle_t*) &client, &fd));
+  tos = TOS;
+  ASSERT_OK(setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)));
+#endif
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.2", TEST_PORT, &addr));
+  buf = uv_buf_init("PING", 4);
+  ASSERT_OK(uv_udp_send(&send_req,
+                        &client,
+                        &buf,
+                        1,
+                        (const struct sockaddr*) &addr,
+                        send_cb));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, server_recv_cb_called);
+  ASSERT_EQ(1, client_recv_cb_called);
+  ASSERT_EQ(2, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
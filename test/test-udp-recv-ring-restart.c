@@ -0,0 +1,153 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define SLOT_SIZE 8
+
+static uv_udp_t recver;
+static uv_udp_t sender;
+static uv_timer_t timer;
+static struct sockaddr_in addr;
+static int recv_cb_called;
+static int timer_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void send_one(const char* data) {
+  uv_buf_t buf;
+
+  buf = uv_buf_init((char*) data, strlen(data));
+  ASSERT_EQ((int) buf.len, uv_udp_try_send(&sender,
+                                           &buf,
+                                           1,
+                                           (const struct sockaddr*) &addr));
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* peer,
+                    const uv_udp_recv_info_t* info,
+                    unsigned flags);
+
+
+static void timer_cb(uv_timer_t* handle) {
+  ASSERT_EQ(1, recv_cb_called);
+  timer_cb_called++;
+
+  ASSERT_OK(uv_udp_recv_start_ex(&recver,
+                                 NULL,
+                                 recv_cb,
+                                 UV_UDP_INFO_LOCAL_ADDR));
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* peer,
+                    const uv_udp_recv_info_t* info,
+                    unsigned flags) {
+  const struct sockaddr_in* local;
+  char ip[INET_ADDRSTRLEN];
+
+  ASSERT_GT(nread, 0);
+  ASSERT_NOT_NULL(peer);
+  ASSERT_NOT_NULL(info);
+  ASSERT_EQ(UV_UDP_INFO_LOCAL_ADDR, info->flags);
+  local = (const struct sockaddr_in*) &info->local_addr;
+  ASSERT_OK(uv_ip4_name(local, ip, sizeof(ip)));
+  ASSERT_STR_EQ("127.0.0.1", ip);
+  ASSERT_EQ(SLOT_SIZE, buf->len);
+  ASSERT(flags & UV_UDP_RING_BUF);
+
+  recv_cb_called++;
+
+  if (recv_cb_called == 1) {
+    /* Doesn't fit, the slot gets what it can hold. */
+    ASSERT_EQ(SLOT_SIZE, nread);
+    ASSERT(flags & UV_UDP_PARTIAL);
+    ASSERT_OK(memcmp(buf->base, "PINGPING", SLOT_SIZE));
+
+    ASSERT_OK(uv_udp_recv_stop(handle));
+    ASSERT_OK(uv_udp_recv_ring_release(handle, buf));
+
+    /* Waits in the socket until reading resumes. */
+    send_one("PONG");
+    ASSERT_OK(uv_timer_start(&timer, timer_cb, 50, 0));
+    return;
+  }
+
+  ASSERT_EQ(2, recv_cb_called);
+  ASSERT_EQ(4, nread);
+  ASSERT_OK(flags & UV_UDP_PARTIAL);
+  ASSERT_OK(memcmp(buf->base, "PONG", 4));
+
+  /* Close with datagrams in flight and the slot still lent out. */
+  send_one("DONE");
+  send_one("DONE");
+  uv_close((uv_handle_t*) &recver, close_cb);
+  uv_close((uv_handle_t*) &sender, close_cb);
+  uv_close((uv_handle_t*) &timer, close_cb);
+}
+
+
+TEST_IMPL(udp_recv_ring_restart) {
+  uv_loop_t* loop;
+
+#if !defined(__linux__)
+  RETURN_SKIP("Needs the local address of received datagrams");
+#endif
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init(loop, &recver));
+  ASSERT_OK(uv_udp_bind(&recver, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_set_recv_ring(&recver, 2, SLOT_SIZE));
+  ASSERT_OK(uv_udp_recv_start_ex(&recver,
+                                 NULL,
+                                 recv_cb,
+                                 UV_UDP_INFO_LOCAL_ADDR));
+
+  ASSERT_OK(uv_udp_init(loop, &sender));
+  ASSERT_OK(uv_timer_init(loop, &timer));
+  send_one("PINGPINGPING");
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(2, recv_cb_called);
+  ASSERT_EQ(1, timer_cb_called);
+  ASSERT_EQ(3, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
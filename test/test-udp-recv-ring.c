@@ -0,0 +1,159 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_SENDS   12
+#define NUM_SLOTS   4
+#define SLOT_SIZE   2048
+
+static uv_udp_t recver;
+static uv_udp_t sender;
+static uv_timer_t timer;
+static uv_buf_t held[NUM_SLOTS];
+static char* seen[NUM_SLOTS];
+static int held_count;
+static int recv_cb_called;
+static int timer_cb_called;
+static int close_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  int i;
+
+  ASSERT_GT(nread, 0);
+  ASSERT_NOT_NULL(addr);
+  ASSERT(flags & UV_UDP_RING_BUF);
+  ASSERT_OK(flags & (UV_UDP_MMSG_CHUNK | UV_UDP_MMSG_FREE));
+  ASSERT_EQ(SLOT_SIZE, buf->len);
+  ASSERT_EQ(4, nread);
+  ASSERT_OK(memcmp(buf->base, "PING", 4));
+
+  /* Every datagram lands in one of the handle's slots. */
+  for (i = 0; i < NUM_SLOTS; i++)
+    if (seen[i] == NULL || seen[i] == buf->base)
+      break;
+  ASSERT_LT(i, NUM_SLOTS);
+  seen[i] = buf->base;
+
+  recv_cb_called++;
+
+  /* Hold on to the first round of slots to exhaust the ring. */
+  if (timer_cb_called == 0) {
+    held[held_count++] = *buf;
+    return;
+  }
+
+  ASSERT_OK(uv_udp_recv_ring_release(handle, buf));
+  if (recv_cb_called == NUM_SENDS) {
+    uv_close((uv_handle_t*) &recver, close_cb);
+    uv_close((uv_handle_t*) &sender, close_cb);
+    uv_close((uv_handle_t*) &timer, close_cb);
+  }
+}
+
+
+static void timer_cb(uv_timer_t* handle) {
+  uv_buf_t buf;
+  int i;
+
+  /* Reading stalled once the application had all the slots. */
+  ASSERT_EQ(NUM_SLOTS, held_count);
+  ASSERT_EQ(NUM_SLOTS, recv_cb_called);
+  timer_cb_called++;
+
+  buf = uv_buf_init("PING", 4);
+  ASSERT_EQ(UV_EINVAL, uv_udp_recv_ring_release(&recver, &buf));
+
+  for (i = 0; i < held_count; i++)
+    ASSERT_OK(uv_udp_recv_ring_release(&recver, &held[i]));
+
+  /* A slot can't be handed back twice. */
+  ASSERT_EQ(UV_EINVAL, uv_udp_recv_ring_release(&recver, &held[0]));
+}
+
+
+static void udp_recv_ring(unsigned int flags) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  uv_buf_t buf;
+  int i;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init_ex(loop, &recver, AF_INET | flags));
+  ASSERT_OK(uv_udp_bind(&recver, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_set_recv_ring(&recver, NUM_SLOTS, SLOT_SIZE));
+
+  /* No alloc_cb, the datagrams go into the ring. */
+  ASSERT_OK(uv_udp_recv_start(&recver, NULL, recv_cb));
+  ASSERT_EQ(UV_EBUSY, uv_udp_set_recv_ring(&recver, 0, 0));
+
+  ASSERT_OK(uv_udp_init(loop, &sender));
+  buf = uv_buf_init("PING", 4);
+  for (i = 0; i < NUM_SENDS; i++)
+    ASSERT_EQ(4, uv_udp_try_send(&sender,
+                                 &buf,
+                                 1,
+                                 (const struct sockaddr*) &addr));
+
+  ASSERT_OK(uv_timer_init(loop, &timer));
+  ASSERT_OK(uv_timer_start(&timer, timer_cb, 100, 0));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, timer_cb_called);
+  ASSERT_EQ(NUM_SENDS, recv_cb_called);
+  ASSERT_EQ(3, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+}
+
+
+TEST_IMPL(udp_recv_ring) {
+#if defined(_WIN32)
+  RETURN_SKIP("Receive rings are not supported on Windows");
+#endif
+  udp_recv_ring(0);
+  return 0;
+}
+
+
+TEST_IMPL(udp_recv_ring_mmsg) {
+#if !defined(__linux__) && !defined(__FreeBSD__) && !defined(__APPLE__)
+  RETURN_SKIP("recvmmsg is not supported on this platform");
+#endif
+  udp_recv_ring(UV_UDP_RECVMMSG);
+  return 0;
+}
@@ -0,0 +1,198 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_HANDLES 3
+#define NUM_DATAGRAMS 16
+
+static uv_udp_t handles[NUM_HANDLES];
+static uv_udp_t clients[NUM_DATAGRAMS];
+static uv_udp_send_t send_reqs[NUM_DATAGRAMS];
+static unsigned int recv_counts[NUM_HANDLES];
+static unsigned int recv_cb_called;
+static unsigned int send_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  static char slab[64];
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void close_all(void) {
+  unsigned int i;
+
+  for (i = 0; i < NUM_HANDLES; i++)
+    uv_close((uv_handle_t*) &handles[i], NULL);
+  for (i = 0; i < NUM_DATAGRAMS; i++)
+    uv_close((uv_handle_t*) &clients[i], NULL);
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  if (nread == 0)
+    return;
+
+  ASSERT_EQ(4, nread);
+  ASSERT_OK(memcmp("PING", buf->base, nread));
+
+  recv_counts[handle - handles]++;
+  if (++recv_cb_called == NUM_DATAGRAMS)
+    close_all();
+}
+
+
+static void send_cb(uv_udp_send_t* req, int status) {
+  ASSERT_OK(status);
+  send_cb_called++;
+}
+
+
+TEST_IMPL(udp_reuseport_group) {
+  struct sockaddr_in addr;
+  struct sockaddr_in name;
+  uv_udp_t* group[NUM_HANDLES];
+  uv_udp_t* failing[NUM_HANDLES];
+  uv_udp_t bound;
+  uv_thread_t tid;
+  uv_buf_t buf;
+  char* cpumask;
+  int cpumasksize;
+  unsigned int i;
+  int namelen;
+  int port;
+  int cpu;
+  int r;
+
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", 0, &addr));
+
+  for (i = 0; i < NUM_HANDLES; i++) {
+    ASSERT_OK(uv_udp_init(uv_default_loop(), &handles[i]));
+    group[i] = &handles[i];
+  }
+
+  ASSERT_EQ(UV_EINVAL, uv_udp_bind_reuseport_group(group,
+                                                   0,
+                                                   (struct sockaddr*) &addr,
+                                                   0));
+
+#if defined(__linux__)
+  /* The last handle can't be bound again, the others are taken out of the
+   * group so it isn't left without steering.
+   */
+  ASSERT_OK(uv_udp_init(uv_default_loop(), &bound));
+  ASSERT_OK(uv_udp_bind(&bound, (const struct sockaddr*) &addr, 0));
+  for (i = 0; i < NUM_HANDLES - 1; i++)
+    failing[i] = &handles[i];
+  failing[NUM_HANDLES - 1] = &bound;
+  ASSERT_EQ(UV_EINVAL,
+            uv_udp_bind_reuseport_group(failing,
+                                        NUM_HANDLES,
+                                        (const struct sockaddr*) &addr,
+                                        0));
+  uv_close((uv_handle_t*) &bound, NULL);
+
+  for (i = 0; i < NUM_HANDLES - 1; i++) {
+    namelen = sizeof(name);
+    r = uv_udp_getsockname(&handles[i], (struct sockaddr*) &name, &namelen);
+    ASSERT(r != 0 || name.sin_port == 0);
+  }
+#else
+  (void) failing;
+  (void) bound;
+#endif
+
+  r = uv_udp_bind_reuseport_group(group,
+                                  NUM_HANDLES,
+                                  (const struct sockaddr*) &addr,
+                                  0);
+#if !defined(__linux__)
+  ASSERT_EQ(r, UV_ENOTSUP);
+  for (i = 0; i < NUM_HANDLES; i++)
+    uv_close((uv_handle_t*) &handles[i], NULL);
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  RETURN_SKIP("Reuseport CPU steering is Linux-only");
+#endif
+  ASSERT_OK(r);
+
+  /* All of the group share the port the kernel picked for the first. */
+  port = -1;
+  for (i = 0; i < NUM_HANDLES; i++) {
+    namelen = sizeof(name);
+    ASSERT_OK(uv_udp_getsockname(&handles[i],
+                                 (struct sockaddr*) &name,
+                                 &namelen));
+    ASSERT_NE(0, name.sin_port);
+    if (port != -1)
+      ASSERT_EQ(port, name.sin_port);
+    port = name.sin_port;
+  }
+
+  /* Stay on one CPU, loopback datagrams are received on the sender's. */
+  cpu = uv_thread_getcpu();
+  if (cpu < 0)
+    RETURN_SKIP("uv_thread_getcpu() is not supported");
+
+  cpumasksize = uv_cpumask_size();
+  ASSERT_GT(cpumasksize, cpu);
+  cpumask = calloc(cpumasksize, 1);
+  ASSERT_NOT_NULL(cpumask);
+  cpumask[cpu] = 1;
+  tid = uv_thread_self();
+  ASSERT_OK(uv_thread_setaffinity(&tid, cpumask, NULL, cpumasksize));
+  free(cpumask);
+
+  for (i = 0; i < NUM_HANDLES; i++)
+    ASSERT_OK(uv_udp_recv_start(&handles[i], alloc_cb, recv_cb));
+
+  /* A source port each, hashing alone would spread them over the group. */
+  buf = uv_buf_init("PING", 4);
+  for (i = 0; i < NUM_DATAGRAMS; i++) {
+    ASSERT_OK(uv_udp_init(uv_default_loop(), &clients[i]));
+    ASSERT_OK(uv_udp_send(&send_reqs[i],
+                          &clients[i],
+                          &buf,
+                          1,
+                          (const struct sockaddr*) &name,
+                          send_cb));
+  }
+
+  ASSERT_OK(uv_run(uv_default_loop(), UV_RUN_DEFAULT));
+
+  ASSERT_EQ(NUM_DATAGRAMS, send_cb_called);
+  ASSERT_EQ(NUM_DATAGRAMS, recv_cb_called);
+  ASSERT_EQ(NUM_DATAGRAMS, recv_counts[cpu % NUM_HANDLES]);
+
+  MAKE_VALGRIND_HAPPY(uv_default_loop());
+  return 0;
+}
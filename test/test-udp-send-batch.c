@@ -0,0 +1,155 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_DGRAMS 50
+#define BAD_DGRAM 25
+
+static uv_udp_t server;
+static uv_udp_t client;
+static uv_udp_send_t req;
+static uv_buf_t bufs[NUM_DGRAMS];
+static uv_buf_t* bufsp[NUM_DGRAMS];
+static unsigned int nbufs[NUM_DGRAMS];
+static struct sockaddr* addrs[NUM_DGRAMS];
+static char big[70000];  /* Over the maximum size of an IPv4 datagram. */
+static char slab[64];
+static int send_cb_called;
+static int recv_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void maybe_close(void) {
+  if (send_cb_called == 1 && recv_cb_called == NUM_DGRAMS - 1) {
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+  }
+}
+
+
+static void send_cb(uv_udp_send_t* r, int status) {
+  uv_udp_stats_t stats;
+
+  ASSERT_PTR_EQ(r, &req);
+  /* The one that doesn't fit fails the batch, the others still go out. */
+  ASSERT_EQ(UV_EMSGSIZE, status);
+  ASSERT_OK(uv_udp_get_send_queue_count(&client));
+
+  ASSERT_OK(uv_udp_get_stats(&client, &stats));
+  ASSERT_EQ(NUM_DGRAMS - 1, stats.send_packets);
+  ASSERT_EQ(NUM_DGRAMS - 1, stats.send_bytes);
+
+  send_cb_called++;
+  maybe_close();
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  if (nread == 0)
+    return;
+
+  ASSERT_EQ(1, nread);
+  ASSERT_EQ('x', buf->base[0]);
+
+  recv_cb_called++;
+  maybe_close();
+}
+
+
+TEST_IMPL(udp_send_batch) {
+  struct sockaddr_in addr;
+  uv_loop_t* loop;
+  int i;
+
+#if defined(_WIN32)
+  RETURN_SKIP("Batched sends are not supported on Windows");
+#endif
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init(loop, &server));
+  ASSERT_OK(uv_udp_bind(&server, (const struct sockaddr*) &addr, 0));
+  ASSERT_OK(uv_udp_recv_start(&server, alloc_cb, recv_cb));
+
+  for (i = 0; i < NUM_DGRAMS; i++) {
+    bufs[i] = uv_buf_init("x", 1);
+    bufsp[i] = &bufs[i];
+    nbufs[i] = 1;
+    addrs[i] = (struct sockaddr*) &addr;
+  }
+  bufs[BAD_DGRAM] = uv_buf_init(big, sizeof(big));
+
+  ASSERT_OK(uv_udp_init(loop, &client));
+  ASSERT_EQ(UV_EINVAL,
+            uv_udp_send_batch(&req, &client, bufsp, nbufs, addrs, 0, send_cb));
+
+  /* Every datagram needs a destination on an unconnected socket. */
+  addrs[1] = NULL;
+  ASSERT_EQ(UV_EDESTADDRREQ, uv_udp_send_batch(&req,
+                                               &client,
+                                               bufsp,
+                                               nbufs,
+                                               addrs,
+                                               NUM_DGRAMS,
+                                               send_cb));
+  addrs[1] = (struct sockaddr*) &addr;
+
+  /* One request and one callback for the whole batch. */
+  ASSERT_OK(uv_udp_send_batch(&req,
+                              &client,
+                              bufsp,
+                              nbufs,
+                              addrs,
+                              NUM_DGRAMS,
+                              send_cb));
+  ASSERT_EQ(1, uv_udp_get_send_queue_count(&client));
+
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, send_cb_called);
+  ASSERT_EQ(NUM_DGRAMS - 1, recv_cb_called);
+  ASSERT_EQ(2, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}
@@ -0,0 +1,153 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <string.h>
+
+#define NUM_SENDS 100
+
+static uv_udp_t server;
+static uv_udp_t client;
+static struct sockaddr_in addr;
+static char payload[1000];
+static char slab[2048];
+static int sent;
+static int received;
+static int last_sent;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr_,
+                    unsigned flags) {
+  uv_udp_stats_t stats;
+  uv_buf_t last;
+
+  ASSERT_GE(nread, 0);
+
+  if (nread == 0) {
+    /* Drained what made it into the receive buffer. Send one more datagram
+     * so that the kernel reports the drops.
+     */
+    if (!last_sent) {
+      last = uv_buf_init("LAST", 4);
+      ASSERT_EQ(4, uv_udp_try_send(&client,
+                                   &last,
+                                   1,
+                                   (const struct sockaddr*) &addr));
+      last_sent = 1;
+    }
+    return;
+  }
+
+  received++;
+  if (nread != 4)
+    return;
+
+  ASSERT_OK(memcmp(buf->base, "LAST", 4));
+  ASSERT_OK(uv_udp_get_stats(&server, &stats));
+  ASSERT_EQ(received, stats.recv_packets);
+  ASSERT_EQ((received - 1) * sizeof(payload) + 4, stats.recv_bytes);
+  ASSERT_GE(stats.recv_eagain, 1);
+  ASSERT_OK(stats.recvmmsg_calls);
+  ASSERT_OK(stats.send_packets);
+#if defined(__linux__)
+  /* The small receive buffer couldn't take the whole burst. */
+  ASSERT_GT(stats.kernel_drops, 0);
+  ASSERT_EQ(sent + 1, received + stats.kernel_drops);
+#endif
+
+  ASSERT_OK(uv_udp_get_stats(&client, &stats));
+  ASSERT_EQ(sent + 1, stats.send_packets);
+  ASSERT_EQ(sent * sizeof(payload) + 4, stats.send_bytes);
+  ASSERT_OK(stats.recv_packets);
+
+  uv_close((uv_handle_t*) &server, close_cb);
+  uv_close((uv_handle_t*) &client, close_cb);
+}
+
+
+TEST_IMPL(udp_stats) {
+  uv_udp_stats_t stats;
+  uv_loop_t* loop;
+  uv_buf_t buf;
+  int value;
+  int r;
+  int i;
+
+  loop = uv_default_loop();
+  ASSERT_OK(uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  ASSERT_OK(uv_udp_init(loop, &server));
+  ASSERT_OK(uv_udp_bind(&server, (const struct sockaddr*) &addr, 0));
+
+  r = uv_udp_get_stats(&server, &stats);
+  if (r == UV_ENOTSUP) {
+    uv_close((uv_handle_t*) &server, NULL);
+    uv_run(loop, UV_RUN_DEFAULT);
+    RETURN_SKIP("UDP statistics are not supported on this platform");
+  }
+  ASSERT_OK(r);
+  ASSERT_OK(stats.recv_packets);
+  ASSERT_OK(stats.kernel_drops);
+
+  value = 4096;
+  ASSERT_OK(uv_recv_buffer_size((uv_handle_t*) &server, &value));
+
+  /* Burst before the server reads anything. */
+  ASSERT_OK(uv_udp_init(loop, &client));
+  memset(payload, 'x', sizeof(payload));
+  buf = uv_buf_init(payload, sizeof(payload));
+  for (i = 0; i < NUM_SENDS; i++) {
+    r = uv_udp_try_send(&client, &buf, 1, (const struct sockaddr*) &addr);
+    if (r == UV_EAGAIN)
+      continue;
+    ASSERT_EQ(sizeof(payload), r);
+    sent++;
+  }
+  ASSERT_GT(sent, 0);
+
+  ASSERT_OK(uv_udp_recv_start(&server, alloc_cb, recv_cb));
+  ASSERT_OK(uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT_EQ(1, last_sent);
+  ASSERT_EQ(2, close_cb_called);
+
+  MAKE_VALGRIND_HAPPY(loop);
+  return 0;
+}